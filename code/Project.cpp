@@ -1,38 +1,94 @@
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <thread>
 
+#include "./engine/EnginePlayer.h"
 #include "./gui/Paint.h"
 #include "./gui/Window.h"
 #include "./input/Input.h"
+#include "./loop/Scheduler.h"
+#include "./profiling/AllocationProfiler.h"
+#include "./profiling/Trace.h"
 #include "./rules/board/Board.h"
 
 // Initialize the timer function
-void timer(Board* mBoard) {
+void timer(Board* mBoard, Scheduler* scheduler) {
+  TRACE_THREAD("timer");
   double time[2] = {mBoard->getMaxTime(), mBoard->getMaxTime()};
   std::vector<double> undoTimes;
   undoTimes.push_back(mBoard->getMaxTime());
   int moveCount = mBoard->getMoveCount();
+  bool running = mBoard->getTurn();
+  auto lastTick = std::chrono::steady_clock::now();
 
-  // Start the timer loop
+  // Start the timer loop. The time is always charged to the player on turn, so a computer opponent, which ponders
+  // while the player thinks, does not lose its own time for it.
   while (time[mBoard->getTurn()] > 0.0 && mBoard->gameStarted) {
-    if (moveCount < mBoard->getMoveCount()) {
-      undoTimes.push_back(time[mBoard->getTurn()]);
-    } else if (moveCount > mBoard->getMoveCount() && !undoTimes.empty()) {
-      time[!mBoard->getTurn()] = undoTimes[undoTimes.size() - 1];
-      undoTimes.pop_back();
+    {
+      TRACE_SCOPE("timer tick");
+      // Charge the time since the last tick to the player, who was on turn during it
+      auto now = std::chrono::steady_clock::now();
+      time[running] = fmax(time[running] - std::chrono::duration<double>(now - lastTick).count(), 0.0);
+      lastTick = now;
+
+      if (moveCount < mBoard->getMoveCount()) {
+        undoTimes.push_back(time[mBoard->getTurn()]);
+      } else if (moveCount > mBoard->getMoveCount() && !undoTimes.empty()) {
+        time[!mBoard->getTurn()] = undoTimes[undoTimes.size() - 1];
+        undoTimes.pop_back();
+      }
+      moveCount = mBoard->getMoveCount();
+      running = mBoard->getTurn();
+      mBoard->setTime(time);
+      scheduler->requestRedraw();
     }
-    moveCount = mBoard->getMoveCount();
-    time[mBoard->getTurn()] -= 0.1;
-    mBoard->setTime(time);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Sleep until the displayed tenth of the running clock changes, or until a move wakes the timer up
+    scheduler->waitFor(Scheduler::untilNextTenth(time[running]));
   }
   // End the game by timeout
   if (mBoard->gameStarted) mBoard->endGame(false, true, false);
+  scheduler->requestRedraw();
 };
 
-int main() {
+// Starts the search of the computer, when it is on turn, and plays its move, once the search finished. Returns true
+// if a move was played.
+bool playComputer(Board* mBoard, EnginePlayer* engine, bool computerWhite, int* searchedMove) {
+  if (mBoard->getEndMessage() != L"") {
+    engine->stop();
+    *searchedMove = -1;
+    return false;
+  }
+  if (mBoard->getTurn() != computerWhite || mBoard->isPromoting()) {
+    *searchedMove = -1;
+    return false;
+  }
+  if (*searchedMove != mBoard->getMoveCount()) {
+    *searchedMove = mBoard->getMoveCount();
+    // A ponder hit continues the search on the expected reply, otherwise the new position is searched
+    // The board has no increment and no moves to go, every game is sudden death
+    engine->go(mBoard->getStartPosition(), mBoard->getMoves(), mBoard->getTime()[computerWhite ? 1 : 0], 0.0, 0);
+  }
+
+  Move move;
+  if (!engine->takeMove(&move)) return false;
+  int from[2] = {move.getFrom() % mBoard->getWidth(), move.getFrom() / mBoard->getWidth()};
+  int to[2] = {move.getTo() % mBoard->getWidth(), move.getTo() / mBoard->getWidth()};
+  bool moved = mBoard->movePiece(from[0], from[1], to[0], to[1], ' ');
+  if (!moved && mBoard->isPromoting())
+    moved = mBoard->movePiece(from[0], from[1], to[0], to[1], move.getPromotionPiece(computerWhite));
+  if (moved && !mBoard->gameStarted) mBoard->gameStarted = true;
+  return true;
+}
+
+/**
+ * Starts the game. With "--computer white" or "--computer black", the computer plays that color, and with "--ponder"
+ * it also thinks on the time of the player.
+ */
+int main(int argc, char* argv[]) {
+  TRACE_THREAD("ui");
   // Initialize the board
   Board* mBoard = new Board(8, 8);
   mBoard->setup("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR");
@@ -41,24 +97,62 @@ int main() {
   Window* mWindow = new Window(mBoard);
   std::thread timerThread;
 
+  // Let the timer thread wake the window for a redraw
+  Scheduler scheduler;
+  HWND hWnd = mWindow->getHWnd();
+  scheduler.setRedrawHook([hWnd]() { PostMessage(hWnd, WM_REDRAW, 0, 0); });
+  int moveCount = mBoard->getMoveCount();
+
+  // Optional computer opponent, which wakes the window up, when its move is ready
+  EnginePlayer* engine = nullptr;
+  bool computerWhite = false;
+  bool ponder = false;
+  for (int i = 1; i < argc; i++) ponder |= strcmp(argv[i], "--ponder") == 0;
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "--computer") != 0) continue;
+    computerWhite = strcmp(argv[i + 1], "white") == 0;
+    engine = new EnginePlayer(64, ponder);
+    engine->setOnMove([&scheduler]() { scheduler.requestRedraw(); });
+  }
+  int searchedMove = -1;
+
   // Window loop
   bool running = true;
   while (running) {
     // Handle the timer thread
     if (mBoard->gameStarted && !timerThread.joinable()) {
-      timerThread = std::thread(timer, mBoard);
+      timerThread = std::thread(timer, mBoard, &scheduler);
     } else if (!mBoard->gameStarted && timerThread.joinable()) {
+      scheduler.notify();
       timerThread.join();
     }
 
-    // Redraw the window in order to update the timer
-    InvalidateRect(mWindow->getHWnd(), NULL, TRUE);
-
+    // Block until the next input event or redraw request, instead of polling
+    MsgWaitForMultipleObjectsEx(0, NULL, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
     if (!mWindow->ProcessMessages()) running = false;
-    Sleep(50);
+    if (engine != nullptr && playComputer(mBoard, engine, computerWhite, &searchedMove)) scheduler.requestRedraw();
+
+    // Wake the timer thread up, if a move or an undo switched the running clock
+    if (moveCount != mBoard->getMoveCount()) {
+      moveCount = mBoard->getMoveCount();
+      scheduler.notify();
+    }
+  }
+
+  // Stop the timer thread
+  if (timerThread.joinable()) {
+    mBoard->gameStarted = false;
+    scheduler.notify();
+    timerThread.join();
   }
 
+  // Write the recorded spans, if tracing is compiled in
+  TRACE_DUMP("trace.json");
+  // Write the allocation counts, if the allocation profiler is compiled in
+  ALLOCATION_DUMP("allocations.txt");
+
+  delete engine;
   delete mWindow;
   delete mBoard;
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,268 @@
+#include "./Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+/**
+ * @brief Constructs a Benchmark, which collects the results of all benchmarks of one run.
+ *
+ * @param pMinTime The minimum time in seconds, every benchmark is measured for.
+ * @param pFilter Only benchmarks containing this text in their name or position set are run. Empty runs all.
+ */
+Benchmark::Benchmark(double pMinTime, std::string pFilter) : minTime(pMinTime), filter(pFilter), counters(nullptr) {}
+
+Benchmark::~Benchmark() {}
+
+/**
+ * Checks if a benchmark matches the filter.
+ *
+ * @param name The name of the benchmark.
+ * @param set The name of the position set.
+ * @return True if the benchmark should be run.
+ */
+bool Benchmark::isSelected(const std::string& name, const std::string& set) {
+  return filter.empty() || (name + "/" + set).find(filter) != std::string::npos;
+}
+
+/**
+ * Measures an operation, by calling it in batches of growing size, until the minimum time is reached. The clock and
+ * the counters are only read once per batch, so even very short operations are measured accurately.
+ *
+ * @param name The name of the benchmark.
+ * @param set The name of the position set.
+ * @param operation Performs one operation and returns the number of processed items.
+ */
+void Benchmark::run(const std::string& name, const std::string& set, const std::function<long long()>& operation) {
+  if (!isSelected(name, set)) return;
+  // Warm up the caches
+  for (int i = 0; i < 10; i++) operation();
+
+  BenchmarkResult result = {name, set, 0, 0, 0.0, 0, {}, 0, {}, {}};
+  long long batch = 1;
+  while (result.seconds < minTime) {
+    BenchmarkSample sample;
+    startSample(&sample);
+    for (long long i = 0; i < batch; i++) result.items += operation();
+    stopSample(sample, &result);
+    result.operations += batch;
+    batch *= 2;
+  }
+  add(result);
+}
+
+/**
+ * Starts a measured section. Benchmarks, which have to prepare every operation, measure the operations themselves
+ * with a sample around each of them.
+ *
+ * @param sample Receives the time, the allocation counts and the counters at the start.
+ */
+void Benchmark::startSample(BenchmarkSample* sample) {
+  if (counters != nullptr) counters->read(sample->counters);
+  AllocationProfiler::readRegions(sample->regionAllocations, sample->regionBytes);
+  sample->allocations = AllocationProfiler::getAllocations();
+  sample->bytes = AllocationProfiler::getBytes();
+  sample->start = std::chrono::steady_clock::now();
+}
+
+/**
+ * Ends a measured section and adds the time, the allocations and the counter deltas to a result. The operations and
+ * items are counted by the caller.
+ *
+ * @param sample The sample of startSample.
+ * @param result The result to add to.
+ */
+void Benchmark::stopSample(const BenchmarkSample& sample, BenchmarkResult* result) {
+  auto end = std::chrono::steady_clock::now();
+  result->allocations += AllocationProfiler::getAllocations() - sample.allocations;
+  result->bytes += AllocationProfiler::getBytes() - sample.bytes;
+  result->seconds += std::chrono::duration<double>(end - sample.start).count();
+  unsigned long long allocations[AllocationProfiler::maxRegions];
+  unsigned long long bytes[AllocationProfiler::maxRegions];
+  AllocationProfiler::readRegions(allocations, bytes);
+  for (int i = 0; i < AllocationProfiler::maxRegions; i++) {
+    result->regionAllocations[i] += allocations[i] - sample.regionAllocations[i];
+    result->regionBytes[i] += bytes[i] - sample.regionBytes[i];
+  }
+  if (counters == nullptr) return;
+  unsigned long long values[PerfCounters::count];
+  counters->read(values);
+  for (int i = 0; i < PerfCounters::count; i++) result->counters[i] += values[i] - sample.counters[i];
+}
+
+/**
+ * Adds the result of a benchmark, which measures its operations itself.
+ *
+ * @param result The measured result.
+ */
+void Benchmark::add(const BenchmarkResult& result) { results.push_back(result); }
+
+/**
+ * Prints the results as a table, followed by the allocations of every benchmark, which allocated inside a region.
+ *
+ * @param out The stream to print to.
+ */
+void Benchmark::print(std::ostream& out) {
+  char line[256];
+  snprintf(line, sizeof(line), "%-28s %-12s %12s %12s %12s %14s %14s", "benchmark", "set", "ns/op", "allocs/op",
+           "bytes/op", "ops/s", "items/s");
+  out << line;
+  for (int i = 0; i < PerfCounters::count; i++) {
+    if (counters == nullptr || !counters->isAvailable(i)) continue;
+    snprintf(line, sizeof(line), " %14s", (std::string(PerfCounters::getName(i)) + "/op").c_str());
+    out << line;
+  }
+  out << "\n";
+
+  for (const BenchmarkResult& result : results) {
+    snprintf(line, sizeof(line), "%-28s %-12s %12.1f %12.2f %12.1f %14.0f %14.0f", result.name.c_str(),
+             result.set.c_str(), result.nsPerOp(), result.allocsPerOp(), result.bytesPerOp(), result.opsPerSecond(),
+             result.itemsPerSecond());
+    out << line;
+    for (int i = 0; i < PerfCounters::count; i++) {
+      if (counters == nullptr || !counters->isAvailable(i)) continue;
+      snprintf(line, sizeof(line), " %14.1f", result.counterPerOp(i));
+      out << line;
+    }
+    out << "\n";
+  }
+
+  std::vector<std::string> regions = getRegionNames();
+  bool header = false;
+  for (const BenchmarkResult& result : results) {
+    for (const std::string& region : regions) {
+      double allocsPerOp, bytesPerOp;
+      sumRegions(result, region, &allocsPerOp, &bytesPerOp);
+      if (allocsPerOp == 0.0) continue;
+      if (!header) {
+        snprintf(line, sizeof(line), "\n%-28s %-12s %-12s %12s %12s\n", "benchmark", "set", "region", "allocs/op",
+                 "bytes/op");
+        out << line;
+        header = true;
+      }
+      snprintf(line, sizeof(line), "%-28s %-12s %-12s %12.2f %12.1f\n", result.name.c_str(), result.set.c_str(),
+               region.c_str(), allocsPerOp, bytesPerOp);
+      out << line;
+    }
+  }
+  out.flush();
+}
+
+/**
+ * Writes the results as JSON, so the results of two runs can be compared by a script.
+ *
+ * @param path The path of the JSON file.
+ * @return True if the file was written, false otherwise.
+ */
+bool Benchmark::writeJson(const std::string& path) {
+  std::ofstream file(path);
+  if (!file) return false;
+  std::vector<std::string> regions = getRegionNames();
+  char line[512];
+  file << "{\n  \"benchmarks\": [\n";
+  for (int i = 0; i < results.size(); i++) {
+    const BenchmarkResult& result = results[i];
+    snprintf(line, sizeof(line),
+             "    {\"name\": \"%s\", \"set\": \"%s\", \"operations\": %lld, \"ns_per_op\": %.2f, "
+             "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f, \"ops_per_second\": %.1f, \"items_per_second\": %.1f",
+             result.name.c_str(), result.set.c_str(), result.operations, result.nsPerOp(), result.allocsPerOp(),
+             result.bytesPerOp(), result.opsPerSecond(), result.itemsPerSecond());
+    file << line;
+    // Allocations per region and operation, every region, which was entered during the run
+    file << ", \"regions\": {";
+    bool firstRegion = true;
+    for (const std::string& region : regions) {
+      double allocsPerOp, bytesPerOp;
+      sumRegions(result, region, &allocsPerOp, &bytesPerOp);
+      snprintf(line, sizeof(line), "%s\"%s\": {\"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f}",
+               firstRegion ? "" : ", ", region.c_str(), allocsPerOp, bytesPerOp);
+      file << line;
+      firstRegion = false;
+    }
+    file << "}";
+    // Counters per operation, only the available ones
+    if (counters != nullptr) {
+      file << ", \"counters_per_op\": {";
+      bool first = true;
+      for (int j = 0; j < PerfCounters::count; j++) {
+        if (!counters->isAvailable(j)) continue;
+        snprintf(line, sizeof(line), "%s\"%s\": %.2f", first ? "" : ", ", PerfCounters::getName(j),
+                 result.counterPerOp(j));
+        file << line;
+        first = false;
+      }
+      file << "}";
+    }
+    file << (i + 1 < results.size() ? "},\n" : "}\n");
+  }
+  file << "  ]\n}\n";
+  return file.good();
+}
+
+/**
+ * Lists the names of all allocation regions, which were entered so far. Regions with the same name are listed once.
+ *
+ * @return The region names in the order of their registration.
+ */
+std::vector<std::string> Benchmark::getRegionNames() {
+  std::vector<std::string> names;
+  for (int i = 0; i < AllocationProfiler::getRegionCount(); i++) {
+    std::string name = AllocationProfiler::getRegionName(i);
+    if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+  }
+  return names;
+}
+
+/**
+ * Adds up the allocations of all regions with the given name for one result.
+ *
+ * @param result The benchmark result.
+ * @param region The name of the region.
+ * @param allocsPerOp Receives the allocations per operation inside the region.
+ * @param bytesPerOp Receives the allocated bytes per operation inside the region.
+ */
+void Benchmark::sumRegions(const BenchmarkResult& result, const std::string& region, double* allocsPerOp,
+                           double* bytesPerOp) {
+  unsigned long long allocations = 0, bytes = 0;
+  for (int i = 0; i < AllocationProfiler::getRegionCount(); i++) {
+    if (region != AllocationProfiler::getRegionName(i)) continue;
+    allocations += result.regionAllocations[i];
+    bytes += result.regionBytes[i];
+  }
+  *allocsPerOp = result.operations > 0 ? (double)allocations / result.operations : 0.0;
+  *bytesPerOp = result.operations > 0 ? (double)bytes / result.operations : 0.0;
+}
+
+/**
+ * Enables reading the hardware counters around every measured section.
+ *
+ * @param pCounters The opened counters, or nullptr to disable them.
+ */
+void Benchmark::setCounters(PerfCounters* pCounters) { counters = pCounters; }
+
+/**
+ * @brief Getters of the Benchmark class.
+ *
+ * */
+double Benchmark::getMinTime() { return minTime; }
+
+const std::vector<BenchmarkResult>& Benchmark::getResults() { return results; }
+
+/**
+ * @brief Derived values of a benchmark result.
+ *
+ * */
+double BenchmarkResult::nsPerOp() const { return operations > 0 ? seconds * 1e9 / operations : 0.0; }
+
+double BenchmarkResult::allocsPerOp() const { return operations > 0 ? (double)allocations / operations : 0.0; }
+
+double BenchmarkResult::bytesPerOp() const { return operations > 0 ? (double)bytes / operations : 0.0; }
+
+double BenchmarkResult::opsPerSecond() const { return seconds > 0 ? operations / seconds : 0.0; }
+
+double BenchmarkResult::itemsPerSecond() const { return seconds > 0 ? items / seconds : 0.0; }
+
+double BenchmarkResult::counterPerOp(int counter) const {
+  return operations > 0 ? (double)counters[counter] / operations : 0.0;
+}
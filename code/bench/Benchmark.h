@@ -0,0 +1,72 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../profiling/AllocationProfiler.h"
+#include "../profiling/PerfCounters.h"
+
+struct BenchmarkResult {
+  std::string name;
+  std::string set;
+  long long operations;
+  // Work done by all operations, like the number of generated moves
+  long long items;
+  double seconds;
+  unsigned long long allocations;
+  // Hardware counter totals, only filled if the counters are enabled
+  unsigned long long counters[PerfCounters::count];
+  unsigned long long bytes;
+  // Allocations and bytes per allocation region, indexed like AllocationProfiler::readRegions
+  unsigned long long regionAllocations[AllocationProfiler::maxRegions];
+  unsigned long long regionBytes[AllocationProfiler::maxRegions];
+
+  double nsPerOp() const;
+  double allocsPerOp() const;
+  double bytesPerOp() const;
+  double opsPerSecond() const;
+  double itemsPerSecond() const;
+  double counterPerOp(int counter) const;
+};
+
+// State at the start of a measured section
+struct BenchmarkSample {
+  std::chrono::steady_clock::time_point start;
+  unsigned long long allocations;
+  unsigned long long bytes;
+  unsigned long long counters[PerfCounters::count];
+  unsigned long long regionAllocations[AllocationProfiler::maxRegions];
+  unsigned long long regionBytes[AllocationProfiler::maxRegions];
+};
+
+class Benchmark {
+ public:
+  Benchmark(double pMinTime, std::string pFilter);
+  ~Benchmark();
+
+  bool isSelected(const std::string& name, const std::string& set);
+  void run(const std::string& name, const std::string& set, const std::function<long long()>& operation);
+  void startSample(BenchmarkSample* sample);
+  void stopSample(const BenchmarkSample& sample, BenchmarkResult* result);
+  void add(const BenchmarkResult& result);
+  void setCounters(PerfCounters* pCounters);
+  void print(std::ostream& out);
+  bool writeJson(const std::string& path);
+  double getMinTime();
+  const std::vector<BenchmarkResult>& getResults();
+
+ private:
+  double minTime;
+  std::string filter;
+  PerfCounters* counters;
+  std::vector<BenchmarkResult> results;
+
+  std::vector<std::string> getRegionNames();
+  void sumRegions(const BenchmarkResult& result, const std::string& region, double* allocsPerOp, double* bytesPerOp);
+};
+
+#endif  // BENCHMARK_H_
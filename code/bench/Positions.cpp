@@ -0,0 +1,29 @@
+#include "./Positions.h"
+
+/**
+ * Returns the fixed position sets of the benchmarks. The positions never change, so the results of different runs can
+ * be compared.
+ *
+ * @return The opening, middlegame, endgame and check-heavy position sets.
+ */
+const std::vector<PositionSet>& getPositionSets() {
+  static const std::vector<PositionSet> sets = {
+      {"opening",
+       {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR",
+        "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R",
+        "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R",
+        "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N5/PP2PPPP/R1BQKBNR"}},
+      {"middlegame",
+       {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1",
+        "r2q1rk1/pp2bppp/2n1bn2/3p4/3P4/2NBBN2/PP3PPP/R2Q1RK1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R"}},
+      {"endgame",
+       {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8", "8/5pk1/6p1/8/3R4/6P1/5PK1/r7", "8/8/4k3/8/2p5/8/B2K4/8",
+        "4k3/8/8/8/8/8/4P3/4K3"}},
+      {"check",
+       {"rnbqk1nr/pppp1ppp/8/4p3/1b1P4/8/PPP1PPPP/RNBQKBNR", "4k3/8/8/8/8/8/3q4/4K3", "4k3/8/8/8/8/5n2/8/r3K3",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1"}},
+  };
+  return sets;
+}
@@ -0,0 +1,15 @@
+#ifndef POSITIONS_H_
+#define POSITIONS_H_
+
+#include <string>
+#include <vector>
+
+// A named set of positions in the FEN notation of the Board class (piece placement only, white to move)
+struct PositionSet {
+  std::string name;
+  std::vector<std::string> fens;
+};
+
+const std::vector<PositionSet>& getPositionSets();
+
+#endif  // POSITIONS_H_
@@ -0,0 +1,170 @@
+#include "./Analysis.h"
+
+#include <algorithm>
+
+#include "../profiling/Trace.h"
+
+/**
+ * @brief Constructs an Analysis and starts its thread, which waits for the first position.
+ *
+ * @param hashMegabytes The size of the transposition table, which is kept for all analysed positions.
+ * @param pLines The number of lines to keep.
+ */
+Analysis::Analysis(int hashMegabytes, int pLines)
+    : table(hashMegabytes), search(&table), interrupt(false), running(false), pending(false), quit(false),
+      lines(std::max(1, pLines)), latest{0, 0, 0, 0.0, {}, 0} {
+  thread = std::thread(&Analysis::run, this);
+}
+
+/**
+ * @brief Destructor for the Analysis class, which stops the search and joins the thread.
+ */
+Analysis::~Analysis() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+    interrupt = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+/**
+ * Starts to analyse a position. A running search of another position is stopped first.
+ *
+ * @param pPosition The position to analyse.
+ * @param gameKeys The keys of the positions of the game before it, oldest first, to detect repetitions.
+ */
+void Analysis::setPosition(const Position& pPosition, const std::vector<uint64_t>& gameKeys) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    position = pPosition;
+    keys = gameKeys;
+    pending = true;
+    interrupt = true;
+    latest = {position.getKey(), 0, 0, 0.0, {}, 0};
+  }
+  wake.notify_one();
+}
+
+/**
+ * Starts to analyse the position at the end of a game, like the current position of a Board.
+ *
+ * @param start The start position of the game.
+ * @param moves The moves of the game.
+ */
+void Analysis::setGame(const Position& start, const std::vector<Move>& moves) {
+  Piece piece;
+  Position current = start;
+  std::vector<uint64_t> gameKeys;
+  for (Move move : moves) {
+    gameKeys.push_back(current.getKey());
+    Position next;
+    current.makeMove(&piece, move, &next);
+    current = next;
+  }
+  setPosition(current, gameKeys);
+}
+
+/**
+ * Stops the analysis. The last lines stay available through getUpdate.
+ */
+void Analysis::stop() {
+  std::lock_guard<std::mutex> lock(mutex);
+  pending = false;
+  interrupt = true;
+}
+
+/**
+ * Sets the number of lines. It is used from the next position on.
+ *
+ * @param pLines The number of lines to keep.
+ */
+void Analysis::setLines(int pLines) {
+  std::lock_guard<std::mutex> lock(mutex);
+  lines = std::max(1, pLines);
+}
+
+/**
+ * Sets the evaluation network of the search. Only call it while the analysis is stopped.
+ *
+ * @param pNetwork The network, which is not owned by the analysis, or nullptr for the hand written evaluation.
+ */
+void Analysis::setNetwork(Nnue* pNetwork) { search.setNetwork(pNetwork); }
+
+/**
+ * Adds a subscriber, which is called from the analysis thread after every finished line. It must not call stop,
+ * setPosition or setLines, but may call getUpdate.
+ *
+ * @param callback Receives the state of the analysis.
+ */
+void Analysis::subscribe(const std::function<void(const AnalysisUpdate&)>& callback) {
+  std::lock_guard<std::mutex> lock(mutex);
+  subscribers.push_back(callback);
+}
+
+/**
+ * Returns the latest state of the analysis, for consumers, which poll instead of subscribing.
+ */
+AnalysisUpdate Analysis::getUpdate() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return latest;
+}
+
+/**
+ * Checks if a position is currently searched.
+ */
+bool Analysis::isRunning() { return running; }
+
+/**
+ * Thread function: waits for a position and searches it until it is stopped or interrupted by the next position.
+ */
+void Analysis::run() {
+  TRACE_THREAD("analysis");
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this]() { return pending || quit; });
+    if (quit) return;
+    // Take the request and clear the interrupt in one step, so a later request always interrupts this search
+    Position root = position;
+    std::vector<uint64_t> gameKeys = keys;
+    SearchLimits limits;
+    limits.multiPv = lines;
+    limits.stopToken = &interrupt;
+    pending = false;
+    interrupt = false;
+    running = true;
+    lock.unlock();
+
+    uint64_t key = root.getKey();
+    search.run(root, limits, gameKeys, [this, key](const SearchInfo& info) { publish(info, key); });
+
+    lock.lock();
+    running = false;
+  }
+}
+
+/**
+ * Stores a finished line and sends the new state to the subscribers. Lines of an interrupted search are dropped.
+ *
+ * @param info The finished line.
+ * @param key The key of the searched position.
+ */
+void Analysis::publish(const SearchInfo& info, uint64_t key) {
+  std::vector<std::function<void(const AnalysisUpdate&)>> callbacks;
+  AnalysisUpdate update;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (interrupt || latest.key != key) return;
+    if (latest.lines.size() <= info.line) latest.lines.resize(info.line + 1);
+    latest.lines[info.line] = {info.depth, info.score, info.pv};
+    latest.depth = info.depth;
+    latest.nodes = info.nodes;
+    latest.seconds = info.seconds;
+    latest.changed = info.line;
+    update = latest;
+    callbacks = subscribers;
+  }
+  TRACE_SCOPE("Analysis::publish");
+  for (const auto& callback : callbacks) callback(update);
+}
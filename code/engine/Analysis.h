@@ -0,0 +1,71 @@
+#ifndef ANALYSIS_H_
+#define ANALYSIS_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./Search.h"
+
+struct AnalysisLine {
+  int depth;
+  // Score from the view of the player to move
+  int score;
+  std::vector<Move> pv;
+};
+
+// State of the analysis, the best lines first. Lines of a running iteration have a higher depth than the others.
+struct AnalysisUpdate {
+  uint64_t key;
+  int depth;
+  long long nodes;
+  double seconds;
+  std::vector<AnalysisLine> lines;
+  // Index of the line, which finished last
+  int changed;
+};
+
+// Background analysis of one position at a time, which keeps the best lines (multi-PV) with their scores and depths.
+// Every finished line is sent to the subscribers from the analysis thread. When the position changes, the running
+// search is stopped and the new position is searched with the same Search and transposition table, so the lines of
+// the earlier position, which are still possible, are found again quickly.
+class Analysis {
+ public:
+  Analysis(int hashMegabytes, int pLines);
+  ~Analysis();
+
+  void setPosition(const Position& position, const std::vector<uint64_t>& gameKeys);
+  void setGame(const Position& start, const std::vector<Move>& moves);
+  void stop();
+  void setLines(int pLines);
+  void setNetwork(Nnue* pNetwork);
+  void subscribe(const std::function<void(const AnalysisUpdate&)>& callback);
+  AnalysisUpdate getUpdate();
+  bool isRunning();
+
+ private:
+  void run();
+  void publish(const SearchInfo& info, uint64_t key);
+
+  TranspositionTable table;
+  Search search;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wake;
+  // Set to stop the running search, because the position changed or the analysis stops
+  std::atomic<bool> interrupt;
+  std::atomic<bool> running;
+  bool pending;
+  bool quit;
+  int lines;
+  Position position;
+  std::vector<uint64_t> keys;
+  std::vector<std::function<void(const AnalysisUpdate&)>> subscribers;
+  AnalysisUpdate latest;
+};
+
+#endif  // ANALYSIS_H_
@@ -0,0 +1,130 @@
+#include "./Annotator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "../profiling/Trace.h"
+#include "../rules/moves/Notation.h"
+
+// Scores beyond this are clamped before comparing moves, so a move in a clearly won or lost position is not flagged
+// for winning or losing a little less clearly
+static constexpr int decidedScore = 1000;
+
+/**
+ * @brief Constructs an Annotator.
+ *
+ * @param pThreads The number of threads, which analyse the positions.
+ * @param hashMegabytes The size of the shared transposition table.
+ */
+Annotator::Annotator(int pThreads, int hashMegabytes) : threads(std::max(1, pThreads)), table(hashMegabytes) {}
+
+Annotator::~Annotator() {}
+
+/**
+ * Analyses the positions of a game. Every position is searched once with the given limits, so the score after a move
+ * is the negated score of the following position. The positions are taken from the end of the game first.
+ *
+ * @param start The start position of the game.
+ * @param moves The moves of the game, which have to be legal.
+ * @param limits The budget of every position, usually a depth or a number of nodes.
+ * @return The analysis of every move.
+ */
+std::vector<MoveAnalysis> Annotator::analyze(const Position& start, const std::vector<Move>& moves,
+                                             const SearchLimits& limits) {
+  TRACE_SCOPE("Annotator::analyze");
+  Piece piece;
+  std::vector<Position> positions(moves.size() + 1);
+  std::vector<uint64_t> keys(moves.size() + 1);
+  positions[0] = start;
+  keys[0] = start.getKey();
+  for (size_t i = 0; i < moves.size(); i++) {
+    positions[i].makeMove(&piece, moves[i], &positions[i + 1]);
+    keys[i + 1] = positions[i + 1].getKey();
+  }
+
+  // Score and best move of every position, from the view of the player to move
+  std::vector<SearchResult> results(positions.size());
+  std::atomic<int> next(positions.size() - 1);
+  table.clear();
+  auto work = [&]() {
+    TRACE_THREAD("annotator");
+    Search search(&table);
+    Piece local;
+    for (int index = next--; index >= 0; index = next--) {
+      std::vector<uint64_t> gameKeys(keys.begin(), keys.begin() + index);
+      results[index] = search.run(positions[index], limits, gameKeys, nullptr);
+      // Without a legal move, the game ended here by checkmate or stalemate
+      if (results[index].best.isNull())
+        results[index].score = local.testCheck(positions[index].board, positions[index].turn) ? -Search::mateScore : 0;
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; i++) pool.emplace_back(work);
+  work();
+  for (std::thread& thread : pool) thread.join();
+
+  std::vector<MoveAnalysis> analysis(moves.size());
+  for (size_t i = 0; i < moves.size(); i++) {
+    MoveAnalysis& move = analysis[i];
+    move.best = results[i].best;
+    move.bestScore = results[i].score;
+    move.playedScore = -results[i + 1].score;
+    // The best move can not lose anything, even if the deeper search of the next position disagrees
+    if (moves[i] == move.best) move.playedScore = std::max(move.playedScore, move.bestScore);
+    int best = std::clamp(move.bestScore, -decidedScore, decidedScore);
+    int played = std::clamp(move.playedScore, -decidedScore, decidedScore);
+    move.loss = std::max(0, best - played);
+    move.nag = move.loss >= blunder ? 4 : move.loss >= mistake ? 2 : move.loss >= inaccuracy ? 6 : 0;
+  }
+  return analysis;
+}
+
+/**
+ * Analyses a game and writes the result into its comments and annotation glyphs. Every move gets the score after
+ * the move from the view of white, and flagged moves also the best move with its score.
+ *
+ * @param game The game to annotate. Existing comments and annotation glyphs are replaced.
+ * @param limits The budget of every position.
+ */
+void Annotator::annotate(PgnGame* game, const SearchLimits& limits) {
+  Position position = game->getStartPosition();
+  std::vector<MoveAnalysis> analysis = analyze(position, game->moves, limits);
+  game->comments.assign(game->moves.size(), "");
+  game->nags.assign(game->moves.size(), 0);
+
+  Piece piece;
+  for (size_t i = 0; i < game->moves.size(); i++) {
+    const MoveAnalysis& move = analysis[i];
+    int sign = position.turn ? 1 : -1;
+    std::string comment = formatScore(sign * move.playedScore);
+    if (move.nag != 0) {
+      comment += move.nag == 4 ? " Blunder." : move.nag == 2 ? " Mistake." : " Inaccuracy.";
+      comment += " Best was " + Notation::toSan(position, move.best) + " (" + formatScore(sign * move.bestScore) + ")";
+    }
+    game->comments[i] = comment;
+    game->nags[i] = move.nag;
+    Position next;
+    position.makeMove(&piece, game->moves[i], &next);
+    position = next;
+  }
+  game->setTag("Annotator", "HempiChess");
+}
+
+/**
+ * Formats a score in pawns with a sign, like "+0.35", or as a distance to mate, like "#3" or "#-2".
+ *
+ * @param score The score in centipawns.
+ * @return The formatted score.
+ */
+std::string Annotator::formatScore(int score) {
+  char text[16];
+  if (score > Search::mateScore - Search::maxPly)
+    snprintf(text, sizeof(text), "#%d", (Search::mateScore - score + 1) / 2);
+  else if (score < -Search::mateScore + Search::maxPly)
+    snprintf(text, sizeof(text), "#-%d", (Search::mateScore + score) / 2);
+  else
+    snprintf(text, sizeof(text), "%+.2f", score / 100.0);
+  return text;
+}
@@ -0,0 +1,44 @@
+#ifndef ANNOTATOR_H_
+#define ANNOTATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "../rules/moves/Pgn.h"
+#include "./Search.h"
+
+// Analysis of one move of a game. Scores are from the view of the player, who made the move.
+struct MoveAnalysis {
+  // Best move of the position before the move and its score
+  Move best;
+  int bestScore;
+  // Score after the played move
+  int playedScore;
+  // Centipawns the played move loses against the best move
+  int loss;
+  // Numeric annotation glyph: 6 for an inaccuracy (?!), 2 for a mistake (?), 4 for a blunder (??), 0 otherwise
+  int nag;
+};
+
+// Analyses every position of a finished game with a fixed budget and flags the moves, which lose too much against the
+// best move. The positions are spread over several threads, which share one transposition table, so a thread reuses
+// the lines the other threads already searched in the neighbouring positions.
+class Annotator {
+ public:
+  static constexpr int inaccuracy = 50;
+  static constexpr int mistake = 100;
+  static constexpr int blunder = 300;
+
+  Annotator(int pThreads, int hashMegabytes);
+  ~Annotator();
+
+  std::vector<MoveAnalysis> analyze(const Position& start, const std::vector<Move>& moves, const SearchLimits& limits);
+  void annotate(PgnGame* game, const SearchLimits& limits);
+  static std::string formatScore(int score);
+
+ private:
+  int threads;
+  TranspositionTable table;
+};
+
+#endif  // ANNOTATOR_H_
@@ -0,0 +1,234 @@
+#include "./EnginePlayer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "../profiling/Trace.h"
+
+/**
+ * @brief Constructs an EnginePlayer and starts its thread, which waits for the first position.
+ *
+ * @param hashMegabytes The size of the transposition table, which is kept for the whole game.
+ * @param pPonder True to search on the time of the opponent.
+ */
+EnginePlayer::EnginePlayer(int hashMegabytes, bool pPonder)
+    : table(hashMegabytes),
+      search(&table),
+      interrupt(false),
+      ponder(pPonder),
+      quit(false),
+      pending(false),
+      requestClock{0.0, 0.0, 0},
+      timeControl{0.0, 0.0, 0},
+      searching(false),
+      pondering(false),
+      ponderKey(0),
+      moveReady(false),
+      ponderHits(0),
+      ponderMisses(0) {
+  thread = std::thread(&EnginePlayer::run, this);
+}
+
+/**
+ * @brief Destructor for the EnginePlayer class, which cancels the search and joins the thread.
+ */
+EnginePlayer::~EnginePlayer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+    interrupt = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+/**
+ * Starts to search the move of the engine. If the position is the pondered one, the ponder search continues with the
+ * time limits of this move, otherwise the ponder search is cancelled. The move is taken with takeMove.
+ *
+ * @param start The start position of the game.
+ * @param moves The moves of the game, the engine is to move after them.
+ * @param clock The remaining time of the engine in seconds.
+ * @param increment The time added to the clock after every move in seconds.
+ * @param movesToGo The moves until the next time control, 0 for sudden death.
+ */
+void EnginePlayer::go(const Position& start, const std::vector<Move>& moves, double clock, double increment,
+                      int movesToGo) {
+  Piece piece;
+  Position root = start;
+  std::vector<uint64_t> keys;
+  for (Move move : moves) {
+    keys.push_back(root.getKey());
+    Position next;
+    root.makeMove(&piece, move, &next);
+    root = next;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  moveReady = false;
+  goTime = std::chrono::steady_clock::now();
+  timeControl = {clock, increment, movesToGo};
+  if (pondering) {
+    pondering = false;
+    if (searching && root.getKey() == ponderKey) {
+      ponderHits++;
+      // The time manager of the ponder search decides about the iterations, with the clock predicted when pondering
+      // started. The hard limit comes from the real clock, so the move is never late.
+      TimeManager real;
+      real.start(clock, increment, movesToGo);
+      search.ponderHit(0.0, real.getMaximum());
+      return;
+    }
+    // A ponder search, which already finished, still filled the table, so the new search is quick
+    if (root.getKey() == ponderKey)
+      ponderHits++;
+    else
+      ponderMisses++;
+  }
+  request = root;
+  requestKeys = keys;
+  requestClock = timeControl;
+  requestLimits = SearchLimits();
+  requestLimits.stopToken = &interrupt;
+  requestLimits.timeManager = &timeManager;
+  pending = true;
+  interrupt = true;
+  wake.notify_one();
+}
+
+/**
+ * Takes the move of the engine, once its search finished.
+ *
+ * @param move Receives the move.
+ * @return True if a move was ready, false otherwise.
+ */
+bool EnginePlayer::takeMove(Move* move) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!moveReady) return false;
+  moveReady = false;
+  *move = bestMove;
+  return true;
+}
+
+/**
+ * Cancels the running search, including pondering, for example because the game ended.
+ */
+void EnginePlayer::stop() {
+  std::lock_guard<std::mutex> lock(mutex);
+  pending = false;
+  pondering = false;
+  moveReady = false;
+  interrupt = true;
+}
+
+/**
+ * Sets a function, which is called from the engine thread when a move is ready, for example to wake the UI thread.
+ *
+ * @param callback The function to call. It must not call the methods of this player.
+ */
+void EnginePlayer::setOnMove(const std::function<void()>& callback) {
+  std::lock_guard<std::mutex> lock(mutex);
+  onMove = callback;
+}
+
+/**
+ * Sets the evaluation network of the search. Only call it before the first move.
+ *
+ * @param pNetwork The network, which is not owned by the player, or nullptr for the hand written evaluation.
+ */
+void EnginePlayer::setNetwork(Nnue* pNetwork) { search.setNetwork(pNetwork); }
+
+/**
+ * Sets the tablebases of the search. Only call it before the first move.
+ *
+ * @param pTablebase The tablebases, which are not owned by the player, or nullptr.
+ */
+void EnginePlayer::setTablebase(Tablebase* pTablebase) { search.setTablebase(pTablebase); }
+
+/**
+ * @brief Getters of the EnginePlayer class.
+ *
+ * */
+bool EnginePlayer::isPondering() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pondering;
+}
+
+int EnginePlayer::getPonderHits() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return ponderHits;
+}
+
+int EnginePlayer::getPonderMisses() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return ponderMisses;
+}
+
+/**
+ * Thread function: runs the requested searches. After a move was found, the position after the expected reply is
+ * pondered, if pondering is enabled.
+ */
+void EnginePlayer::run() {
+  TRACE_THREAD("engine");
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this]() { return pending || quit; });
+    if (quit) return;
+    // Take the request and clear the interrupt in one step, so a later request always interrupts this search
+    Position root = request;
+    std::vector<uint64_t> keys = requestKeys;
+    SearchLimits limits = requestLimits;
+    // The time manager is only started here, when no search uses it
+    timeManager.start(requestClock.remaining, requestClock.increment, requestClock.movesToGo);
+    if (!limits.ponder) limits.hardTime = timeManager.getMaximum();
+    pending = false;
+    interrupt = false;
+    searching = true;
+    lock.unlock();
+
+    SearchResult result = search.run(root, limits, keys, nullptr);
+
+    lock.lock();
+    searching = false;
+    // A cancelled search or a ponder search, which finished before the opponent moved, has no move to play
+    if (interrupt || pending || (limits.ponder && pondering)) continue;
+    if (result.best.isNull()) continue;
+    bestMove = result.best;
+    moveReady = true;
+    if (onMove) onMove();
+    if (ponder && !result.ponder.isNull()) startPonder(root, keys, result);
+  }
+}
+
+/**
+ * Requests the ponder search of the position after the move of the engine and the expected reply. Called with the
+ * mutex locked.
+ *
+ * @param root The position, which the engine searched.
+ * @param rootKeys The keys of the positions before it.
+ * @param result The result of the search with the best move and the expected reply.
+ */
+void EnginePlayer::startPonder(const Position& root, const std::vector<uint64_t>& rootKeys,
+                               const SearchResult& result) {
+  Piece piece;
+  Position afterMove, afterReply;
+  root.makeMove(&piece, result.best, &afterMove);
+  afterMove.makeMove(&piece, result.ponder, &afterReply);
+  request = afterReply;
+  requestKeys = rootKeys;
+  requestKeys.push_back(root.getKey());
+  requestKeys.push_back(afterMove.getKey());
+  requestLimits = SearchLimits();
+  requestLimits.ponder = true;
+  requestLimits.stopToken = &interrupt;
+  requestLimits.timeManager = &timeManager;
+  // The clock of the engine does not run while pondering, so its next move starts with the time, which is left
+  // after this move plus the increment
+  double spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - goTime).count();
+  int movesToGo = timeControl.movesToGo > 1 ? timeControl.movesToGo - 1 : 0;
+  requestClock = {std::max(0.0, timeControl.remaining - spent) + timeControl.increment, timeControl.increment,
+                  movesToGo};
+  ponderKey = afterReply.getKey();
+  pondering = true;
+  pending = true;
+}
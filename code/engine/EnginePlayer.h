@@ -0,0 +1,79 @@
+#ifndef ENGINEPLAYER_H_
+#define ENGINEPLAYER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./Search.h"
+
+// Computer opponent, which searches its moves on a background thread. With pondering, it keeps searching after its
+// move, on the position after the expected reply of the opponent. If the opponent plays that reply (a ponder hit),
+// the running search simply continues with the time limits of the move, otherwise (a miss) it is stopped through the
+// stop token and the real position is searched.
+class EnginePlayer {
+ public:
+  EnginePlayer(int hashMegabytes, bool pPonder);
+  ~EnginePlayer();
+
+  void go(const Position& start, const std::vector<Move>& moves, double clock, double increment, int movesToGo);
+  bool takeMove(Move* move);
+  void stop();
+  void setOnMove(const std::function<void()>& callback);
+  void setNetwork(Nnue* pNetwork);
+  void setTablebase(Tablebase* pTablebase);
+  bool isPondering();
+  int getPonderHits();
+  int getPonderMisses();
+
+ private:
+  void run();
+  void startPonder(const Position& root, const std::vector<uint64_t>& rootKeys, const SearchResult& result);
+
+  TranspositionTable table;
+  Search search;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wake;
+  // Set to cancel the running search, because of a ponder miss, a stop or the destructor
+  std::atomic<bool> interrupt;
+  std::function<void()> onMove;
+  bool ponder;
+  bool quit;
+
+  // Clock of the engine at the start of a search
+  struct Clock {
+    double remaining;
+    double increment;
+    int movesToGo;
+  };
+
+  // The next search, which the thread starts, and the clock for its time manager
+  bool pending;
+  Position request;
+  std::vector<uint64_t> requestKeys;
+  SearchLimits requestLimits;
+  Clock requestClock;
+  TimeManager timeManager;
+  // Clock and start time of the last move, to predict the clock of the pondered move
+  Clock timeControl;
+  std::chrono::steady_clock::time_point goTime;
+
+  // State of the running search
+  bool searching;
+  bool pondering;
+  // Key of the position, which is pondered, the position after the expected reply
+  uint64_t ponderKey;
+
+  bool moveReady;
+  Move bestMove;
+  int ponderHits;
+  int ponderMisses;
+};
+
+#endif  // ENGINEPLAYER_H_
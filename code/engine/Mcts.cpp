@@ -0,0 +1,554 @@
+#include "./Mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+#include "../eval/Evaluation.h"
+#include "../eval/PawnHash.h"
+#include "../profiling/Trace.h"
+
+// Edges per node in the pool. Every playout visits one new node and expands one leaf, whose edges take the most space.
+static constexpr int edgesPerNode = 24;
+
+/**
+ * @brief Constructs an Mcts and allocates its node pool.
+ *
+ * @param pThreads The number of threads, which search the tree.
+ * @param megabytes The size of the node pool, half of it holds the tree.
+ */
+Mcts::Mcts(int pThreads, int megabytes)
+    : threads(std::max(1, pThreads)),
+      current(0),
+      hasTree(false),
+      evaluator(staticEvaluator()),
+      stopped(false),
+      playouts(0),
+      maxDepth(0) {
+  long long bytes = (long long)std::max(1, megabytes) * 1024 * 1024 / 2;
+  nodeCapacity = std::max(1LL, bytes / (long long)(sizeof(MctsNode) + edgesPerNode * sizeof(MctsEdge)));
+  edgeCapacity = nodeCapacity * edgesPerNode;
+  for (Pool& pool : pools) {
+    pool.nodes = std::make_unique<MctsNode[]>(nodeCapacity);
+    pool.edges = std::make_unique<MctsEdge[]>(edgeCapacity);
+    pool.usedNodes = 0;
+    pool.usedEdges = 0;
+  }
+}
+
+Mcts::~Mcts() {}
+
+/**
+ * Searches a position, until a limit is reached or the search is stopped. If the position is in the tree of the last
+ * search, at most two moves after its root, the search continues with that part of the tree.
+ *
+ * @param root The position to search.
+ * @param pLimits The limits: the number of playouts (nodes), the time limits and the stop token. The depth is not used.
+ * @param pGameKeys The keys of the positions of the game before the root, oldest first, to detect repetitions.
+ * @return The most visited move and the value of the root. The best move is null if the position has no legal move.
+ */
+MctsResult Mcts::run(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& pGameKeys) {
+  TRACE_SCOPE("Mcts::run");
+  limits = pLimits;
+  start = std::chrono::steady_clock::now();
+  stopped = false;
+  playouts = 0;
+  maxDepth = 0;
+  gameKeys = pGameKeys;
+  gameKeys.push_back(root.getKey());
+  if (!reuseTree(root)) {
+    pools[current].usedNodes = 1;
+    pools[current].usedEdges = 0;
+    resetNode(&pools[current].nodes[0]);
+  }
+  rootPosition = root;
+  hasTree = true;
+
+  MctsNode* nodes = pools[current].nodes.get();
+  MctsEdge* edges = pools[current].edges.get();
+  MctsNode& rootNode = nodes[0];
+  if (rootNode.state == MctsNode::Leaf) {
+    Piece piece;
+    MctsValue value;
+    expand(&piece, &rootNode, root, gameKeys, 0, &value);
+    rootNode.winSum = rootNode.winSum + value.win;
+    rootNode.lossSum = rootNode.lossSum + value.loss;
+    rootNode.visits++;
+  }
+
+  MctsResult result = {Move(), Move(), {0.0f, 1.0f, 0.0f}, 0, 0, 0, 0, 0.0, {}};
+  if (rootNode.state == MctsNode::Expanded) {
+    auto work = [this]() {
+      TRACE_THREAD("mcts");
+      Piece piece;
+      std::vector<uint64_t> keys;
+      std::vector<int> path;
+      while (!checkLimits()) playout(&piece, &keys, &path);
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) pool.emplace_back(work);
+    work();
+    for (std::thread& thread : pool) thread.join();
+
+    // The line of the most visited moves
+    for (int index = 0; index >= 0 && nodes[index].state == MctsNode::Expanded;) {
+      const MctsEdge& edge = edges[getBestEdge(nodes[index])];
+      if (index != 0 && edge.node < 0) break;
+      result.pv.push_back(edge.move);
+      index = edge.node;
+    }
+    result.best = result.pv[0];
+    result.ponder = result.pv.size() > 1 ? result.pv[1] : Move();
+  }
+
+  int visits = std::max(1, rootNode.visits.load());
+  result.value.win = rootNode.winSum / visits;
+  result.value.loss = rootNode.lossSum / visits;
+  result.value.draw = std::max(0.0f, 1.0f - result.value.win - result.value.loss);
+  result.score = toCentipawns(result.value);
+  result.playouts = playouts;
+  result.nodes = std::min(pools[current].usedNodes.load(), nodeCapacity);
+  result.depth = maxDepth;
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+/**
+ * One playout: follows the best moves from the root to a leaf, expands and evaluates the leaf, and adds its value to
+ * all nodes of the line. If another thread is just expanding the leaf, the playout is given up.
+ *
+ * @param piece The move generator of the calling thread.
+ * @param keys Buffer for the keys of the game and the line.
+ * @param path Buffer for the nodes of the line.
+ */
+void Mcts::playout(Piece* piece, std::vector<uint64_t>* keys, std::vector<int>* path) {
+  MctsNode* nodes = pools[current].nodes.get();
+  MctsEdge* edges = pools[current].edges.get();
+  Position position = rootPosition;
+  *keys = gameKeys;
+  path->clear();
+  MctsValue value;
+  for (int index = 0;;) {
+    MctsNode& node = nodes[index];
+    path->push_back(index);
+    node.virtualLoss.fetch_add(1, std::memory_order_relaxed);
+    uint8_t state = node.state.load(std::memory_order_acquire);
+    if (state == MctsNode::Terminal) {
+      value = {0.0f, node.terminal == 0 ? 1.0f : 0.0f, node.terminal < 0 ? 1.0f : 0.0f};
+      break;
+    }
+    if (state == MctsNode::Leaf &&
+        node.state.compare_exchange_strong(state, MctsNode::Expanding, std::memory_order_acquire)) {
+      expand(piece, &node, position, *keys, path->size() - 1, &value);
+      break;
+    }
+    if (state != MctsNode::Expanded) {
+      for (int i : *path) nodes[i].virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+      std::this_thread::yield();
+      return;
+    }
+
+    MctsEdge& edge = edges[selectEdge(node)];
+    Position next;
+    position.makeMove(piece, edge.move, &next);
+    position = std::move(next);
+    keys->push_back(position.getKey());
+    index = getChild(&edge);
+    if (index < 0) {
+      // Without space for the child, its position is evaluated and the value is backed up from the node
+      MoveList moves;
+      float priors[MoveList::capacity];
+      int8_t terminal;
+      evaluate(piece, position, *keys, path->size(), &moves, priors, &value, &terminal);
+      std::swap(value.win, value.loss);
+      break;
+    }
+  }
+
+  // The value alternates between the two players on the way back to the root
+  for (int i = path->size() - 1; i >= 0; i--) {
+    MctsNode& node = nodes[(*path)[i]];
+    node.winSum.fetch_add(value.win, std::memory_order_relaxed);
+    node.lossSum.fetch_add(value.loss, std::memory_order_relaxed);
+    node.visits.fetch_add(1, std::memory_order_relaxed);
+    node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+    std::swap(value.win, value.loss);
+  }
+  playouts++;
+  int depth = path->size() - 1;
+  for (int deepest = maxDepth; depth > deepest && !maxDepth.compare_exchange_weak(deepest, depth);) {
+  }
+}
+
+/**
+ * Evaluates a position: draws by the fifty move rule and repetitions, checkmate and stalemate are decided by the
+ * rules, all other positions by the evaluator.
+ *
+ * @param ply The distance from the root. Repetitions of the root are not draws, the game goes on there.
+ * @param moves Set to the legal moves.
+ * @param priors Set to the prior probabilities of the moves.
+ * @param value Set to the value of the position.
+ * @param terminal Set to the value of a decided position, -1 for checkmate and 0 for a draw.
+ * @return True if the position is decided by the rules, false otherwise.
+ */
+bool Mcts::evaluate(Piece* piece, const Position& position, const std::vector<uint64_t>& keys, int ply,
+                    MoveList* moves, float* priors, MctsValue* value, int8_t* terminal) {
+  // Only the positions since the last capture or pawn move can be the same, see Search::isRepetition
+  bool repetition = false;
+  int index = keys.size() - 1;
+  for (int i = index - 4; i >= 0 && i >= index - position.halfmoveClock; i -= 2) {
+    if (keys[i] == keys[index]) repetition = true;
+  }
+  *terminal = 0;
+  if (ply > 0 && (position.halfmoveClock >= 100 || repetition)) {
+    *value = {0.0f, 1.0f, 0.0f};
+    return true;
+  }
+
+  piece->testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, moves);
+  if (moves->isEmpty()) {
+    if (piece->testCheck(position.board, position.turn)) *terminal = -1;
+    *value = {0.0f, *terminal == 0 ? 1.0f : 0.0f, *terminal < 0 ? 1.0f : 0.0f};
+    return true;
+  }
+  *value = evaluator(position, *moves, priors);
+  return false;
+}
+
+/**
+ * Expands a leaf: evaluates it and adds an edge for every legal move. If the pool is full, the node stays a leaf.
+ *
+ * @param value Set to the value of the position.
+ */
+void Mcts::expand(Piece* piece, MctsNode* node, const Position& position, const std::vector<uint64_t>& keys,
+                  int ply, MctsValue* value) {
+  MoveList moves;
+  float priors[MoveList::capacity];
+  int8_t terminal;
+  if (evaluate(piece, position, keys, ply, &moves, priors, value, &terminal)) {
+    node->terminal = terminal;
+    node->state.store(MctsNode::Terminal, std::memory_order_release);
+    return;
+  }
+
+  Pool& pool = pools[current];
+  int count = moves.size();
+  int first = pool.usedEdges.load(std::memory_order_relaxed) + count <= edgeCapacity
+                  ? pool.usedEdges.fetch_add(count, std::memory_order_relaxed)
+                  : edgeCapacity;
+  if (first + count > edgeCapacity) {
+    node->state.store(MctsNode::Leaf, std::memory_order_release);
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    MctsEdge& edge = pool.edges[first + i];
+    edge.move = moves[i];
+    edge.prior = std::clamp((int)std::lround(priors[i] * 65535), 1, 65535);
+    edge.node.store(-1, std::memory_order_relaxed);
+  }
+  node->firstEdge.store(first, std::memory_order_relaxed);
+  node->edgeCount.store(count, std::memory_order_relaxed);
+  node->state.store(MctsNode::Expanded, std::memory_order_release);
+}
+
+/**
+ * Returns the child node of an edge, and allocates it on the first visit. If two threads allocate it at the same
+ * time, both use the node of the first one, and the other node stays unused.
+ *
+ * @return The index of the child node, or -1 if the pool is full.
+ */
+int Mcts::getChild(MctsEdge* edge) {
+  int child = edge->node.load(std::memory_order_acquire);
+  if (child >= 0) return child;
+  Pool& pool = pools[current];
+  if (pool.usedNodes.load(std::memory_order_relaxed) >= nodeCapacity) return -1;
+  int index = pool.usedNodes.fetch_add(1, std::memory_order_relaxed);
+  if (index >= nodeCapacity) return -1;
+  resetNode(&pool.nodes[index]);
+  if (edge->node.compare_exchange_strong(child, index, std::memory_order_acq_rel)) return index;
+  return child;
+}
+
+/**
+ * Selects the move with the best sum of its value from the view of the node and its exploration term. Playouts,
+ * which currently pass through a child, count as losses.
+ *
+ * @return The index of the edge in the pool.
+ */
+int Mcts::selectEdge(const MctsNode& node) {
+  const MctsNode* nodes = pools[current].nodes.get();
+  const MctsEdge* edges = pools[current].edges.get();
+  int first = node.firstEdge.load(std::memory_order_relaxed);
+  int count = node.edgeCount.load(std::memory_order_relaxed);
+  int visits = node.visits.load(std::memory_order_relaxed);
+  float exploration = explorationFactor * std::sqrt((float)std::max(1, visits)) / 65535;
+  float parentValue = visits > 0 ? (node.winSum.load(std::memory_order_relaxed) -
+                                    node.lossSum.load(std::memory_order_relaxed)) / visits
+                                 : 0.0f;
+
+  int best = first;
+  float bestScore = -1e9f;
+  for (int i = first; i < first + count; i++) {
+    int index = edges[i].node.load(std::memory_order_acquire);
+    int childVisits = 0;
+    float value = parentValue - firstPlayReduction;
+    if (index >= 0) {
+      const MctsNode& child = nodes[index];
+      childVisits = child.visits.load(std::memory_order_relaxed);
+      int virtualLoss = child.virtualLoss.load(std::memory_order_relaxed);
+      if (childVisits + virtualLoss > 0) {
+        // The statistics of the child are from the view of the opponent
+        float sum = child.lossSum.load(std::memory_order_relaxed) - child.winSum.load(std::memory_order_relaxed);
+        value = (sum - virtualLoss) / (childVisits + virtualLoss);
+      }
+      childVisits += virtualLoss;
+    }
+    float score = value + exploration * edges[i].prior / (1 + childVisits);
+    if (score > bestScore) {
+      bestScore = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+/**
+ * Returns the most visited move of an expanded node. The value of the moves breaks ties.
+ *
+ * @return The index of the edge in the pool.
+ */
+int Mcts::getBestEdge(const MctsNode& node) {
+  const MctsNode* nodes = pools[current].nodes.get();
+  const MctsEdge* edges = pools[current].edges.get();
+  int best = node.firstEdge;
+  int bestVisits = -1;
+  float bestValue = 0.0f;
+  for (int i = node.firstEdge; i < node.firstEdge + node.edgeCount; i++) {
+    int index = edges[i].node;
+    int visits = index >= 0 ? nodes[index].visits.load() : 0;
+    float value = visits > 0 ? (nodes[index].lossSum - nodes[index].winSum) / visits : -1.0f;
+    if (visits > bestVisits || (visits == bestVisits && value > bestValue)) {
+      best = i;
+      bestVisits = visits;
+      bestValue = value;
+    }
+  }
+  return best;
+}
+
+/**
+ * Keeps the part of the tree, which starts at the new root. The root itself, its children and its grandchildren are
+ * compared with the new root.
+ *
+ * @return True if the tree starts at the new root now, false if no part of the tree can be used.
+ */
+bool Mcts::reuseTree(const Position& root) {
+  if (!hasTree) return false;
+  uint64_t key = root.getKey();
+  if (rootPosition.getKey() == key) return true;
+
+  Piece piece;
+  const MctsNode* nodes = pools[current].nodes.get();
+  const MctsEdge* edges = pools[current].edges.get();
+  std::vector<std::pair<int, Position>> level = {{0, rootPosition}};
+  for (int ply = 1; ply <= 2; ply++) {
+    std::vector<std::pair<int, Position>> next;
+    for (const auto& [index, position] : level) {
+      const MctsNode& node = nodes[index];
+      if (node.state != MctsNode::Expanded) continue;
+      for (int i = node.firstEdge; i < node.firstEdge + node.edgeCount; i++) {
+        int child = edges[i].node;
+        if (child < 0) continue;
+        Position after;
+        position.makeMove(&piece, edges[i].move, &after);
+        if (after.getKey() == key) {
+          // A leaf or a draw by repetition in the old tree gives nothing to continue with
+          if (nodes[child].state != MctsNode::Expanded) return false;
+          current = copySubtree(child);
+          return true;
+        }
+        next.emplace_back(child, after);
+      }
+    }
+    level = std::move(next);
+  }
+  return false;
+}
+
+/**
+ * Copies a subtree into the other half of the pool, breadth first, so the edges of every node stay next to each
+ * other.
+ *
+ * @param index The root of the subtree.
+ * @return The half of the pool, which holds the subtree now.
+ */
+int Mcts::copySubtree(int index) {
+  int target = 1 - current;
+  const Pool& from = pools[current];
+  Pool& to = pools[target];
+  int usedNodes = 1;
+  int usedEdges = 0;
+  std::vector<std::pair<int, int>> queue = {{index, 0}};
+  for (size_t i = 0; i < queue.size(); i++) {
+    auto [source, node] = queue[i];
+    const MctsNode& original = from.nodes[source];
+    MctsNode& copy = to.nodes[node];
+    resetNode(&copy);
+    copy.visits = original.visits.load();
+    copy.winSum = original.winSum.load();
+    copy.lossSum = original.lossSum.load();
+    copy.terminal = original.terminal;
+    uint8_t state = original.state;
+    // A leaf, which was being expanded when the search stopped, is expanded again
+    copy.state = state == MctsNode::Expanding ? (uint8_t)MctsNode::Leaf : state;
+    if (state != MctsNode::Expanded) continue;
+
+    int first = original.firstEdge;
+    int count = original.edgeCount;
+    copy.firstEdge = usedEdges;
+    copy.edgeCount = count;
+    for (int j = 0; j < count; j++) {
+      const MctsEdge& edge = from.edges[first + j];
+      MctsEdge& edgeCopy = to.edges[usedEdges + j];
+      edgeCopy.move = edge.move;
+      edgeCopy.prior = edge.prior;
+      edgeCopy.node = edge.node >= 0 ? usedNodes++ : -1;
+      if (edge.node >= 0) queue.emplace_back(edge.node, edgeCopy.node);
+    }
+    usedEdges += count;
+  }
+  to.usedNodes = usedNodes;
+  to.usedEdges = usedEdges;
+  return target;
+}
+
+/**
+ * Checks the number of playouts, the time limits and the stop token, and stops the search if one is reached. A search
+ * with a time manager stops at its optimum time, since a tree search has no iterations to finish.
+ *
+ * @return True if the search is stopped.
+ */
+bool Mcts::checkLimits() {
+  if (stopped) return true;
+  if (limits.stopToken != nullptr && limits.stopToken->load(std::memory_order_relaxed)) stopped = true;
+  if (limits.nodes > 0 && playouts >= limits.nodes) stopped = true;
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double limit = limits.timeManager != nullptr ? limits.timeManager->getOptimum() : limits.softTime;
+  if (limits.hardTime > 0 && (limit <= 0 || limits.hardTime < limit)) limit = limits.hardTime;
+  if (limit > 0 && elapsed >= limit) stopped = true;
+  return stopped;
+}
+
+/**
+ * Sets the prior probabilities of the moves: captures, which win material in the static exchange evaluation, and
+ * promotions first, then the quiet moves, then the losing captures.
+ *
+ * @param priors Set to the probability of every move.
+ * @return The material in centipawns, which the best capture wins, 0 if no capture wins material.
+ */
+int Mcts::prioritize(const Position& position, const MoveList& moves, float* priors) {
+  Piece piece;
+  int gain = 0;
+  float sum = 0.0f;
+  for (int i = 0; i < moves.size(); i++) {
+    Move move = moves[i];
+    float logit = 0.0f;
+    if (move.isCapture()) {
+      int exchange = piece.see(position.board, move);
+      gain = std::max(gain, exchange);
+      logit = exchange >= 0 ? 1.0f + exchange / 200.0f : -1.0f;
+    }
+    if (move.isPromotion() && tolower(move.getPromotionPiece(true)) == 'q') logit += 1.5f;
+    priors[i] = std::exp(std::min(logit, 6.0f));
+    sum += priors[i];
+  }
+  for (int i = 0; i < moves.size(); i++) priors[i] /= sum;
+  return gain;
+}
+
+/**
+ * Returns an evaluator with the hand written Evaluation. The best capture of the player to move is added, since a
+ * leaf is evaluated without a quiescence search.
+ */
+MctsEvaluator Mcts::staticEvaluator() {
+  return [](const Position& position, const MoveList& moves, float* priors) {
+    int gain = prioritize(position, moves, priors);
+    int score = Evaluation::evaluate(position.board, position.turn, PawnTable::computeKey(position.board));
+    return fromCentipawns(score + gain);
+  };
+}
+
+/**
+ * Returns an evaluator with a network. The network is only read and must outlive the searches.
+ *
+ * @param network A loaded network.
+ */
+MctsEvaluator Mcts::networkEvaluator(Nnue* network) {
+  return [network](const Position& position, const MoveList& moves, float* priors) {
+    int gain = prioritize(position, moves, priors);
+    NnueAccumulator accumulator;
+    network->refresh(position.board, &accumulator);
+    return fromCentipawns(network->evaluate(accumulator, position.turn) + gain);
+  };
+}
+
+/**
+ * Converts a score into the probabilities of a win, a draw and a loss. Around equality, about half of the games are
+ * drawn, and every 100 centipawns shift the balance clearly towards one side.
+ *
+ * @param score The score in centipawns from the view of the player to move.
+ */
+MctsValue Mcts::fromCentipawns(int score) {
+  float clamped = std::clamp(score, -2000, 2000);
+  float win = 1.0f / (1.0f + std::exp(-(clamped - 100.0f) / 90.0f));
+  float loss = 1.0f / (1.0f + std::exp((clamped + 100.0f) / 90.0f));
+  return {win, std::max(0.0f, 1.0f - win - loss), loss};
+}
+
+/**
+ * Converts probabilities back into a score, the score with the same expected result in fromCentipawns.
+ */
+int Mcts::toCentipawns(const MctsValue& value) {
+  float expected = value.win + value.draw / 2;
+  int low = -2000;
+  int high = 2000;
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+    MctsValue guess = fromCentipawns(middle);
+    if (guess.win + guess.draw / 2 < expected)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+/**
+ * Initializes a node of the pool as an unvisited leaf.
+ */
+void Mcts::resetNode(MctsNode* node) {
+  node->visits.store(0, std::memory_order_relaxed);
+  node->virtualLoss.store(0, std::memory_order_relaxed);
+  node->winSum.store(0.0f, std::memory_order_relaxed);
+  node->lossSum.store(0.0f, std::memory_order_relaxed);
+  node->firstEdge.store(0, std::memory_order_relaxed);
+  node->edgeCount.store(0, std::memory_order_relaxed);
+  node->terminal = 0;
+  node->state.store(MctsNode::Leaf, std::memory_order_relaxed);
+}
+
+/**
+ * Stops the search as soon as possible. Can be called from any thread.
+ */
+void Mcts::stop() { stopped = true; }
+
+/**
+ * Drops the tree, so the next search starts from scratch.
+ */
+void Mcts::clear() { hasTree = false; }
+
+/**
+ * Sets the evaluator of the leaves, see staticEvaluator and networkEvaluator.
+ */
+void Mcts::setEvaluator(MctsEvaluator pEvaluator) { evaluator = std::move(pEvaluator); }
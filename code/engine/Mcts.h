@@ -0,0 +1,132 @@
+#ifndef MCTS_H_
+#define MCTS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../eval/Nnue.h"
+#include "../rules/board/Position.h"
+#include "./Search.h"
+
+// Probabilities of a win, a draw and a loss from the view of the player to move
+struct MctsValue {
+  float win;
+  float draw;
+  float loss;
+};
+
+// Evaluates a leaf of the tree: returns its value and sets the prior probability of every legal move, in the order of
+// the move list. Called from several threads at once.
+using MctsEvaluator = std::function<MctsValue(const Position& position, const MoveList& moves, float* priors)>;
+
+struct MctsResult {
+  // The move with the most visits and the expected reply
+  Move best;
+  Move ponder;
+  // Value of the root from the view of the player to move, and the same as a score in centipawns
+  MctsValue value;
+  int score;
+  long long playouts;
+  // Number of nodes in the tree and the length of the longest line
+  int nodes;
+  int depth;
+  double seconds;
+  // The line of the most visited moves
+  std::vector<Move> pv;
+};
+
+// Move from a node of the tree to a child. The child node is only allocated, when a playout visits the move first.
+struct MctsEdge {
+  Move move;
+  // Prior probability of the move, scaled to 65535
+  uint16_t prior;
+  // Index of the child node in the pool, -1 while the move is not visited
+  std::atomic<int> node;
+};
+
+// Node of the tree. Its statistics are from the view of the player to move in the node. The edges to the children of
+// a node are stored next to each other in the edge pool.
+struct MctsNode {
+  enum State : uint8_t { Leaf, Expanding, Expanded, Terminal };
+
+  std::atomic<int> visits;
+  // Playouts, which currently pass through the node, each counts as a loss until it is backed up
+  std::atomic<int> virtualLoss;
+  std::atomic<float> winSum;
+  std::atomic<float> lossSum;
+  std::atomic<int> firstEdge;
+  std::atomic<uint8_t> edgeCount;
+  std::atomic<uint8_t> state;
+  // Value of a terminal node: -1 if the player to move is checkmated, 0 for a draw
+  int8_t terminal;
+};
+
+// Monte Carlo tree search with the PUCT selection: every playout follows the moves with the best sum of their value
+// and an exploration term, which grows with the prior and shrinks with the visits, evaluates a new leaf with the
+// evaluator and backs its value up. Several threads share one tree, and a virtual loss on every node of a running
+// playout spreads them over different lines. The nodes live in a fixed pool, which is allocated once: when the next
+// search starts from a position of the tree, that part of the tree is copied into the second half of the pool and
+// searched further, and the rest of the tree is dropped. When the pool is full, the tree stops growing, but the
+// playouts go on and evaluate the leaves again.
+class Mcts {
+ public:
+  static constexpr float explorationFactor = 1.5f;
+  // Unvisited moves are valued like their parent, minus this reduction
+  static constexpr float firstPlayReduction = 0.2f;
+
+  Mcts(int pThreads, int megabytes);
+  ~Mcts();
+
+  MctsResult run(const Position& root, const SearchLimits& limits, const std::vector<uint64_t>& gameKeys);
+  void stop();
+  void clear();
+  void setEvaluator(MctsEvaluator pEvaluator);
+  static MctsEvaluator staticEvaluator();
+  static MctsEvaluator networkEvaluator(Nnue* network);
+  static MctsValue fromCentipawns(int score);
+  static int toCentipawns(const MctsValue& value);
+
+ private:
+  struct Pool {
+    std::unique_ptr<MctsNode[]> nodes;
+    std::unique_ptr<MctsEdge[]> edges;
+    std::atomic<int> usedNodes;
+    std::atomic<int> usedEdges;
+  };
+
+  void playout(Piece* piece, std::vector<uint64_t>* keys, std::vector<int>* path);
+  bool evaluate(Piece* piece, const Position& position, const std::vector<uint64_t>& keys, int ply, MoveList* moves,
+                float* priors, MctsValue* value, int8_t* terminal);
+  void expand(Piece* piece, MctsNode* node, const Position& position, const std::vector<uint64_t>& keys, int ply,
+              MctsValue* value);
+  int selectEdge(const MctsNode& node);
+  int getChild(MctsEdge* edge);
+  int getBestEdge(const MctsNode& node);
+  bool reuseTree(const Position& root);
+  int copySubtree(int index);
+  bool checkLimits();
+  static int prioritize(const Position& position, const MoveList& moves, float* priors);
+  static void resetNode(MctsNode* node);
+
+  int threads;
+  int nodeCapacity;
+  int edgeCapacity;
+  Pool pools[2];
+  // The pool with the current tree, the root is its first node
+  int current;
+  Position rootPosition;
+  bool hasTree;
+  MctsEvaluator evaluator;
+  SearchLimits limits;
+  std::vector<uint64_t> gameKeys;
+  std::chrono::steady_clock::time_point start;
+  std::atomic<bool> stopped;
+  std::atomic<long long> playouts;
+  std::atomic<int> maxDepth;
+};
+
+#endif  // MCTS_H_
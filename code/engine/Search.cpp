@@ -0,0 +1,761 @@
+#include "./Search.h"
+
+#include <utility>
+
+#include "../eval/Evaluation.h"
+#include "../eval/PawnHash.h"
+#include "../profiling/Trace.h"
+
+// Largest score of the history table, far below the killer moves. The table is halved, when a score exceeds it.
+static constexpr int maxHistory = 1 << 20;
+
+/**
+ * @brief Default limits: the maximum depth and one line, without node or time limits.
+ */
+SearchLimits::SearchLimits()
+    : depth(Search::maxPly - 1),
+      nodes(0),
+      softTime(0.0),
+      hardTime(0.0),
+      multiPv(1),
+      stopToken(nullptr),
+      ponder(false),
+      timeManager(nullptr) {}
+
+/**
+ * @brief Constructs a Search.
+ *
+ * @param pTable The transposition table, which may be shared with other searches.
+ */
+Search::Search(TranspositionTable* pTable)
+    : table(pTable),
+      network(nullptr),
+      tablebase(nullptr),
+      useSee(true),
+      stopped(false),
+      pondering(false),
+      softDeadline(0),
+      hardDeadline(0),
+      hitPending(false),
+      hitSoftTime(0.0),
+      hitHardDeadline(0),
+      nodes(0),
+      sliceNodes(0),
+      sliceEnd(0),
+      rootIndex(0),
+      killers{},
+      history{},
+      pvLength{} {}
+
+Search::~Search() {}
+
+/**
+ * Searches a position with iterative deepening, until a limit is reached or the search is stopped.
+ *
+ * @param root The position to search.
+ * @param pLimits The depth, node and time limits.
+ * @param gameKeys The keys of the positions of the game before the root, oldest first, to detect repetitions.
+ * @param onIteration Called after every finished iteration, may be empty.
+ * @return The best move and its principal variation. The best move is null if the position has no legal move.
+ */
+SearchResult Search::run(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& gameKeys,
+                         const std::function<void(const SearchInfo&)>& onIteration) {
+  TRACE_SCOPE("Search::run");
+  SearchResult result;
+  MoveList rootMoves;
+  if (!setUp(root, pLimits, gameKeys, &rootMoves, &result) || probeRoot(root, &result)) return result;
+
+  // With several lines, every iteration searches the root again without the best moves of the earlier lines
+  int lines = std::max(1, std::min(limits.multiPv, rootMoves.size()));
+  for (int depth = 1; depth <= limits.depth; depth++) {
+    int score = 0;
+    excluded.clear();
+    for (int line = 0; line < lines; line++) {
+      score = alphaBeta(0, depth, -infinity, infinity);
+      if (!finishLine(depth, line, score, &result, onIteration)) break;
+    }
+    if (isLastIteration(depth, lines, score, rootMoves.size(), result)) break;
+  }
+  excluded.clear();
+  result.nodes = nodes;
+  result.seconds = elapsed();
+  return result;
+}
+
+/**
+ * Starts a cooperative search of a position, which is then continued with resume. It runs like run, but suspends
+ * after every slice of nodes, and its time limits count from now, also while it is suspended.
+ *
+ * @param root The position to search.
+ * @param pLimits The depth, node and time limits.
+ * @param gameKeys The keys of the positions of the game before the root, oldest first, to detect repetitions.
+ * @param pSliceNodes The number of nodes, after which the search is suspended.
+ */
+void Search::begin(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& gameKeys,
+                   long long pSliceNodes) {
+  sliceNodes = std::max(1LL, pSliceNodes);
+  MoveList rootMoves;
+  task = SearchTask();
+  suspended = nullptr;
+  if (!setUp(root, pLimits, gameKeys, &rootMoves, &taskResult) || probeRoot(root, &taskResult)) return;
+  task = iterate(rootMoves);
+  suspended = task.getHandle();
+}
+
+/**
+ * Continues the cooperative search for one slice of nodes. Must be called from one thread at a time, but the slices
+ * may run on different threads.
+ *
+ * @return True if the search is finished, then getResult returns its result.
+ */
+bool Search::resume() {
+  if (suspended) {
+    sliceEnd = nodes + sliceNodes;
+    std::coroutine_handle<> node = std::exchange(suspended, nullptr);
+    node.resume();
+  }
+  if (!task.isDone()) return false;
+  if (task.getHandle()) task.await_resume();
+  return true;
+}
+
+/**
+ * The iterative deepening of the cooperative search, like in run.
+ */
+SearchTask Search::iterate(MoveList rootMoves) {
+  int lines = std::max(1, std::min(limits.multiPv, rootMoves.size()));
+  for (int depth = 1; depth <= limits.depth; depth++) {
+    int score = 0;
+    excluded.clear();
+    for (int line = 0; line < lines; line++) {
+      score = co_await alphaBetaTask(0, depth, -infinity, infinity);
+      if (!finishLine(depth, line, score, &taskResult, nullptr)) break;
+    }
+    if (isLastIteration(depth, lines, score, rootMoves.size(), taskResult)) break;
+  }
+  excluded.clear();
+  taskResult.nodes = nodes;
+  taskResult.seconds = elapsed();
+  co_return taskResult.score;
+}
+
+/**
+ * Prepares a search: sets the limits, the root position and its keys, and ages the move ordering of earlier searches.
+ *
+ * @return False if the root has no legal move, true otherwise.
+ */
+bool Search::setUp(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& gameKeys,
+                   MoveList* rootMoves, SearchResult* result) {
+  limits = pLimits;
+  start = std::chrono::steady_clock::now();
+  softDeadline = getDeadline(limits.softTime);
+  hardDeadline = getDeadline(limits.hardTime);
+  pondering = limits.ponder;
+  // A ponder hit may arrive before the ponder search started, but never belongs to a normal search
+  if (!limits.ponder) hitPending = false;
+  stopped = false;
+  nodes = 0;
+  table->newSearch();
+  for (int i = 0; i <= maxPly; i++) killers[i][0] = killers[i][1] = Move();
+  for (int i = 0; i < 64; i++) {
+    for (int j = 0; j < 64; j++) history[i][j] /= 8;
+  }
+
+  positions[0] = root;
+  pawnKeys[0] = PawnTable::computeKey(root.board);
+  keys = gameKeys;
+  rootIndex = keys.size();
+  keys.push_back(root.getKey());
+  if (network != nullptr) {
+    accumulators.resize(maxPly + 1);
+    network->refresh(root.board, &accumulators[0]);
+  }
+
+  *result = {Move(), Move(), 0, 0, 0, 0.0, {}};
+  piece.testAvailableMoves(root.board, root.turn, root.lastMove, root.castling, rootMoves);
+  if (rootMoves->isEmpty()) return false;
+  // Always have a move, even if the first iteration is stopped
+  result->best = (*rootMoves)[0];
+  result->pv = {(*rootMoves)[0]};
+  return true;
+}
+
+/**
+ * Answers a root position of the tablebases without a search: the move of perfect play and the line, in which both
+ * players keep playing perfectly. Not used with several lines.
+ *
+ * @return True if the root was answered, false otherwise.
+ */
+bool Search::probeRoot(const Position& root, SearchResult* result) {
+  int value, moves;
+  if (tablebase == nullptr || limits.multiPv > 1 || tablebase->getBestMove(root, &value, &moves).isNull()) {
+    return false;
+  }
+  result->score = value == 0 ? 0 : value > 0 ? mateScore - (2 * moves - 1) : -mateScore + 2 * moves;
+  result->pv.clear();
+  Position position = root;
+  for (int ply = 0; ply < 8; ply++) {
+    Move move = tablebase->getBestMove(position, &value, &moves);
+    if (move.isNull()) break;
+    result->pv.push_back(move);
+    Position next;
+    position.makeMove(&piece, move, &next);
+    position = next;
+  }
+  result->best = result->pv[0];
+  result->ponder = result->pv.size() > 1 ? result->pv[1] : Move();
+  result->depth = 1;
+  result->seconds = elapsed();
+  return true;
+}
+
+/**
+ * Takes over a searched line of an iteration into the result and excludes its root move from the next lines.
+ *
+ * @return True if the next line of the iteration is searched, false otherwise.
+ */
+bool Search::finishLine(int depth, int line, int score, SearchResult* result,
+                        const std::function<void(const SearchInfo&)>& onIteration) {
+  if (stopped && (depth > 1 || line > 0)) return false;
+  std::vector<Move> linePv(pv[0], pv[0] + pvLength[0]);
+  if (line == 0) {
+    if (pvLength[0] > 0) {
+      result->pv = linePv;
+      result->best = result->pv[0];
+      result->ponder = result->pv.size() > 1 ? result->pv[1] : Move();
+    }
+    result->score = score;
+    result->depth = depth;
+    result->nodes = nodes;
+    result->seconds = elapsed();
+    linePv = result->pv;
+  }
+  if (onIteration) onIteration({depth, score, nodes, elapsed(), linePv, line});
+  if (stopped || linePv.empty()) return false;
+  excluded.add(linePv[0]);
+  return true;
+}
+
+/**
+ * Checks after an iteration, if the search is stopped, a limit is reached or the time manager ends the search.
+ */
+bool Search::isLastIteration(int depth, int lines, int score, int rootMoves, const SearchResult& result) {
+  if (stopped) return true;
+  // A forced mate was found, deeper iterations can not change it
+  if (lines == 1 && score > mateScore - maxPly && mateScore - score <= depth) return true;
+  if (!isPondering() && softDeadline > 0 && getClock() >= softDeadline) return true;
+  // The time manager sees every iteration, also while pondering, but only stops a timed search
+  return limits.timeManager != nullptr &&
+         limits.timeManager->isDone(depth, result.best, result.score, elapsed(), rootMoves) && !isPondering();
+}
+
+/**
+ * Searches a position to a depth and returns its score from the view of the player to move. Fails soft: scores
+ * outside of the window are bounds of the real score.
+ */
+int Search::alphaBeta(int ply, int depth, int alpha, int beta) {
+  Node node;
+  int score;
+  if (enterNode(&node, ply, depth, alpha, beta, &score)) return score;
+
+  if (tryNullMove(node)) {
+    score = -alphaBeta(ply + 1, node.depth - 3 - node.depth / 6, -beta, -beta + 1);
+    if (stopped) return 0;
+    if (score >= beta) return score >= mateScore - maxPly ? beta : score;
+  }
+
+  if (generateMoves(&node, &score)) return score;
+  while (nextMove(&node)) {
+    if (node.bestMove.isNull()) {
+      score = -alphaBeta(ply + 1, node.depth - 1, -node.beta, -node.alpha);
+    } else {
+      // Late quiet moves are searched with a reduced depth first, and all later moves with a null window
+      int reduction = getReduction(node);
+      score = -alphaBeta(ply + 1, node.depth - 1 - reduction, -node.alpha - 1, -node.alpha);
+      if (score > node.alpha && reduction > 0)
+        score = -alphaBeta(ply + 1, node.depth - 1, -node.alpha - 1, -node.alpha);
+      if (score > node.alpha && score < node.beta)
+        score = -alphaBeta(ply + 1, node.depth - 1, -node.beta, -node.alpha);
+    }
+    if (stopped) return 0;
+    if (addScore(&node, score)) break;
+  }
+  return leaveNode(node);
+}
+
+/**
+ * The same search as alphaBeta as a coroutine, which suspends the search, when the slice of nodes is used up. The
+ * quiescence search below it is not suspended, its trees are small.
+ */
+SearchTask Search::alphaBetaTask(int ply, int depth, int alpha, int beta) {
+  Node node;
+  int score;
+  if (enterNode(&node, ply, depth, alpha, beta, &score)) co_return score;
+  co_await Yield{this};
+
+  if (tryNullMove(node)) {
+    score = -co_await alphaBetaTask(ply + 1, node.depth - 3 - node.depth / 6, -beta, -beta + 1);
+    if (stopped) co_return 0;
+    if (score >= beta) co_return score >= mateScore - maxPly ? beta : score;
+  }
+
+  if (generateMoves(&node, &score)) co_return score;
+  while (nextMove(&node)) {
+    if (node.bestMove.isNull()) {
+      score = -co_await alphaBetaTask(ply + 1, node.depth - 1, -node.beta, -node.alpha);
+    } else {
+      int reduction = getReduction(node);
+      score = -co_await alphaBetaTask(ply + 1, node.depth - 1 - reduction, -node.alpha - 1, -node.alpha);
+      if (score > node.alpha && reduction > 0)
+        score = -co_await alphaBetaTask(ply + 1, node.depth - 1, -node.alpha - 1, -node.alpha);
+      if (score > node.alpha && score < node.beta)
+        score = -co_await alphaBetaTask(ply + 1, node.depth - 1, -node.beta, -node.alpha);
+    }
+    if (stopped) co_return 0;
+    if (addScore(&node, score)) break;
+  }
+  co_return leaveNode(node);
+}
+
+/**
+ * Enters a node of the main search: checks for draws, the limits and the transposition table, which may already
+ * decide the node without searching its moves.
+ *
+ * @param score Set to the score of the node, if it is decided.
+ * @return True if the node is decided, false if its moves have to be searched.
+ */
+bool Search::enterNode(Node* node, int ply, int depth, int alpha, int beta, int* score) {
+  pvLength[ply] = 0;
+  const Position& position = positions[ply];
+  *score = 0;
+  if (ply > 0 && (position.halfmoveClock >= 100 || isRepetition(ply))) return true;
+  // The tablebases decide a position with the exact distance to the mate. Mates beyond the last ply of the search
+  // are scored just below the mate scores.
+  int result, moves;
+  if (ply > 0 && tablebase != nullptr && tablebase->probe(position, &result, &moves)) {
+    int mate = std::min(ply + (result > 0 ? 2 * moves - 1 : 2 * moves), maxPly);
+    *score = result == 0 ? 0 : result > 0 ? mateScore - mate : -mateScore + mate;
+    return true;
+  }
+  if (ply >= maxPly) {
+    *score = evaluate(ply);
+    return true;
+  }
+  node->inCheck = piece.testCheck(position.board, position.turn);
+  if (node->inCheck) depth++;
+  if (depth <= 0) {
+    *score = quiescence(ply, alpha, beta);
+    return true;
+  }
+  nodes++;
+  if ((nodes & 1023) == 0 && checkLimits()) return true;
+
+  node->ply = ply;
+  node->depth = depth;
+  node->alpha = alpha;
+  node->beta = beta;
+  node->originalAlpha = alpha;
+  node->bestScore = -infinity;
+  node->bestMove = Move();
+  node->index = -1;
+
+  // A stored result of at least the same depth decides the position, unless the exact line is needed
+  node->pvNode = beta - alpha > 1;
+  node->key = keys[rootIndex + ply];
+  TableEntry& entry = node->entry;
+  entry = {Move(), 0, 0, TranspositionTable::None};
+  bool found = table->probe(node->key, &entry);
+  if (found) {
+    if (entry.score > mateScore - maxPly) entry.score -= ply;
+    if (entry.score < -mateScore + maxPly) entry.score += ply;
+  }
+  if (found && ply > 0 && !node->pvNode && entry.depth >= depth &&
+      (entry.bound == TranspositionTable::Exact ||
+       (entry.bound == TranspositionTable::Lower && entry.score >= beta) ||
+       (entry.bound == TranspositionTable::Upper && entry.score <= alpha))) {
+    *score = entry.score;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Null move pruning: if passing still holds beta, the position is good enough. Not used without pieces, where
+ * passing could be better than every move (zugzwang).
+ *
+ * @return True if the null move was made into the next ply and has to be searched, false otherwise.
+ */
+bool Search::tryNullMove(const Node& node) {
+  int ply = node.ply;
+  if (node.pvNode || node.inCheck || ply == 0 || node.depth < 3 || evaluate(ply) < node.beta) return false;
+  const Position& position = positions[ply];
+  bool pieces = false;
+  for (char c : position.board) {
+    if (c != ' ' && (isupper(c) != 0) == position.turn && tolower(c) != 'p' && tolower(c) != 'k') pieces = true;
+  }
+  if (!pieces) return false;
+
+  Position& next = positions[ply + 1];
+  next = position;
+  next.turn = !position.turn;
+  next.lastMove = Move();
+  next.halfmoveClock = 0;
+  pawnKeys[ply + 1] = pawnKeys[ply];
+  if (network != nullptr) accumulators[ply + 1] = accumulators[ply];
+  keys.resize(rootIndex + ply + 1);
+  keys.push_back(next.getKey());
+  return true;
+}
+
+/**
+ * Generates and scores the moves of a node.
+ *
+ * @param score Set to the score of the node, if it has no legal move.
+ * @return True if the node is checkmate or stalemate, false otherwise.
+ */
+bool Search::generateMoves(Node* node, int* score) {
+  const Position& position = positions[node->ply];
+  piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &node->moves);
+  if (node->moves.isEmpty()) {
+    *score = node->inCheck ? -mateScore + node->ply : 0;
+    return true;
+  }
+  scoreMoves(node->ply, node->moves, node->entry.move, node->scores);
+  return false;
+}
+
+/**
+ * Selects the next move of a node and makes it into the next ply. Selection sort: only the moves, which are actually
+ * searched, are sorted.
+ *
+ * @return True if there is a next move, false if all moves are searched.
+ */
+bool Search::nextMove(Node* node) {
+  MoveList& moves = node->moves;
+  int* scores = node->scores;
+  for (int i = node->index + 1; i < moves.size(); i++) {
+    int best = i;
+    for (int j = i + 1; j < moves.size(); j++) {
+      if (scores[j] > scores[best]) best = j;
+    }
+    Move move = moves[best];
+    std::swap(scores[i], scores[best]);
+    moves[best] = moves[i];
+    moves[i] = move;
+    node->index = i;
+    if (node->ply == 0 && isExcluded(move)) continue;
+    node->move = move;
+    makeMove(node->ply, move);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Returns the reduction of the current move: late quiet moves are searched with a smaller depth first.
+ */
+int Search::getReduction(const Node& node) {
+  bool quiet = !node.move.isCapture() && !node.move.isPromotion();
+  return quiet && !node.inCheck && node.depth >= 3 && node.index >= 3 ? 1 + (node.index >= 8) : 0;
+}
+
+/**
+ * Takes over the score of the current move, and updates the principal variation and the move ordering.
+ *
+ * @return True if the move causes a beta cutoff, so the other moves are not searched.
+ */
+bool Search::addScore(Node* node, int score) {
+  int ply = node->ply;
+  Move move = node->move;
+  if (score > node->bestScore) {
+    node->bestScore = score;
+    node->bestMove = move;
+    if (score > node->alpha) {
+      node->alpha = score;
+      pv[ply][0] = move;
+      for (int j = 0; j < pvLength[ply + 1]; j++) pv[ply][j + 1] = pv[ply + 1][j];
+      pvLength[ply] = pvLength[ply + 1] + 1;
+    }
+  }
+  if (node->alpha < node->beta) return false;
+  if (!move.isCapture() && !move.isPromotion()) {
+    if (killers[ply][0] != move) {
+      killers[ply][1] = killers[ply][0];
+      killers[ply][0] = move;
+    }
+    int& score = history[move.getFrom()][move.getTo()];
+    score += node->depth * node->depth;
+    if (score > maxHistory) {
+      for (int i = 0; i < 64; i++) {
+        for (int j = 0; j < 64; j++) history[i][j] /= 2;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Stores the result of a searched node in the transposition table.
+ *
+ * @return The score of the node.
+ */
+int Search::leaveNode(const Node& node) {
+  int ply = node.ply;
+  int bestScore = node.bestScore;
+  int bound = bestScore >= node.beta            ? TranspositionTable::Lower
+              : bestScore > node.originalAlpha ? TranspositionTable::Exact
+                                               : TranspositionTable::Upper;
+  int stored = bestScore > mateScore - maxPly ? bestScore + ply : bestScore < -mateScore + maxPly ? bestScore - ply
+                                                                                                    : bestScore;
+  // The root without the excluded moves is not the real root position
+  if (ply > 0 || excluded.isEmpty())
+    table->store(node.key, bound == TranspositionTable::Upper ? Move() : node.bestMove, stored, node.depth, bound);
+  return bestScore;
+}
+
+/**
+ * Suspends the cooperative search, if the nodes of the slice are used up.
+ */
+bool Search::Yield::await_ready() const noexcept { return search->nodes < search->sliceEnd; }
+
+/**
+ * Remembers the suspended node, resume continues the search from there.
+ */
+void Search::Yield::await_suspend(std::coroutine_handle<> node) noexcept { search->suspended = node; }
+
+/**
+ * Searches only the captures and promotions, until the position is quiet, so the evaluation is not taken in the
+ * middle of an exchange. In check, all moves are searched.
+ */
+int Search::quiescence(int ply, int alpha, int beta) {
+  pvLength[ply] = 0;
+  nodes++;
+  if ((nodes & 1023) == 0 && checkLimits()) return 0;
+  const Position& position = positions[ply];
+  if (ply >= maxPly) return evaluate(ply);
+  bool inCheck = piece.testCheck(position.board, position.turn);
+
+  int bestScore = -infinity;
+  if (!inCheck) {
+    // Stand pat: the player does not have to capture
+    bestScore = evaluate(ply);
+    if (bestScore >= beta) return bestScore;
+    if (bestScore > alpha) alpha = bestScore;
+  }
+
+  MoveList moves;
+  piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+  if (moves.isEmpty()) return inCheck ? -mateScore + ply : 0;
+  int scores[MoveList::capacity];
+  scoreMoves(ply, moves, Move(), scores);
+
+  for (int i = 0; i < moves.size(); i++) {
+    int best = i;
+    for (int j = i + 1; j < moves.size(); j++) {
+      if (scores[j] > scores[best]) best = j;
+    }
+    Move move = moves[best];
+    std::swap(scores[i], scores[best]);
+    moves[best] = moves[i];
+    moves[i] = move;
+    if (!inCheck && !move.isCapture() && !move.isPromotion()) continue;
+    // Captures, which lose material, can not improve the position
+    if (!inCheck && useSee && move.isCapture() && piece.see(position.board, move) < 0) continue;
+
+    makeMove(ply, move);
+    int score = -quiescence(ply + 1, -beta, -alpha);
+    if (stopped) return 0;
+    if (score > bestScore) {
+      bestScore = score;
+      if (score > alpha) {
+        alpha = score;
+        pv[ply][0] = move;
+        for (int j = 0; j < pvLength[ply + 1]; j++) pv[ply][j + 1] = pv[ply + 1][j];
+        pvLength[ply] = pvLength[ply + 1] + 1;
+      }
+    }
+    if (alpha >= beta) break;
+  }
+  return bestScore;
+}
+
+/**
+ * Makes a move of the position at a ply into the position of the next ply, and updates the keys and the accumulator.
+ */
+void Search::makeMove(int ply, Move move) {
+  const Position& position = positions[ply];
+  Position& next = positions[ply + 1];
+  position.makeMove(&piece, move, &next);
+
+  // Only the squares of the move and the pawn captured en passant can change the pawns
+  uint64_t pawnKey = pawnKeys[ply];
+  int squares[3] = {move.getFrom(), move.getTo(), move.getFrom() / 8 * 8 + move.getTo() % 8};
+  for (int i = 0; i < (move.isEnPassant() ? 3 : 2); i++) {
+    int square = squares[i];
+    pawnKey ^= PawnTable::squareKey(position.board[square], square) ^ PawnTable::squareKey(next.board[square], square);
+  }
+  pawnKeys[ply + 1] = pawnKey;
+
+  keys.resize(rootIndex + ply + 1);
+  keys.push_back(next.getKey());
+  if (network != nullptr) network->update(accumulators[ply], position.board, next.board, &accumulators[ply + 1]);
+}
+
+/**
+ * Orders the moves: the move of the transposition table first, then captures by the value of the captured and the
+ * capturing piece, killer moves and the other quiet moves by their history. Captures, which lose material in the
+ * static exchange evaluation, come after the quiet moves.
+ */
+void Search::scoreMoves(int ply, const MoveList& moves, Move tableMove, int* scores) {
+  const std::string& board = positions[ply].board;
+  for (int i = 0; i < moves.size(); i++) {
+    Move move = moves[i];
+    if (move == tableMove) {
+      scores[i] = 1 << 30;
+    } else if (move.isCapture() || move.isPromotion()) {
+      int victim = move.isEnPassant() ? 100 : Piece::getExchangeValue(board[move.getTo()]);
+      int promotion = move.isPromotion() ? Piece::getExchangeValue(move.getPromotionPiece(true)) : 0;
+      scores[i] = (1 << 24) + 16 * (victim + promotion) - Piece::getExchangeValue(board[move.getFrom()]) / 16;
+      if (useSee && move.isCapture() && piece.see(board, move) < 0) scores[i] -= 1 << 25;
+    } else if (move == killers[ply][0]) {
+      scores[i] = (1 << 23) + 1;
+    } else if (move == killers[ply][1]) {
+      scores[i] = 1 << 23;
+    } else {
+      scores[i] = history[move.getFrom()][move.getTo()];
+    }
+  }
+}
+
+/**
+ * Evaluates the position at a ply from the view of the player to move.
+ */
+int Search::evaluate(int ply) {
+  const Position& position = positions[ply];
+  if (network != nullptr) return network->evaluate(accumulators[ply], position.turn);
+  return Evaluation::evaluate(position.board, position.turn, pawnKeys[ply]);
+}
+
+/**
+ * Checks if the position at a ply occurred before, in the search or in the game. Only the positions since the last
+ * capture or pawn move can be the same, and only every second one has the same player to move. A single repetition
+ * counts as a draw, since the same moves could repeat it again.
+ */
+bool Search::isRepetition(int ply) {
+  int index = rootIndex + ply;
+  int first = index - positions[ply].halfmoveClock;
+  for (int i = index - 4; i >= 0 && i >= first; i -= 2) {
+    if (keys[i] == keys[index]) return true;
+  }
+  return false;
+}
+
+/**
+ * Checks the node and time limits, and stops the search if one is reached.
+ *
+ * @return True if the search is stopped.
+ */
+bool Search::checkLimits() {
+  if (limits.stopToken != nullptr && limits.stopToken->load(std::memory_order_relaxed)) stopped = true;
+  if (limits.nodes > 0 && nodes >= limits.nodes) stopped = true;
+  if (!isPondering() && hardDeadline > 0 && getClock() >= hardDeadline) stopped = true;
+  return stopped;
+}
+
+/**
+ * Ends pondering: the search continues with the given time limits. The soft limit counts from the start of the ponder
+ * search, since the pondered time was already spent on the right position, the hard limit counts from now. Can be
+ * called from another thread, also shortly before the ponder search starts.
+ *
+ * @param softTime The time, after which no new iteration is started, 0 for no limit.
+ * @param hardTime The time, after which the search is stopped, 0 for no limit.
+ */
+void Search::ponderHit(double softTime, double hardTime) {
+  hitSoftTime = softTime;
+  hitHardDeadline = getDeadline(hardTime);
+  hitPending = true;
+}
+
+/**
+ * Checks if the search still ponders. A ponder hit from another thread is taken over here, so the time limits are
+ * only changed by the searching thread.
+ */
+bool Search::isPondering() {
+  if (pondering && hitPending.exchange(false)) {
+    long long startClock = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+    softDeadline = hitSoftTime > 0 ? startClock + (long long)(hitSoftTime * 1e9) : 0;
+    hardDeadline = hitHardDeadline;
+    pondering = false;
+  }
+  return pondering;
+}
+
+/**
+ * Converts a time limit into a point of the steady clock in nanoseconds, see getClock.
+ *
+ * @param seconds The time from now, 0 for no limit.
+ * @return The deadline, or 0 for no limit.
+ */
+long long Search::getDeadline(double seconds) { return seconds > 0 ? getClock() + (long long)(seconds * 1e9) : 0; }
+
+/**
+ * Returns the current time of the steady clock in nanoseconds.
+ */
+long long Search::getClock() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * Checks if a root move belongs to one of the better lines, which were already searched in this iteration.
+ */
+bool Search::isExcluded(Move move) {
+  for (int i = 0; i < excluded.size(); i++) {
+    if (excluded[i] == move) return true;
+  }
+  return false;
+}
+
+/**
+ * Returns the seconds since the start of the search.
+ */
+double Search::elapsed() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Stops the search as soon as possible. Can be called from any thread, run then returns the best move of the last
+ * finished iteration.
+ */
+void Search::stop() { stopped = true; }
+
+/**
+ * Sets the network, which evaluates the positions. Without a network, the hand written Evaluation is used.
+ *
+ * @param pNetwork A loaded network, or nullptr.
+ */
+void Search::setNetwork(Nnue* pNetwork) { network = pNetwork != nullptr && pNetwork->isLoaded() ? pNetwork : nullptr; }
+
+/**
+ * Enables the static exchange evaluation for ordering and pruning captures.
+ *
+ * @param pUseSee True to use it, false to order captures only by the captured and capturing piece.
+ */
+void Search::setUseSee(bool pUseSee) { useSee = pUseSee; }
+
+/**
+ * Sets the tablebases, which decide the positions with few pieces and answer such roots without a search.
+ *
+ * @param pTablebase The tablebases, which are not owned by the search and may be shared, or nullptr.
+ */
+void Search::setTablebase(Tablebase* pTablebase) { tablebase = pTablebase; }
+
+/**
+ * @brief Getters of the Search class.
+ *
+ * */
+bool Search::isStopped() { return stopped; }
+
+const SearchResult& Search::getResult() { return taskResult; }
+
+FrameArena* Search::getFrames() { return &frames; }
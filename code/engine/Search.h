@@ -0,0 +1,184 @@
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "../eval/Nnue.h"
+#include "../rules/board/Position.h"
+#include "./SearchTask.h"
+#include "./Tablebase.h"
+#include "./TimeManager.h"
+#include "./TranspositionTable.h"
+
+struct SearchLimits {
+  // Maximum depth in plies
+  int depth;
+  // Maximum number of nodes, 0 for no limit
+  long long nodes;
+  // No new iteration is started after the soft time, the search is stopped at the hard time. 0 for no limit.
+  double softTime;
+  double hardTime;
+  // Number of principal variations, each starting with a different root move
+  int multiPv;
+  // The search stops as soon as this flag is set by another thread, may be null
+  const std::atomic<bool>* stopToken;
+  // Searches without time limits until ponderHit is called, for searching the expected reply of the opponent
+  bool ponder;
+  // Decides after every iteration, if the next one is started, may be null. The hard time should be its maximum.
+  TimeManager* timeManager;
+
+  SearchLimits();
+};
+
+// State of the search after a finished iteration
+struct SearchInfo {
+  int depth;
+  int score;
+  long long nodes;
+  double seconds;
+  std::vector<Move> pv;
+  // Index of the principal variation, 0 for the best line
+  int line;
+};
+
+struct SearchResult {
+  Move best;
+  // Expected reply of the opponent, the second move of the principal variation
+  Move ponder;
+  int score;
+  int depth;
+  long long nodes;
+  double seconds;
+  std::vector<Move> pv;
+};
+
+// Alpha-beta search with iterative deepening, principal variation search, a transposition table and a quiescence
+// search of the captures. It can search several lines at the root (multi-PV). Every thread needs its own Search, but
+// the table may be shared. Besides run, which searches until a limit is reached, a search can be started with begin
+// and then continued in slices of nodes with resume, so one thread can take turns between many searches.
+class Search {
+ public:
+  static constexpr int maxPly = 96;
+  static constexpr int mateScore = 30000;
+  static constexpr int infinity = 32000;
+
+  explicit Search(TranspositionTable* pTable);
+  ~Search();
+
+  SearchResult run(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& gameKeys,
+                   const std::function<void(const SearchInfo&)>& onIteration);
+  void begin(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& gameKeys,
+             long long pSliceNodes);
+  bool resume();
+  const SearchResult& getResult();
+  void stop();
+  void ponderHit(double softTime, double hardTime);
+  void setNetwork(Nnue* pNetwork);
+  void setUseSee(bool pUseSee);
+  void setTablebase(Tablebase* pTablebase);
+  bool isStopped();
+  FrameArena* getFrames();
+
+ private:
+  // State of a node of the main search, shared by the recursive and the cooperative search
+  struct Node {
+    int ply;
+    int depth;
+    int alpha;
+    int beta;
+    int originalAlpha;
+    bool inCheck;
+    bool pvNode;
+    uint64_t key;
+    TableEntry entry;
+    MoveList moves;
+    int scores[MoveList::capacity];
+    // Index and move of the current move, and the best move so far
+    int index;
+    Move move;
+    int bestScore;
+    Move bestMove;
+  };
+
+  // Suspends the cooperative search, when its slice of nodes is used up
+  struct Yield {
+    Search* search;
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> node) noexcept;
+    void await_resume() const noexcept {}
+  };
+
+  bool setUp(const Position& root, const SearchLimits& pLimits, const std::vector<uint64_t>& gameKeys,
+             MoveList* rootMoves, SearchResult* result);
+  bool probeRoot(const Position& root, SearchResult* result);
+  bool finishLine(int depth, int line, int score, SearchResult* result,
+                  const std::function<void(const SearchInfo&)>& onIteration);
+  bool isLastIteration(int depth, int lines, int score, int rootMoves, const SearchResult& result);
+  int alphaBeta(int ply, int depth, int alpha, int beta);
+  SearchTask iterate(MoveList rootMoves);
+  SearchTask alphaBetaTask(int ply, int depth, int alpha, int beta);
+  bool enterNode(Node* node, int ply, int depth, int alpha, int beta, int* score);
+  bool tryNullMove(const Node& node);
+  bool generateMoves(Node* node, int* score);
+  bool nextMove(Node* node);
+  int getReduction(const Node& node);
+  bool addScore(Node* node, int score);
+  int leaveNode(const Node& node);
+  int quiescence(int ply, int alpha, int beta);
+  int evaluate(int ply);
+  void makeMove(int ply, Move move);
+  void scoreMoves(int ply, const MoveList& moves, Move tableMove, int* scores);
+  bool isRepetition(int ply);
+  bool isExcluded(Move move);
+  bool isPondering();
+  bool checkLimits();
+  double elapsed();
+  static long long getDeadline(double seconds);
+  static long long getClock();
+
+  Piece piece;
+  TranspositionTable* table;
+  Nnue* network;
+  Tablebase* tablebase;
+  bool useSee;
+  SearchLimits limits;
+  std::chrono::steady_clock::time_point start;
+  std::atomic<bool> stopped;
+  // Time limits as points of the steady clock, 0 for no limit, and the limits of a ponder hit from another thread
+  bool pondering;
+  long long softDeadline;
+  long long hardDeadline;
+  std::atomic<bool> hitPending;
+  std::atomic<double> hitSoftTime;
+  std::atomic<long long> hitHardDeadline;
+  long long nodes;
+  // Frames of the nodes of the cooperative search, declared before the search, so they outlive it
+  FrameArena frames;
+  // The cooperative search, the node to continue it from, the nodes of a slice and the result of the search
+  SearchTask task;
+  std::coroutine_handle<> suspended;
+  long long sliceNodes;
+  long long sliceEnd;
+  SearchResult taskResult;
+
+  // Positions of the current line, their keys and the keys of the game before the root
+  Position positions[maxPly + 1];
+  uint64_t pawnKeys[maxPly + 1];
+  std::vector<uint64_t> keys;
+  int rootIndex;
+  // Root moves of the better lines of the current iteration
+  MoveList excluded;
+  std::vector<NnueAccumulator> accumulators;
+
+  Move killers[maxPly + 1][2];
+  int history[64][64];
+  Move pv[maxPly + 1][maxPly + 1];
+  int pvLength[maxPly + 1];
+};
+
+#endif  // SEARCH_H_
@@ -0,0 +1,156 @@
+#include "./SearchScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+#include "../profiling/Trace.h"
+
+/**
+ * @brief Constructs a SearchScheduler and starts its threads.
+ *
+ * @param pThreads The number of threads, which run the sessions.
+ * @param hashMegabytes The size of the transposition table, which all sessions share.
+ * @param pSliceNodes The number of nodes a session searches, before the thread is given to the next session.
+ */
+SearchScheduler::SearchScheduler(int pThreads, int hashMegabytes, long long pSliceNodes)
+    : table(hashMegabytes), network(nullptr), sliceNodes(std::max(1LL, pSliceNodes)), nextId(0), stopping(false) {
+  for (int i = 0; i < std::max(1, pThreads); i++) workers.emplace_back(&SearchScheduler::work, this);
+}
+
+/**
+ * @brief Stops the threads. Sessions, which are not finished yet, are dropped without calling their callback.
+ */
+SearchScheduler::~SearchScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    for (auto& entry : sessions) entry.second->search->stop();
+  }
+  ready.notify_all();
+  for (std::thread& worker : workers) worker.join();
+}
+
+/**
+ * Starts a session, which searches a position with the given limits. The search stops at the deadline at the latest.
+ *
+ * @param root The position to search.
+ * @param gameKeys The keys of the positions of the game before the root, oldest first, to detect repetitions.
+ * @param limits The limits of the search, usually a small depth or a number of nodes.
+ * @param deadline The seconds from now, until the result is needed, 0 for no deadline.
+ * @param onDone Called with the id and the result of the session on the thread, which finished it.
+ * @return The id of the session.
+ */
+int SearchScheduler::submit(const Position& root, const std::vector<uint64_t>& gameKeys, const SearchLimits& limits,
+                            double deadline, std::function<void(int, const SearchResult&)> onDone) {
+  auto session = std::make_unique<Session>();
+  session->cancelled = false;
+  session->onDone = std::move(onDone);
+  long long now =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  session->deadline = deadline > 0 ? now + (long long)(deadline * 1e9) : LLONG_MAX;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    session->id = nextId++;
+    if (spare.empty()) {
+      session->search = std::make_unique<Search>(&table);
+    } else {
+      session->search = std::move(spare.back());
+      spare.pop_back();
+    }
+    session->search->setNetwork(network);
+  }
+
+  SearchLimits sessionLimits = limits;
+  if (deadline > 0 && (sessionLimits.hardTime <= 0 || deadline < sessionLimits.hardTime))
+    sessionLimits.hardTime = deadline;
+  session->search->begin(root, sessionLimits, gameKeys, sliceNodes);
+
+  int id = session->id;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push(session.get());
+    sessions[id] = std::move(session);
+  }
+  ready.notify_one();
+  return id;
+}
+
+/**
+ * Stops a session. Its callback is not called.
+ *
+ * @param id The id of the session.
+ * @return True if the session was still running, false otherwise.
+ */
+bool SearchScheduler::cancel(int id) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto entry = sessions.find(id);
+  if (entry == sessions.end() || entry->second->cancelled) return false;
+  entry->second->cancelled = true;
+  entry->second->search->stop();
+  return true;
+}
+
+/**
+ * Waits until all sessions are finished and their callbacks returned.
+ */
+void SearchScheduler::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock, [this] { return sessions.empty(); });
+}
+
+/**
+ * Sets the network, which evaluates the positions of the following sessions. The network is only read by the sessions
+ * and must outlive them.
+ *
+ * @param pNetwork A loaded network, or nullptr for the hand written Evaluation.
+ */
+void SearchScheduler::setNetwork(Nnue* pNetwork) {
+  std::lock_guard<std::mutex> lock(mutex);
+  network = pNetwork;
+}
+
+/**
+ * Returns the number of sessions, which are not finished yet.
+ */
+int SearchScheduler::getPending() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return sessions.size();
+}
+
+bool SearchScheduler::Later::operator()(const Session* a, const Session* b) const {
+  return a->deadline != b->deadline ? a->deadline > b->deadline : a->id > b->id;
+}
+
+/**
+ * Loop of a thread: runs a slice of the session with the earliest deadline, and puts the session back into the queue,
+ * until its search is finished.
+ */
+void SearchScheduler::work() {
+  TRACE_THREAD("scheduler");
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    ready.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (stopping) return;
+    Session* session = queue.top();
+    queue.pop();
+    lock.unlock();
+    bool done = session->search->resume();
+    lock.lock();
+    if (!done) {
+      queue.push(session);
+      continue;
+    }
+
+    // The session stays registered until its callback returned, so wait does not return too early
+    if (!session->cancelled && session->onDone) {
+      lock.unlock();
+      session->onDone(session->id, session->search->getResult());
+      lock.lock();
+    }
+    spare.push_back(std::move(session->search));
+    sessions.erase(session->id);
+    if (sessions.empty()) idle.notify_all();
+  }
+}
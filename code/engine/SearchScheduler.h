@@ -0,0 +1,64 @@
+#ifndef SEARCHSCHEDULER_H_
+#define SEARCHSCHEDULER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "./Search.h"
+
+// Runs many short searches, like hints or blunder checks of different games, on a fixed pool of threads. Every
+// session owns a cooperative Search with the positions of its line, which runs in slices of nodes, and the session with
+// the earliest deadline gets the next free thread. All sessions share the transposition table and the network.
+class SearchScheduler {
+ public:
+  SearchScheduler(int pThreads, int hashMegabytes, long long pSliceNodes);
+  SearchScheduler(const SearchScheduler&) = delete;
+  SearchScheduler& operator=(const SearchScheduler&) = delete;
+  ~SearchScheduler();
+
+  int submit(const Position& root, const std::vector<uint64_t>& gameKeys, const SearchLimits& limits, double deadline,
+             std::function<void(int, const SearchResult&)> onDone);
+  bool cancel(int id);
+  void wait();
+  void setNetwork(Nnue* pNetwork);
+  int getPending();
+
+ private:
+  struct Session {
+    int id;
+    // Point of the steady clock in nanoseconds, the latest for sessions without a deadline
+    long long deadline;
+    bool cancelled;
+    std::unique_ptr<Search> search;
+    std::function<void(int, const SearchResult&)> onDone;
+  };
+
+  // Orders the queue by the earliest deadline, and sessions with the same deadline by their submission
+  struct Later {
+    bool operator()(const Session* a, const Session* b) const;
+  };
+
+  void work();
+
+  TranspositionTable table;
+  Nnue* network;
+  long long sliceNodes;
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable idle;
+  std::priority_queue<Session*, std::vector<Session*>, Later> queue;
+  std::unordered_map<int, std::unique_ptr<Session>> sessions;
+  // Searches of finished sessions, which are reused by the next sessions
+  std::vector<std::unique_ptr<Search>> spare;
+  int nextId;
+  bool stopping;
+  std::vector<std::thread> workers;
+};
+
+#endif  // SEARCHSCHEDULER_H_
@@ -0,0 +1,111 @@
+#include "./SearchTask.h"
+
+#include <new>
+#include <utility>
+
+/**
+ * @brief Constructs an empty FrameArena. The first block is allocated with the first frame.
+ */
+FrameArena::FrameArena() : block(0), offset(0) {}
+
+/**
+ * Allocates a frame on top of the stack, in the next block, if the current block is full.
+ *
+ * @param size The size of the frame.
+ * @return The frame, which is released with release.
+ */
+void* FrameArena::allocate(std::size_t size) {
+  std::size_t needed = headerSize + (size + alignment - 1) / alignment * alignment;
+  if (needed > blockSize) {
+    char* memory = static_cast<char*>(::operator new(needed));
+    new (memory) Header{nullptr, 0, 0};
+    return memory + headerSize;
+  }
+  Header header = {this, block, offset};
+  if (offset + needed > blockSize) {
+    block++;
+    offset = 0;
+  }
+  while (blocks.size() <= block) blocks.emplace_back(new char[blockSize]);
+  char* memory = blocks[block].get() + offset;
+  offset += needed;
+  new (memory) Header(header);
+  return memory + headerSize;
+}
+
+/**
+ * Releases a frame, which has to be the last allocated frame of its arena, or a frame on the heap.
+ */
+void FrameArena::release(void* frame) {
+  Header* header = reinterpret_cast<Header*>(static_cast<char*>(frame) - headerSize);
+  if (header->arena == nullptr) {
+    ::operator delete(header);
+    return;
+  }
+  header->arena->block = header->block;
+  header->arena->offset = header->offset;
+}
+
+SearchTask SearchTask::promise_type::get_return_object() {
+  return SearchTask(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+std::suspend_always SearchTask::promise_type::initial_suspend() noexcept { return {}; }
+
+void SearchTask::promise_type::return_value(int value) { score = value; }
+
+void SearchTask::promise_type::unhandled_exception() { exception = std::current_exception(); }
+
+/**
+ * @brief Constructs an empty SearchTask without a coroutine, which counts as done.
+ */
+SearchTask::SearchTask() : handle(nullptr) {}
+
+SearchTask::SearchTask(std::coroutine_handle<promise_type> pHandle) : handle(pHandle) {}
+
+SearchTask::SearchTask(SearchTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+SearchTask& SearchTask::operator=(SearchTask&& other) noexcept {
+  if (this != &other) {
+    if (handle) handle.destroy();
+    handle = std::exchange(other.handle, nullptr);
+  }
+  return *this;
+}
+
+/**
+ * @brief Destroys the coroutine. A suspended search can be destroyed at any time, since the nodes below are owned and
+ * destroyed by their parents.
+ */
+SearchTask::~SearchTask() {
+  if (handle) handle.destroy();
+}
+
+bool SearchTask::await_ready() const noexcept { return false; }
+
+/**
+ * Starts the awaited node. The awaiting node is continued, when the node returns.
+ *
+ * @param caller The awaiting node.
+ * @return The node to run next.
+ */
+std::coroutine_handle<> SearchTask::await_suspend(std::coroutine_handle<> caller) noexcept {
+  handle.promise().parent = caller;
+  return handle;
+}
+
+/**
+ * Returns the score of the finished node, or rethrows an exception of the node.
+ */
+int SearchTask::await_resume() const {
+  if (handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+  return handle.promise().score;
+}
+
+/**
+ * @brief Getters of the SearchTask class.
+ *
+ * */
+std::coroutine_handle<> SearchTask::getHandle() const { return handle; }
+
+bool SearchTask::isDone() const { return !handle || handle.done(); }
@@ -0,0 +1,97 @@
+#ifndef SEARCHTASK_H_
+#define SEARCHTASK_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <vector>
+
+// Stack of the coroutine frames of a search. The nodes of a search start and finish in LIFO order, so a frame is
+// allocated by moving the top of the stack and released by moving it back. The blocks are kept, so a search does not
+// allocate, once the blocks for its deepest line exist. A frame larger than a block is allocated on the heap.
+class FrameArena {
+ public:
+  FrameArena();
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  void* allocate(std::size_t size);
+  static void release(void* frame);
+
+ private:
+  // Saved in front of every frame: the arena, nullptr for a frame on the heap, and the top of the stack before it
+  struct Header {
+    FrameArena* arena;
+    std::size_t block;
+    std::size_t offset;
+  };
+
+  static constexpr std::size_t blockSize = 1 << 16;
+  static constexpr std::size_t alignment = alignof(std::max_align_t);
+  static constexpr std::size_t headerSize = (sizeof(Header) + alignment - 1) / alignment * alignment;
+
+  std::vector<std::unique_ptr<char[]>> blocks;
+  std::size_t block;
+  std::size_t offset;
+};
+
+// A node of a cooperative search, a coroutine, which returns a score. It starts suspended and runs, when its parent
+// awaits it, and the parent continues with the score, when it returns. A node deep in the tree can suspend the whole
+// search, which is then continued from that node, so a single thread can take turns between many searches.
+class SearchTask {
+ public:
+  struct promise_type {
+    int score = 0;
+    std::coroutine_handle<> parent;
+    std::exception_ptr exception;
+
+    SearchTask get_return_object();
+    std::suspend_always initial_suspend() noexcept;
+    auto final_suspend() noexcept;
+    void return_value(int value);
+    void unhandled_exception();
+
+    // The frames of the nodes are taken from the arena of the search, whose member the coroutine is
+    template <typename Owner, typename... Args>
+    static void* operator new(std::size_t size, Owner& owner, const Args&...) {
+      return owner.getFrames()->allocate(size);
+    }
+    static void operator delete(void* frame) { FrameArena::release(frame); }
+  };
+
+  SearchTask();
+  SearchTask(SearchTask&& other) noexcept;
+  SearchTask& operator=(SearchTask&& other) noexcept;
+  SearchTask(const SearchTask&) = delete;
+  SearchTask& operator=(const SearchTask&) = delete;
+  ~SearchTask();
+
+  // Awaiting a node runs it and returns its score
+  bool await_ready() const noexcept;
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept;
+  int await_resume() const;
+
+  std::coroutine_handle<> getHandle() const;
+  bool isDone() const;
+
+ private:
+  explicit SearchTask(std::coroutine_handle<promise_type> pHandle);
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+// A finished node continues its parent, the root of the search returns to the thread, which resumed the search
+inline auto SearchTask::promise_type::final_suspend() noexcept {
+  struct Awaiter {
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> node) noexcept {
+      std::coroutine_handle<> next = node.promise().parent;
+      return next ? next : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+  return Awaiter{};
+}
+
+#endif  // SEARCHTASK_H_
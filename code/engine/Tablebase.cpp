@@ -0,0 +1,425 @@
+#include "./Tablebase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+// Keeps std::min and std::max usable
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The pieces besides the king, from the strongest to the weakest, in the order of the signatures
+static const char* pieceOrder = "QRBNP";
+
+// Header of a table file, followed by one byte per index
+struct TablebaseHeader {
+  char magic[4];
+  uint32_t version;
+  char signature[16];
+  uint64_t size;
+};
+
+static const char tableMagic[4] = {'H', 'T', 'B', '1'};
+
+// The squares of the white king in the index: the triangle a8-d8-d5 without pawns, where the board can be mirrored
+// in both directions and along the diagonal, and the files a to d with pawns, where it can only be mirrored left to
+// right.
+struct KingSquares {
+  int index[2][64];
+  int square[2][32];
+  int count[2];
+
+  KingSquares() {
+    count[0] = count[1] = 0;
+    for (int square = 0; square < 64; square++) {
+      int x = square % 8, y = square / 8;
+      index[0][square] = x <= 3 && y <= 3 && x <= y ? count[0]++ : -1;
+      if (index[0][square] >= 0) this->square[0][index[0][square]] = square;
+      index[1][square] = x <= 3 ? count[1]++ : -1;
+      if (index[1][square] >= 0) this->square[1][index[1][square]] = square;
+    }
+  }
+};
+
+static const KingSquares kingSquares;
+
+/**
+ * Applies a symmetry of the board to a square: bit 0 mirrors the files, bit 1 the ranks and bit 2 the diagonal.
+ */
+static int transform(int symmetry, int square) {
+  int x = square % 8, y = square / 8;
+  if (symmetry & 1) x = 7 - x;
+  if (symmetry & 2) y = 7 - y;
+  if (symmetry & 4) std::swap(x, y);
+  return y * 8 + x;
+}
+
+/**
+ * Returns the position of a piece in the signature order, kings first.
+ */
+static int getOrder(char piece) {
+  const char* found = strchr(pieceOrder, toupper(piece));
+  return found == nullptr ? -1 : found - pieceOrder;
+}
+
+/**
+ * @brief Constructs an empty Tablebase.
+ */
+Tablebase::Tablebase() : largest(0) {}
+
+Tablebase::~Tablebase() {
+  for (const auto& entry : tables) unmap(entry.second);
+}
+
+/**
+ * Maps all table files of a directory.
+ *
+ * @param directory The directory with the .htb files.
+ * @return The number of mapped tables.
+ */
+int Tablebase::load(const std::string& directory) {
+  int loaded = 0;
+  std::error_code error;
+  for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+    if (file.path().extension() == ".htb" && add(file.path().string())) loaded++;
+  }
+  return loaded;
+}
+
+/**
+ * Maps a table file into memory, its pages are only read when they are probed. A table of the same ending, which was
+ * mapped before, is replaced.
+ *
+ * @param path The path of the file.
+ * @return True if the file is a valid table, false otherwise.
+ */
+bool Tablebase::add(const std::string& path) {
+  Table table;
+  void* base = nullptr;
+  size_t fileSize = 0;
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER length;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+    fileSize = length.QuadPart;
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  CloseHandle(file);
+  if (mapping == nullptr) return false;
+  base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (base == nullptr) {
+    CloseHandle(mapping);
+    return false;
+  }
+  table.mapping = mapping;
+#else
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) return false;
+  struct stat status;
+  if (fstat(file, &status) == 0 && status.st_size > 0) {
+    fileSize = status.st_size;
+    base = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, file, 0);
+  }
+  close(file);
+  if (base == nullptr || base == MAP_FAILED) return false;
+  table.mapping = base;
+#endif
+  table.mappedSize = fileSize;
+  table.values = (const uint8_t*)base + sizeof(TablebaseHeader);
+
+  // The header has to name a valid ending, with as many positions as the file holds
+  TablebaseHeader header;
+  bool valid = fileSize >= sizeof(header);
+  if (valid) {
+    memcpy(&header, base, sizeof(header));
+    header.signature[sizeof(header.signature) - 1] = '\0';
+    valid = memcmp(header.magic, tableMagic, sizeof(tableMagic)) == 0 && header.version == 1 &&
+            getLayout(header.signature, &table.layout) && header.size == (uint64_t)table.layout.size &&
+            fileSize == sizeof(header) + header.size;
+  }
+  if (!valid) {
+    unmap(table);
+    return false;
+  }
+  auto found = tables.find(table.layout.signature);
+  if (found != tables.end()) {
+    unmap(found->second);
+    tables.erase(found);
+  }
+  tables.emplace(table.layout.signature, table);
+  largest = std::max(largest, table.layout.count);
+  return true;
+}
+
+/**
+ * Unmaps the file of a table.
+ */
+void Tablebase::unmap(const Table& table) {
+  const void* base = table.values - sizeof(TablebaseHeader);
+#ifdef _WIN32
+  UnmapViewOfFile(base);
+  CloseHandle((HANDLE)table.mapping);
+#else
+  munmap((void*)base, table.mappedSize);
+#endif
+}
+
+/**
+ * Looks a position up. Positions with castling or en passant rights are not in the tables.
+ *
+ * @param result Set to 1 if the player to move wins, 0 for a draw and -1 for a loss.
+ * @param moves Set to the number of moves until the mate, 0 for a draw.
+ * @return True if the position was found, false otherwise.
+ */
+bool Tablebase::probe(const Position& position, int* result, int* moves) {
+  if (largest == 0) return false;
+  for (int i = 0; i < 4; i++) {
+    if (position.castling[i] == 0) return false;
+  }
+  // An en passant capture is possible, if a pawn of the player to move stands next to the pushed pawn
+  if (position.lastMove.isDoublePush()) {
+    int to = position.lastMove.getTo();
+    char pawn = position.turn ? 'P' : 'p';
+    if ((to % 8 > 0 && position.board[to - 1] == pawn) || (to % 8 < 7 && position.board[to + 1] == pawn)) {
+      return false;
+    }
+  }
+  char pieces[maxPieces];
+  int squares[maxPieces];
+  int count;
+  if (!getPieces(position, pieces, squares, &count)) return false;
+  uint8_t value = probeValue(pieces, squares, count, position.turn);
+  if (value == none) return false;
+  *result = value == draw ? 0 : value < loss ? 1 : -1;
+  *moves = value < loss ? value : value - loss;
+  return true;
+}
+
+/**
+ * Finds the move of perfect play: the fastest mate in a won position, a move, which keeps the draw, in a drawn
+ * position, and the longest resistance in a lost position.
+ *
+ * @param result Set to 1 if the player to move wins, 0 for a draw and -1 for a loss.
+ * @param moves Set to the number of moves until the mate, 0 for a draw.
+ * @return The move, or a null move if the position is not in the tables or has no legal move.
+ */
+Move Tablebase::getBestMove(const Position& position, int* result, int* moves) {
+  if (!probe(position, result, moves)) return Move();
+  Piece piece;
+  MoveList legalMoves;
+  piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &legalMoves);
+  Move best;
+  int bestRank = -1000;
+  for (int i = 0; i < legalMoves.size(); i++) {
+    Position next;
+    position.makeMove(&piece, legalMoves[i], &next);
+    char pieces[maxPieces];
+    int squares[maxPieces];
+    int count;
+    if (!getPieces(next, pieces, squares, &count)) continue;
+    uint8_t value = probeValue(pieces, squares, count, next.turn);
+    if (value == none) continue;
+    // The value of the reply is from the view of the opponent
+    int rank = value == draw ? 0 : value >= loss ? 500 - (value - loss) : -500 + value;
+    if (rank > bestRank) {
+      bestRank = rank;
+      best = legalMoves[i];
+    }
+  }
+  return best;
+}
+
+/**
+ * Looks a position up by its pieces, used by the probes and the generator.
+ *
+ * @param pieces The pieces as board characters, in any order.
+ * @param squares The squares of the pieces.
+ * @param count The number of pieces, including both kings.
+ * @param whiteToMove True if white is to move.
+ * @return The value of the position, or none if its table is not loaded.
+ */
+uint8_t Tablebase::probeValue(const char* pieces, const int* squares, int count, bool whiteToMove) {
+  if (count == 2) return draw;
+  if (count > largest) return none;
+  bool swapped;
+  auto found = tables.find(getSignature(pieces, count, &swapped));
+  if (found == tables.end()) return none;
+  const Table& table = found->second;
+
+  // Sorts the squares into the order of the layout, with swapped colors the board is mirrored top to bottom
+  int ordered[maxPieces];
+  bool used[maxPieces] = {};
+  for (int slot = 0; slot < count; slot++) {
+    for (int i = 0; i < count; i++) {
+      char owned = swapped ? (isupper(pieces[i]) ? tolower(pieces[i]) : toupper(pieces[i])) : pieces[i];
+      if (!used[i] && owned == table.layout.pieces[slot]) {
+        used[i] = true;
+        ordered[slot] = swapped ? squares[i] ^ 56 : squares[i];
+        break;
+      }
+    }
+  }
+  return table.values[getIndex(table.layout, ordered, whiteToMove != swapped)];
+}
+
+/**
+ * @brief Getters of the Tablebase class.
+ *
+ * */
+int Tablebase::getMaxPieces() { return largest; }
+
+/**
+ * Parses a signature like "KRPKR" into the layout of its table.
+ *
+ * @return True if the signature is valid, false otherwise.
+ */
+bool Tablebase::getLayout(const std::string& signature, TablebaseLayout* layout) {
+  size_t blackKing = signature.find('K', 1);
+  if (signature.empty() || signature[0] != 'K' || blackKing == std::string::npos) return false;
+  int count = signature.size();
+  if (count < 3 || count > maxPieces) return false;
+  layout->signature = signature;
+  layout->count = count;
+  layout->pawns = false;
+  layout->pieces[0] = 'K';
+  layout->pieces[1] = 'k';
+  int next = 2;
+  for (size_t i = 1; i < signature.size(); i++) {
+    if (i == blackKing) continue;
+    if (getOrder(signature[i]) < 0) return false;
+    layout->pieces[next++] = i < blackKing ? signature[i] : tolower(signature[i]);
+    if (signature[i] == 'P') layout->pawns = true;
+  }
+  layout->size = 2LL * kingSquares.count[layout->pawns];
+  for (int i = 1; i < count; i++) layout->size *= 64;
+  return true;
+}
+
+/**
+ * Returns the signature of a set of pieces. The player with more or stronger pieces is taken as white.
+ *
+ * @param pieces The pieces as board characters, in any order.
+ * @param count The number of pieces, including both kings.
+ * @param swapped Set to true if the colors are swapped in the signature, false otherwise.
+ * @return The signature.
+ */
+std::string Tablebase::getSignature(const char* pieces, int count, bool* swapped) {
+  std::string white = "K", black = "K";
+  for (int i = 0; i < count; i++) {
+    if (getOrder(pieces[i]) < 0) continue;
+    (isupper(pieces[i]) ? white : black) += (char)toupper(pieces[i]);
+  }
+  auto byOrder = [](char a, char b) { return getOrder(a) < getOrder(b); };
+  std::sort(white.begin() + 1, white.end(), byOrder);
+  std::sort(black.begin() + 1, black.end(), byOrder);
+  *swapped = false;
+  if (black.size() != white.size()) {
+    *swapped = black.size() > white.size();
+  } else {
+    for (size_t i = 1; i < white.size(); i++) {
+      if (white[i] != black[i]) {
+        *swapped = getOrder(black[i]) < getOrder(white[i]);
+        break;
+      }
+    }
+  }
+  return *swapped ? black + white : white + black;
+}
+
+/**
+ * Computes the index of a position in its table. Of all the mirrored boards, which put the white king into its part
+ * of the board, the one with the smallest index is used, so every position has exactly one index.
+ *
+ * @param squares The squares of the pieces, in the order of the layout.
+ * @param whiteToMove True if white is to move.
+ * @return The index.
+ */
+long long Tablebase::getIndex(const TablebaseLayout& layout, const int* squares, bool whiteToMove) {
+  const int* kingIndex = kingSquares.index[layout.pawns];
+  int kings = kingSquares.count[layout.pawns];
+  long long best = -1;
+  for (int symmetry = 0; symmetry < (layout.pawns ? 2 : 8); symmetry++) {
+    int king = kingIndex[transform(symmetry, squares[0])];
+    if (king < 0) continue;
+    int mapped[maxPieces];
+    for (int i = 1; i < layout.count; i++) {
+      mapped[i] = transform(symmetry, squares[i]);
+      // Equal pieces are sorted by their squares
+      for (int j = i; j > 2 && layout.pieces[j - 1] == layout.pieces[j] && mapped[j - 1] > mapped[j]; j--) {
+        std::swap(mapped[j - 1], mapped[j]);
+      }
+    }
+    long long index = (whiteToMove ? 0 : kings) + king;
+    for (int i = 1; i < layout.count; i++) index = index * 64 + mapped[i];
+    if (best < 0 || index < best) best = index;
+  }
+  return best;
+}
+
+/**
+ * Computes the squares and the player to move of an index, the reverse of getIndex. An index, which is not the
+ * smallest of its position or has pieces on the same square, gives a position, which is not stored.
+ */
+void Tablebase::getSquares(const TablebaseLayout& layout, long long index, int* squares, bool* whiteToMove) {
+  int kings = kingSquares.count[layout.pawns];
+  for (int i = layout.count - 1; i >= 1; i--) {
+    squares[i] = index % 64;
+    index /= 64;
+  }
+  squares[0] = kingSquares.square[layout.pawns][index % kings];
+  *whiteToMove = index < kings;
+}
+
+/**
+ * Collects the pieces of a position.
+ *
+ * @param pieces Set to the pieces as board characters.
+ * @param squares Set to the squares of the pieces.
+ * @param count Set to the number of pieces.
+ * @return True if the position has at most maxPieces pieces, false otherwise.
+ */
+bool Tablebase::getPieces(const Position& position, char* pieces, int* squares, int* count) {
+  *count = 0;
+  for (int square = 0; square < 64; square++) {
+    if (position.board[square] == ' ') continue;
+    if (*count == maxPieces) return false;
+    pieces[*count] = position.board[square];
+    squares[(*count)++] = square;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the file name of the table of a signature.
+ */
+std::string Tablebase::getFileName(const std::string& signature) { return signature + ".htb"; }
+
+/**
+ * Writes a table file.
+ *
+ * @param path The path of the file.
+ * @param layout The layout of the table.
+ * @param values One value per index.
+ * @return True if the file was written, false otherwise.
+ */
+bool Tablebase::save(const std::string& path, const TablebaseLayout& layout, const std::vector<uint8_t>& values) {
+  TablebaseHeader header = {};
+  memcpy(header.magic, tableMagic, sizeof(tableMagic));
+  header.version = 1;
+  strncpy(header.signature, layout.signature.c_str(), sizeof(header.signature) - 1);
+  header.size = values.size();
+  std::ofstream file(path, std::ios::binary);
+  file.write((const char*)&header, sizeof(header));
+  file.write((const char*)values.data(), values.size());
+  return (bool)file;
+}
@@ -0,0 +1,69 @@
+#ifndef TABLEBASE_H_
+#define TABLEBASE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../rules/board/Position.h"
+
+// Pieces of an ending, with the order of their squares in the index of its table: the white king, the black king, the
+// other white pieces and the other black pieces, each from the queen to the pawns. The signature names them the same
+// way, like "KQKR" for king and queen against king and rook.
+struct TablebaseLayout {
+  std::string signature;
+  char pieces[8];
+  int count;
+  bool pawns;
+  long long size;
+};
+
+// Endgame tablebases: the value of every position of an ending with few pieces under perfect play, read from files,
+// which are memory-mapped. A table holds one byte per position: 0 for a draw, 1 to 127 if the player to move mates in
+// that many moves, 128 + n if the player to move is mated in n moves, and 255 for positions, which are not stored.
+// Tables exist only for the endings, where white has the stronger pieces, the others are looked up with the colors
+// swapped. Since the positions are stored without castling and en passant rights and the tables ignore the fifty move
+// rule, positions with such rights are not probed.
+class Tablebase {
+ public:
+  static constexpr int maxPieces = 5;
+  static constexpr uint8_t draw = 0;
+  static constexpr uint8_t loss = 128;
+  static constexpr uint8_t none = 255;
+
+  Tablebase();
+  ~Tablebase();
+  Tablebase(const Tablebase&) = delete;
+  Tablebase& operator=(const Tablebase&) = delete;
+
+  int load(const std::string& directory);
+  bool add(const std::string& path);
+  bool probe(const Position& position, int* result, int* moves);
+  Move getBestMove(const Position& position, int* result, int* moves);
+  uint8_t probeValue(const char* pieces, const int* squares, int count, bool whiteToMove);
+  int getMaxPieces();
+
+  static bool getLayout(const std::string& signature, TablebaseLayout* layout);
+  static std::string getSignature(const char* pieces, int count, bool* swapped);
+  static long long getIndex(const TablebaseLayout& layout, const int* squares, bool whiteToMove);
+  static void getSquares(const TablebaseLayout& layout, long long index, int* squares, bool* whiteToMove);
+  static bool getPieces(const Position& position, char* pieces, int* squares, int* count);
+  static std::string getFileName(const std::string& signature);
+  static bool save(const std::string& path, const TablebaseLayout& layout, const std::vector<uint8_t>& values);
+
+ private:
+  struct Table {
+    TablebaseLayout layout;
+    const uint8_t* values;
+    void* mapping;
+    size_t mappedSize;
+  };
+
+  static void unmap(const Table& table);
+
+  std::map<std::string, Table> tables;
+  int largest;
+};
+
+#endif  // TABLEBASE_H_
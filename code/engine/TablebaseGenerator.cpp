@@ -0,0 +1,487 @@
+#include "./TablebaseGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <set>
+#include <thread>
+
+// Flags of an index: a stored position, a decided position and its result, a position, whose moves have to be
+// checked for a loss, a position with a capture or promotion into a draw, and the kind of the pending result
+enum : uint8_t { Stored = 1, Resolved = 2, Win = 4, Check = 8, Escape = 16, PendingLoss = 32 };
+static constexpr uint16_t noPending = 0xffff;
+
+static const int kingSteps[8][2] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+static const int knightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+static const int bishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+static const int rookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+/**
+ * Calls a function for every square, a piece other than a pawn reaches from a square. A slider stops at the first
+ * piece, which is only included with captures.
+ */
+template <typename Function>
+static void forEachTarget(const char* board, int square, char piece, bool captures, Function onTarget) {
+  int x = square % 8, y = square / 8;
+  auto walk = [&](const int(*directions)[2], int count, bool slide) {
+    for (int d = 0; d < count; d++) {
+      int tx = x + directions[d][0], ty = y + directions[d][1];
+      while (tx >= 0 && tx < 8 && ty >= 0 && ty < 8) {
+        int target = ty * 8 + tx;
+        if (board[target] != ' ') {
+          if (captures) onTarget(target);
+          break;
+        }
+        onTarget(target);
+        if (!slide) break;
+        tx += directions[d][0];
+        ty += directions[d][1];
+      }
+    }
+  };
+  char type = toupper(piece);
+  if (type == 'K') walk(kingSteps, 8, false);
+  if (type == 'N') walk(knightSteps, 8, false);
+  if (type == 'B' || type == 'Q') walk(bishopDirections, 4, true);
+  if (type == 'R' || type == 'Q') walk(rookDirections, 4, true);
+}
+
+/**
+ * @brief Constructs a TablebaseGenerator.
+ *
+ * @param pTablebase The tablebase with the smaller tables, the generated tables are added to it.
+ * @param pThreads The number of threads.
+ */
+TablebaseGenerator::TablebaseGenerator(Tablebase* pTablebase, int pThreads)
+    : tablebase(pTablebase), threads(std::max(1, pThreads)), maxPending(0), decided(0), missingTable(false) {}
+
+/**
+ * Generates the tables of all endings up to a number of pieces, which are not yet in the directory, from the fewest
+ * pieces and pawns on, since captures and promotions lead into the earlier tables. Existing tables are mapped.
+ *
+ * @param directory The directory of the table files, which is created if needed.
+ * @param pieces The largest number of pieces, including both kings, 3 to Tablebase::maxPieces.
+ * @param onTable Called after every generated table, may be empty.
+ * @return True if all tables exist now, false otherwise.
+ */
+bool TablebaseGenerator::generate(const std::string& directory, int pieces,
+                                  const std::function<void(const TablebaseStats&)>& onTable) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  for (const std::string& signature : getSignatures(pieces)) {
+    std::string path = (std::filesystem::path(directory) / Tablebase::getFileName(signature)).string();
+    if (std::filesystem::exists(path) && tablebase->add(path)) continue;
+    std::vector<uint8_t> values;
+    TablebaseStats stats;
+    if (!generateTable(signature, &values, &stats)) return false;
+    if (!Tablebase::save(path, layout, values) || !tablebase->add(path)) return false;
+    if (onTable) onTable(stats);
+  }
+  return true;
+}
+
+/**
+ * Generates the table of one ending. The tables, which its captures and promotions lead into, have to be loaded.
+ *
+ * @param signature The signature of the ending, like "KRKP".
+ * @param values Set to the values of the table, one per index.
+ * @param stats Set to the statistics of the table.
+ * @return True if the table was generated, false if the signature is invalid or a smaller table is missing.
+ */
+bool TablebaseGenerator::generateTable(const std::string& signature, std::vector<uint8_t>* values,
+                                       TablebaseStats* stats) {
+  auto start = std::chrono::steady_clock::now();
+  if (!Tablebase::getLayout(signature, &layout)) return false;
+  long long size = layout.size;
+  status = std::vector<std::atomic<uint8_t>>(size);
+  pending = std::vector<std::atomic<uint16_t>>(size);
+  plies.assign(size, 0);
+  floor.assign(size, 0);
+  maxPending = 0;
+  missingTable = false;
+
+  // Mates, and the results of the captures and promotions
+  parallel(size, [&](long long begin, long long end) {
+    Setup setup;
+    MoveScan scan;
+    for (long long index = begin; index < end; index++) {
+      pending[index].store(noPending, std::memory_order_relaxed);
+      if (!setUp(index, &setup)) {
+        status[index].store(0, std::memory_order_relaxed);
+        continue;
+      }
+      scanMoves(setup, &scan);
+      if (scan.missing) missingTable = true;
+      floor[index] = scan.exitLoss;
+      if (scan.legalMoves == 0) {
+        // Checkmate is a loss in 0 plies, stalemate stays undecided and so a draw
+        bool mate = isChecked(setup, setup.whiteToMove);
+        status[index].store(mate ? Stored | Resolved : Stored, std::memory_order_relaxed);
+        continue;
+      }
+      status[index].store(scan.exitDraw ? Stored | Escape : Stored, std::memory_order_relaxed);
+      if (scan.exitWin != noPending) {
+        setPending(index, scan.exitWin, true);
+      } else if (scan.childCount == 0 && !scan.exitDraw) {
+        setPending(index, scan.exitLoss, false);
+      }
+    }
+  });
+  if (missingTable) return false;
+
+  // One round per ply: decide the pending and checked positions, then unmake the moves into the decided positions
+  for (int level = 0; level < noPending - 1; level++) {
+    parallel(size, [&](long long begin, long long end) {
+      for (long long index = begin; index < end; index++) {
+        uint8_t flags = status[index].load(std::memory_order_relaxed);
+        if ((flags & Stored) == 0 || (flags & Resolved) != 0) continue;
+        if (pending[index].load(std::memory_order_relaxed) == level) {
+          resolve(index, level, (flags & PendingLoss) == 0);
+        } else if (flags & Check) {
+          status[index].fetch_and(~Check, std::memory_order_relaxed);
+          check(index, level);
+        }
+      }
+    });
+    decided = 0;
+    parallel(size, [&](long long begin, long long end) {
+      Setup setup;
+      long long count = 0;
+      for (long long index = begin; index < end; index++) {
+        uint8_t flags = status[index].load(std::memory_order_relaxed);
+        if ((flags & Resolved) == 0 || plies[index] != level) continue;
+        count++;
+        bool win = (flags & Win) != 0;
+        setUp(index, &setup);
+        unmakeMoves(setup, [&](long long predecessor) {
+          if (status[predecessor].load(std::memory_order_acquire) & Resolved) return;
+          if (win) {
+            status[predecessor].fetch_or(Check, std::memory_order_relaxed);
+          } else {
+            setPending(predecessor, level + 1, true);
+          }
+        });
+      }
+      decided += count;
+    });
+    if (decided == 0 && level >= maxPending) break;
+  }
+
+  // The values of the file and the statistics
+  values->assign(size, Tablebase::none);
+  *stats = {signature, 0, 0, 0, 0, 0, "", 0.0};
+  long long longestIndex = -1;
+  for (long long index = 0; index < size; index++) {
+    uint8_t flags = status[index].load(std::memory_order_relaxed);
+    if ((flags & Stored) == 0) continue;
+    stats->positions++;
+    if ((flags & Resolved) == 0) {
+      (*values)[index] = Tablebase::draw;
+      stats->draws++;
+    } else if (flags & Win) {
+      int moves = std::min(127, (plies[index] + 1) / 2);
+      (*values)[index] = moves;
+      stats->wins++;
+      if (moves > stats->longest) {
+        stats->longest = moves;
+        longestIndex = index;
+      }
+    } else {
+      (*values)[index] = Tablebase::loss + std::min(126, plies[index] / 2);
+      stats->losses++;
+    }
+  }
+  if (longestIndex >= 0) {
+    Setup setup;
+    setUp(longestIndex, &setup);
+    Position position;
+    position.board.assign(setup.board, 64);
+    position.turn = setup.whiteToMove;
+    for (int i = 0; i < 4; i++) position.castling[i] = 1;
+    stats->longestFen = position.getFen();
+  }
+  std::vector<std::atomic<uint8_t>>().swap(status);
+  std::vector<std::atomic<uint16_t>>().swap(pending);
+  std::vector<uint16_t>().swap(plies);
+  std::vector<uint16_t>().swap(floor);
+  stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return true;
+}
+
+/**
+ * Returns the signatures of all endings from 3 up to a number of pieces, in the order of their generation: by the
+ * number of pieces, then by the number of pawns.
+ */
+std::vector<std::string> TablebaseGenerator::getSignatures(int pieces) {
+  pieces = std::max(3, std::min(Tablebase::maxPieces, pieces));
+  // The sorted sequences of the other pieces of one player, by their length
+  std::vector<std::string> parts[Tablebase::maxPieces - 1];
+  std::function<void(const std::string&, int)> collect = [&](const std::string& part, int first) {
+    parts[part.size()].push_back(part);
+    if ((int)part.size() == pieces - 2) return;
+    for (int i = first; i < 5; i++) collect(part + "QRBNP"[i], i);
+  };
+  collect("", 0);
+  std::set<std::string> found;
+  for (int others = 1; others <= pieces - 2; others++) {
+    for (int white = 0; white <= others; white++) {
+      for (const std::string& whitePart : parts[white]) {
+        for (const std::string& blackPart : parts[others - white]) {
+          std::string chars = "Kk" + whitePart;
+          for (char c : blackPart) chars += (char)tolower(c);
+          bool swapped;
+          found.insert(Tablebase::getSignature(chars.c_str(), chars.size(), &swapped));
+        }
+      }
+    }
+  }
+  std::vector<std::string> signatures(found.begin(), found.end());
+  auto pawns = [](const std::string& signature) { return std::count(signature.begin(), signature.end(), 'P'); };
+  std::sort(signatures.begin(), signatures.end(), [&](const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return a.size() < b.size();
+    if (pawns(a) != pawns(b)) return pawns(a) < pawns(b);
+    return a < b;
+  });
+  return signatures;
+}
+
+/**
+ * Runs a function on the threads over the index, in chunks, which the threads take in turn.
+ */
+void TablebaseGenerator::parallel(long long size, const std::function<void(long long begin, long long end)>& work) {
+  const long long chunk = 1 << 14;
+  std::atomic<long long> next(0);
+  auto worker = [&]() {
+    for (long long begin = next.fetch_add(chunk); begin < size; begin = next.fetch_add(chunk)) {
+      work(begin, std::min(size, begin + chunk));
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; i++) pool.emplace_back(worker);
+  worker();
+  for (std::thread& thread : pool) thread.join();
+}
+
+/**
+ * Sets up the position of an index.
+ *
+ * @return True if the position is stored: its index is the smallest of its mirrored boards, no two pieces share a
+ * square, no pawn stands on the first or last rank and the player, who is not to move, is not in check.
+ */
+bool TablebaseGenerator::setUp(long long index, Setup* setup) {
+  Tablebase::getSquares(layout, index, setup->squares, &setup->whiteToMove);
+  memset(setup->board, ' ', sizeof(setup->board));
+  for (int i = 0; i < layout.count; i++) {
+    int square = setup->squares[i];
+    if (setup->board[square] != ' ') return false;
+    if (toupper(layout.pieces[i]) == 'P' && (square < 8 || square >= 56)) return false;
+    setup->board[square] = layout.pieces[i];
+  }
+  if (isChecked(*setup, !setup->whiteToMove)) return false;
+  return Tablebase::getIndex(layout, setup->squares, setup->whiteToMove) == index;
+}
+
+/**
+ * Generates the legal moves of a position. The en passant captures are left out, like in the probes.
+ */
+void TablebaseGenerator::scanMoves(const Setup& setup, MoveScan* scan) {
+  scan->childCount = 0;
+  scan->legalMoves = 0;
+  scan->exitWin = noPending;
+  scan->exitLoss = 0;
+  scan->exitDraw = false;
+  scan->missing = false;
+  bool white = setup.whiteToMove;
+  for (int i = 0; i < layout.count; i++) {
+    char piece = layout.pieces[i];
+    if ((isupper(piece) != 0) != white) continue;
+    int from = setup.squares[i];
+    if (toupper(piece) != 'P') {
+      forEachTarget(setup.board, from, piece, true, [&](int to) {
+        if (setup.board[to] == ' ' || (isupper(setup.board[to]) != 0) != white) addMove(setup, i, to, ' ', scan);
+      });
+      continue;
+    }
+    // Pawns push onto empty squares, capture diagonally and promote to every piece on the last rank
+    int direction = white ? -8 : 8;
+    auto addPawnMove = [&](int to) {
+      if (to >= 8 && to < 56) {
+        addMove(setup, i, to, ' ', scan);
+        return;
+      }
+      for (char promotion : std::string("QRBN")) addMove(setup, i, to, promotion, scan);
+    };
+    int one = from + direction;
+    if (setup.board[one] == ' ') {
+      addPawnMove(one);
+      int startRank = white ? 6 : 1;
+      if (from / 8 == startRank && setup.board[one + direction] == ' ') addPawnMove(one + direction);
+    }
+    for (int side = -1; side <= 1; side += 2) {
+      int x = from % 8 + side;
+      if (x < 0 || x > 7) continue;
+      char target = setup.board[one + side];
+      if (target != ' ' && (isupper(target) != 0) != white && toupper(target) != 'K') addPawnMove(one + side);
+    }
+  }
+}
+
+/**
+ * Makes a move, and adds it to the scan if it is legal: the index of a quiet move, or the result of a capture or
+ * promotion from the smaller table.
+ */
+void TablebaseGenerator::addMove(const Setup& setup, int piece, int to, char promotion, MoveScan* scan) {
+  bool white = setup.whiteToMove;
+  Setup next = setup;
+  int captured = -1;
+  for (int i = 0; i < layout.count; i++) {
+    if (i != piece && setup.squares[i] == to) captured = i;
+  }
+  next.board[setup.squares[piece]] = ' ';
+  next.board[to] = promotion == ' ' ? layout.pieces[piece] : white ? promotion : tolower(promotion);
+  next.squares[piece] = to;
+  if (captured >= 0) next.squares[captured] = -1;
+  if (isChecked(next, white)) return;
+  scan->legalMoves++;
+  if (captured < 0 && promotion == ' ') {
+    scan->children[scan->childCount++] = Tablebase::getIndex(layout, next.squares, !white);
+    return;
+  }
+
+  char pieces[Tablebase::maxPieces];
+  int squares[Tablebase::maxPieces];
+  int count = 0;
+  for (int i = 0; i < layout.count; i++) {
+    if (i == captured) continue;
+    pieces[count] = next.board[next.squares[i]];
+    squares[count++] = next.squares[i];
+  }
+  uint8_t value = tablebase->probeValue(pieces, squares, count, !white);
+  if (value == Tablebase::none) {
+    scan->missing = true;
+  } else if (value == Tablebase::draw) {
+    scan->exitDraw = true;
+  } else if (value >= Tablebase::loss) {
+    // The opponent is mated in n moves, which is a mate in 2n + 1 plies
+    scan->exitWin = std::min(scan->exitWin, 2 * (value - Tablebase::loss) + 1);
+  } else {
+    // The opponent mates in n moves, its mate takes 2n - 1 plies after the move
+    scan->exitLoss = std::max(scan->exitLoss, 2 * value);
+  }
+}
+
+/**
+ * Unmakes every quiet move of the player, who is not to move, into a predecessor in the same table. Captures and
+ * promotions lead out of the table and are not unmade.
+ */
+void TablebaseGenerator::unmakeMoves(const Setup& setup, const std::function<void(long long index)>& onPredecessor) {
+  bool white = !setup.whiteToMove;
+  for (int i = 0; i < layout.count; i++) {
+    char piece = layout.pieces[i];
+    if ((isupper(piece) != 0) != white) continue;
+    int to = setup.squares[i];
+    if (toupper(piece) != 'P') {
+      forEachTarget(setup.board, to, piece, false, [&](int from) { addPredecessor(setup, i, from, onPredecessor); });
+      continue;
+    }
+    // A pawn came from one square behind, or from its start rank with a double push
+    int direction = white ? -8 : 8;
+    int one = to - direction;
+    if (one < 8 || one >= 56 || setup.board[one] != ' ') continue;
+    addPredecessor(setup, i, one, onPredecessor);
+    int two = one - direction;
+    if (two / 8 == (white ? 6 : 1) && setup.board[two] == ' ') addPredecessor(setup, i, two, onPredecessor);
+  }
+}
+
+/**
+ * Moves a piece back to a square and reports the index of the predecessor, if it is a legal position.
+ */
+void TablebaseGenerator::addPredecessor(const Setup& setup, int piece, int from,
+                                        const std::function<void(long long index)>& onPredecessor) {
+  Setup previous = setup;
+  previous.board[setup.squares[piece]] = ' ';
+  previous.board[from] = layout.pieces[piece];
+  previous.squares[piece] = from;
+  previous.whiteToMove = !setup.whiteToMove;
+  if (isChecked(previous, setup.whiteToMove)) return;
+  onPredecessor(Tablebase::getIndex(layout, previous.squares, previous.whiteToMove));
+}
+
+/**
+ * Checks if the king of a player is attacked. Captured pieces have the square -1.
+ */
+bool TablebaseGenerator::isChecked(const Setup& setup, bool white) {
+  int king = setup.squares[white ? 0 : 1];
+  int kx = king % 8, ky = king / 8;
+  for (int i = 0; i < layout.count; i++) {
+    int square = setup.squares[i];
+    if (square < 0) continue;
+    char piece = setup.board[square];
+    if ((isupper(piece) != 0) == white) continue;
+    int dx = kx - square % 8, dy = ky - square / 8;
+    char type = toupper(piece);
+    if (type == 'K' || type == 'N' || type == 'P') {
+      if (type == 'K' && abs(dx) <= 1 && abs(dy) <= 1) return true;
+      if (type == 'N' && abs(dx * dy) == 2) return true;
+      // Black pawns attack towards the higher rows of the board, white pawns towards the lower
+      if (type == 'P' && abs(dx) == 1 && dy == (white ? 1 : -1)) return true;
+      continue;
+    }
+    bool straight = dx == 0 || dy == 0, diagonal = abs(dx) == abs(dy);
+    if (!(straight && type != 'B') && !(diagonal && type != 'R')) continue;
+    int sx = (dx > 0) - (dx < 0), sy = (dy > 0) - (dy < 0);
+    bool blocked = false;
+    for (int x = square % 8 + sx, y = square / 8 + sy; x != kx || y != ky; x += sx, y += sy) {
+      if (setup.board[y * 8 + x] != ' ') {
+        blocked = true;
+        break;
+      }
+    }
+    if (!blocked) return true;
+  }
+  return false;
+}
+
+/**
+ * Decides a position.
+ */
+void TablebaseGenerator::resolve(long long index, int distance, bool win) {
+  plies[index] = distance;
+  status[index].fetch_or(win ? Resolved | Win : Resolved, std::memory_order_release);
+}
+
+/**
+ * Sets the result of a position for a later round. A pending win only gets shorter, a loss is set once.
+ */
+void TablebaseGenerator::setPending(long long index, int distance, bool win) {
+  uint16_t current = pending[index].load(std::memory_order_relaxed);
+  while (distance < current && !pending[index].compare_exchange_weak(current, distance)) continue;
+  if (!win) status[index].fetch_or(PendingLoss, std::memory_order_relaxed);
+  for (int highest = maxPending; distance > highest && !maxPending.compare_exchange_weak(highest, distance);) continue;
+}
+
+/**
+ * Checks a position, after one of its moves led to a won position: it is lost, if all of its moves do, and its loss
+ * takes one ply longer than the longest of these wins.
+ */
+void TablebaseGenerator::check(long long index, int level) {
+  uint8_t flags = status[index].load(std::memory_order_relaxed);
+  if ((flags & (Escape | PendingLoss)) != 0 || pending[index].load(std::memory_order_relaxed) != noPending) return;
+  Setup setup;
+  MoveScan scan;
+  setUp(index, &setup);
+  scanMoves(setup, &scan);
+  int distance = scan.exitLoss;
+  for (int i = 0; i < scan.childCount; i++) {
+    uint8_t child = status[scan.children[i]].load(std::memory_order_acquire);
+    if ((child & Resolved) == 0 || (child & Win) == 0) return;
+    distance = std::max(distance, plies[scan.children[i]] + 1);
+  }
+  if (distance <= level) {
+    resolve(index, level, false);
+  } else {
+    setPending(index, distance, false);
+  }
+}
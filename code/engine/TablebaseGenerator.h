@@ -0,0 +1,85 @@
+#ifndef TABLEBASEGENERATOR_H_
+#define TABLEBASEGENERATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "./Tablebase.h"
+
+// Statistics of a generated table, from the view of the player to move
+struct TablebaseStats {
+  std::string signature;
+  long long positions;
+  long long wins;
+  long long draws;
+  long long losses;
+  // The longest mate in moves, its position and the seconds of the generation
+  int longest;
+  std::string longestFen;
+  double seconds;
+};
+
+// Generates the tables with retrograde analysis. A position is won if a move leads to a lost position, and lost if
+// all moves lead to won positions. First every position is checked for mates and for the captures and promotions,
+// which lead into the smaller tables, then the distances grow one ply per round: the positions, which were decided in
+// the last round, are unmade move by move into their predecessors. A predecessor of a lost position is won one ply
+// later; a predecessor of a won position is lost, once all of its moves lead to won positions, which is checked with
+// its moves. Positions, which are never decided, are draws. The rounds run on several threads, which split the index.
+class TablebaseGenerator {
+ public:
+  TablebaseGenerator(Tablebase* pTablebase, int pThreads);
+
+  bool generate(const std::string& directory, int pieces, const std::function<void(const TablebaseStats&)>& onTable);
+  bool generateTable(const std::string& signature, std::vector<uint8_t>* values, TablebaseStats* stats);
+  static std::vector<std::string> getSignatures(int pieces);
+
+ private:
+  // A position of the table, which is generated: its pieces in the order of the layout and the board
+  struct Setup {
+    int squares[Tablebase::maxPieces];
+    bool whiteToMove;
+    char board[64];
+  };
+
+  // The moves of a position: the indices of the positions in the same table and the best result of the captures and
+  // promotions, in plies from the view of the player to move
+  struct MoveScan {
+    long long children[192];
+    int childCount;
+    int legalMoves;
+    int exitWin;
+    int exitLoss;
+    bool exitDraw;
+    bool missing;
+  };
+
+  void parallel(long long size, const std::function<void(long long begin, long long end)>& work);
+  bool setUp(long long index, Setup* setup);
+  void scanMoves(const Setup& setup, MoveScan* scan);
+  void addMove(const Setup& setup, int piece, int to, char promotion, MoveScan* scan);
+  void unmakeMoves(const Setup& setup, const std::function<void(long long index)>& onPredecessor);
+  void addPredecessor(const Setup& setup, int piece, int from,
+                      const std::function<void(long long index)>& onPredecessor);
+  bool isChecked(const Setup& setup, bool white);
+  void resolve(long long index, int distance, bool win);
+  void setPending(long long index, int distance, bool win);
+  void check(long long index, int level);
+
+  Tablebase* tablebase;
+  int threads;
+  TablebaseLayout layout;
+  // The state of the generation per index, see the flags in the source
+  std::vector<std::atomic<uint8_t>> status;
+  std::vector<std::atomic<uint16_t>> pending;
+  std::vector<uint16_t> plies;
+  // The longest loss through captures and promotions, a loss can not be shorter
+  std::vector<uint16_t> floor;
+  std::atomic<int> maxPending;
+  std::atomic<long long> decided;
+  std::atomic<bool> missingTable;
+};
+
+#endif  // TABLEBASEGENERATOR_H_
@@ -0,0 +1,86 @@
+#include "./TimeManager.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * @brief Constructs a TimeManager without time limits.
+ */
+TimeManager::TimeManager()
+    : optimum(0.0), maximum(0.0), lastBest(), lastScore(0), stableIterations(0), instability(0.0) {}
+
+/**
+ * Allocates the time for the next move.
+ *
+ * Without moves to go (sudden death), the remaining time is spread over the next 50 moves. The optimum time is at
+ * most half of the remaining time and the maximum time five times the optimum, but never more than 80% of the
+ * remaining time minus the overhead, so even the last moves before a time control can not lose on time. With almost
+ * no time left, the overhead shrinks with the clock, so the moves get faster instead of running out of time.
+ *
+ * @param remaining The remaining time on the clock in seconds.
+ * @param increment The time added after every move in seconds.
+ * @param movesToGo The moves until the next time control, 0 for sudden death.
+ */
+void TimeManager::start(double remaining, double increment, int movesToGo) {
+  double available = remaining > 2 * overhead ? remaining - overhead : std::max(0.0, remaining) / 2;
+  int moves = movesToGo > 0 ? std::min(movesToGo, 50) : 50;
+  if (moves == 1) {
+    optimum = available * 0.6;
+    maximum = available * 0.8;
+  } else {
+    optimum = std::min(available / moves + increment * 0.75, available * 0.5);
+    maximum = std::min(optimum * 5, available * 0.8);
+  }
+  // A time of 0 means no limit for the search
+  optimum = std::max(optimum, 0.00005);
+  maximum = std::max(maximum, 0.0001);
+  lastBest = Move();
+  lastScore = 0;
+  stableIterations = 0;
+  instability = 0.0;
+}
+
+/**
+ * Decides after an iteration, if the next one is started.
+ *
+ * The optimum time is scaled by the stability of the search: every change of the best move adds to the instability,
+ * which halves with every iteration, a score drop of more than 30 centipawns (a fail low against the last
+ * iteration) extends the time by half, and a best move, which stayed the same for four iterations with a stable
+ * score, is clearly best and halves the time. Since the next iteration takes about as long as all earlier ones
+ * together, no iteration is started after 60% of the scaled time.
+ *
+ * @param depth The finished depth.
+ * @param best The best move of the iteration.
+ * @param score The score of the iteration.
+ * @param elapsed The seconds since the start of the search.
+ * @param rootMoves The number of legal moves, a single move is played at once.
+ * @return True if the search should stop, false if it should start the next iteration.
+ */
+bool TimeManager::isDone(int depth, Move best, int score, double elapsed, int rootMoves) {
+  if (rootMoves == 1) return true;
+  double scale = 1.0;
+  if (depth > 1) {
+    if (best != lastBest) {
+      instability += 1.0;
+      stableIterations = 0;
+    } else {
+      stableIterations++;
+    }
+    scale += instability;
+    if (score < lastScore - 30) scale *= 1.5;
+    if (stableIterations >= 4 && depth >= 6 && std::abs(score - lastScore) < 20) scale *= 0.5;
+    instability *= 0.5;
+  }
+  lastBest = best;
+  lastScore = score;
+  scale = std::clamp(scale, 0.3, 3.0);
+  return elapsed >= std::min(optimum * scale, maximum) * 0.6;
+}
+
+/**
+ * @brief Getters of the TimeManager class.
+ *
+ * */
+double TimeManager::getOptimum() { return optimum; }
+
+double TimeManager::getMaximum() { return maximum; }
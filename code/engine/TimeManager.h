@@ -0,0 +1,31 @@
+#ifndef TIMEMANAGER_H_
+#define TIMEMANAGER_H_
+
+#include "../rules/moves/Move.h"
+
+// Decides how long a search may think about a move, from the remaining time on the clock, the increment and the
+// number of moves until the next time control. It allocates an optimum time, which is extended when the best move
+// changes or the score drops between iterations and shortened when the best move stays the same, and a maximum time,
+// which the search never exceeds, so the clock never runs out.
+class TimeManager {
+ public:
+  // Time kept back for every move, for the work around the search and the delay until the move is played
+  static constexpr double overhead = 0.03;
+
+  TimeManager();
+
+  void start(double remaining, double increment, int movesToGo);
+  bool isDone(int depth, Move best, int score, double elapsed, int rootMoves);
+  double getOptimum();
+  double getMaximum();
+
+ private:
+  double optimum;
+  double maximum;
+  Move lastBest;
+  int lastScore;
+  int stableIterations;
+  double instability;
+};
+
+#endif  // TIMEMANAGER_H_
@@ -0,0 +1,110 @@
+#include "./TranspositionTable.h"
+
+// Layout of the data of a slot
+static uint64_t pack(Move move, int score, int depth, int bound, int generation) {
+  return move.getData() | (uint64_t)(uint16_t)(int16_t)score << 16 | (uint64_t)(depth & 255) << 32 |
+         (uint64_t)bound << 40 | (uint64_t)(generation & 255) << 48;
+}
+
+static Move unpackMove(uint64_t data) {
+  Move move;
+  uint16_t bits = data & 0xFFFF;
+  return bits == 0 ? move : Move(bits & 63, (bits >> 6) & 63, bits >> 12);
+}
+
+/**
+ * @brief Constructs an empty table.
+ *
+ * @param megabytes The size of the table. The number of slots is rounded down to a power of two.
+ */
+TranspositionTable::TranspositionTable(int megabytes) : mask(0), generation(0) { resize(megabytes); }
+
+TranspositionTable::~TranspositionTable() {}
+
+/**
+ * Changes the size of the table, which also removes all entries.
+ *
+ * @param megabytes The new size of the table.
+ */
+void TranspositionTable::resize(int megabytes) {
+  uint64_t count = 1;
+  while (count * 2 * sizeof(Slot) <= (uint64_t)megabytes * 1024 * 1024) count *= 2;
+  slots.reset(new Slot[count]);
+  mask = count - 1;
+  clear();
+}
+
+/**
+ * Removes all entries. Must not be called while a search uses the table.
+ */
+void TranspositionTable::clear() {
+  for (uint64_t i = 0; i <= mask; i++) {
+    slots[i].check.store(0, std::memory_order_relaxed);
+    slots[i].data.store(0, std::memory_order_relaxed);
+  }
+  generation.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Starts a new search. Entries of earlier searches stay usable, but are replaced first.
+ */
+void TranspositionTable::newSearch() {
+  generation.store((generation.load(std::memory_order_relaxed) + 1) & 255, std::memory_order_relaxed);
+}
+
+/**
+ * Looks up a position.
+ *
+ * @param key The key of the position.
+ * @param entry Receives the stored move, score, depth and bound.
+ * @return True if the table holds an entry of the position.
+ */
+bool TranspositionTable::probe(uint64_t key, TableEntry* entry) {
+  Slot& slot = slots[key & mask];
+  uint64_t data = slot.data.load(std::memory_order_relaxed);
+  if ((slot.check.load(std::memory_order_relaxed) ^ data) != key || data == 0) return false;
+  entry->move = unpackMove(data);
+  entry->score = (int16_t)(data >> 16);
+  entry->depth = (data >> 32) & 255;
+  entry->bound = (data >> 40) & 3;
+  return true;
+}
+
+/**
+ * Stores the result of a search of a position. An entry of another position is only replaced, if it is from an
+ * earlier search or not much deeper, an entry of the same position if the new result is exact or at least as deep.
+ *
+ * @param key The key of the position.
+ * @param move The best move, or a null move to keep the stored move of the same position.
+ * @param score The score, mate scores relative to the position.
+ * @param depth The searched depth.
+ * @param bound Whether the score is exact, a lower or an upper bound.
+ */
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, int bound) {
+  Slot& slot = slots[key & mask];
+  uint64_t old = slot.data.load(std::memory_order_relaxed);
+  bool same = (slot.check.load(std::memory_order_relaxed) ^ old) == key;
+  int oldDepth = (old >> 32) & 255;
+  int oldGeneration = (old >> 48) & 255;
+  int current = generation.load(std::memory_order_relaxed);
+  if (same && bound != Exact && depth < oldDepth) return;
+  if (!same && old != 0 && oldGeneration == current && depth + 2 < oldDepth) return;
+  if (same && move.isNull()) move = unpackMove(old);
+
+  uint64_t data = pack(move, score, depth < 0 ? 0 : depth, bound, current);
+  slot.data.store(data, std::memory_order_relaxed);
+  slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+/**
+ * Returns the share of the first thousand slots, which are used by the current search, in permille.
+ */
+int TranspositionTable::getHashfull() {
+  int current = generation.load(std::memory_order_relaxed);
+  int used = 0;
+  for (int i = 0; i < 1000 && i <= mask; i++) {
+    uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+    if (data != 0 && ((data >> 48) & 255) == current) used++;
+  }
+  return used;
+}
@@ -0,0 +1,46 @@
+#ifndef TRANSPOSITIONTABLE_H_
+#define TRANSPOSITIONTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "../rules/moves/Move.h"
+
+struct TableEntry {
+  Move move;
+  int score;
+  int depth;
+  int bound;
+};
+
+// Hash table of searched positions, indexed by the Zobrist key of the position. It can be shared by several search
+// threads without locks: every slot stores its data and the key XOR the data, so a slot, which two threads wrote at
+// the same time, does not match any key and is ignored.
+class TranspositionTable {
+ public:
+  enum Bound { None = 0, Upper = 1, Lower = 2, Exact = 3 };
+
+  explicit TranspositionTable(int megabytes);
+  ~TranspositionTable();
+
+  void resize(int megabytes);
+  void clear();
+  void newSearch();
+  bool probe(uint64_t key, TableEntry* entry);
+  void store(uint64_t key, Move move, int score, int depth, int bound);
+  int getHashfull();
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+  };
+
+  std::unique_ptr<Slot[]> slots;
+  uint64_t mask;
+  // Several searches may start at the same time on a shared table
+  std::atomic<int> generation;
+};
+
+#endif  // TRANSPOSITIONTABLE_H_
@@ -0,0 +1,49 @@
+#include "./Evaluation.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "../rules/pieces/Piece.h"
+#include "./PawnHash.h"
+
+// Bonus of a knight (0) or bishop (1) by the ring of the board it stands on, from the center to the edge
+static const int centerBonus[2][4] = {{18, 12, 4, -10}, {10, 6, 2, -4}};
+
+/**
+ * Evaluates a board without a network.
+ *
+ * @param board The chessboard represented as a string.
+ * @param turn The player to move. `true` for white, `false` for black.
+ * @param pawnKey The pawn key of the board, see PawnTable::computeKey.
+ * @return The evaluation in centipawns from the view of the player to move, positive if the player is better.
+ */
+int Evaluation::evaluate(const std::string& board, bool turn, uint64_t pawnKey) {
+  int value = 0;
+  int whiteKing = -1, blackKing = -1;
+  for (int square = 0; square < 64; square++) {
+    char piece = board[square];
+    if (piece == ' ') continue;
+    int sign = isupper(piece) != 0 ? 1 : -1;
+    char type = tolower(piece);
+    if (type == 'k') {
+      if (sign > 0)
+        whiteKing = square;
+      else
+        blackKing = square;
+      continue;
+    }
+    value += sign * Piece::getExchangeValue(piece);
+    if (type == 'n' || type == 'b') {
+      int x = square % 8, y = square / 8;
+      int ring = std::max(x < 4 ? 3 - x : x - 4, y < 4 ? 3 - y : y - 4);
+      value += sign * centerBonus[type == 'b'][ring];
+    }
+  }
+
+  // Pawn structure terms are cached by the pawn key, so they are only analyzed after a pawn structure changed
+  const PawnEntry& pawns = PawnTable::local().probe(board, pawnKey);
+  value += pawns.score;
+  if (whiteKing >= 0 && whiteKing / 8 == 7) value += pawns.shield[0][whiteKing % 8];
+  if (blackKing >= 0 && blackKing / 8 == 0) value -= pawns.shield[1][blackKing % 8];
+  return turn ? value : -value;
+}
@@ -0,0 +1,14 @@
+#ifndef EVALUATION_H_
+#define EVALUATION_H_
+
+#include <cstdint>
+#include <string>
+
+// Hand written evaluation, used when no network is loaded: material, the placement of the minor pieces and the pawn
+// structure, which is cached in the pawn table of the calling thread.
+class Evaluation {
+ public:
+  static int evaluate(const std::string& board, bool turn, uint64_t pawnKey);
+};
+
+#endif  // EVALUATION_H_
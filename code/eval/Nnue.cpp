@@ -0,0 +1,295 @@
+#include "./Nnue.h"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+// Changes of one accumulator perspective: rows of the feature weights, which are added or subtracted
+struct NnueChanges {
+  const int16_t* added[4];
+  const int16_t* removed[4];
+  int addCount;
+  int removeCount;
+};
+
+/**
+ * Copies an accumulator perspective and applies the changes of a move, without any vector instructions.
+ */
+static void applyScalar(int16_t* out, const int16_t* in, const NnueChanges& changes) {
+  for (int i = 0; i < Nnue::hidden; i++) {
+    int value = in[i];
+    for (int j = 0; j < changes.addCount; j++) value += changes.added[j][i];
+    for (int j = 0; j < changes.removeCount; j++) value -= changes.removed[j][i];
+    out[i] = value;
+  }
+}
+
+/**
+ * Computes the dot product of the clipped accumulators of both perspectives with the output weights, without any
+ * vector instructions.
+ */
+static int outputScalar(const int16_t* us, const int16_t* them, const int8_t* weights) {
+  int sum = 0;
+  for (int i = 0; i < Nnue::hidden; i++) {
+    int a = us[i] < 0 ? 0 : us[i] > Nnue::activationMax ? Nnue::activationMax : us[i];
+    int b = them[i] < 0 ? 0 : them[i] > Nnue::activationMax ? Nnue::activationMax : them[i];
+    sum += a * weights[i] + b * weights[Nnue::hidden + i];
+  }
+  return sum;
+}
+
+#ifdef NNUE_X86
+__attribute__((target("sse4.1"))) static void applySse41(int16_t* out, const int16_t* in, const NnueChanges& changes) {
+  for (int i = 0; i < Nnue::hidden; i += 8) {
+    __m128i value = _mm_load_si128((const __m128i*)(in + i));
+    for (int j = 0; j < changes.addCount; j++)
+      value = _mm_add_epi16(value, _mm_load_si128((const __m128i*)(changes.added[j] + i)));
+    for (int j = 0; j < changes.removeCount; j++)
+      value = _mm_sub_epi16(value, _mm_load_si128((const __m128i*)(changes.removed[j] + i)));
+    _mm_store_si128((__m128i*)(out + i), value);
+  }
+}
+
+/**
+ * Clips 16 activations to 0..activationMax, packs them into unsigned bytes and multiplies them with 16 int8 weights.
+ * The products fit into int16 pairs, which are then added up into int32 lanes.
+ */
+__attribute__((target("sse4.1"))) static __m128i dotSse41(const int16_t* activations, const int8_t* weights) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max = _mm_set1_epi16(Nnue::activationMax);
+  __m128i low = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)activations), zero), max);
+  __m128i high = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)(activations + 8)), zero), max);
+  __m128i products = _mm_maddubs_epi16(_mm_packus_epi16(low, high), _mm_load_si128((const __m128i*)weights));
+  return _mm_madd_epi16(products, _mm_set1_epi16(1));
+}
+
+__attribute__((target("sse4.1"))) static int outputSse41(const int16_t* us, const int16_t* them,
+                                                         const int8_t* weights) {
+  __m128i sum = _mm_setzero_si128();
+  for (int i = 0; i < Nnue::hidden; i += 16) {
+    sum = _mm_add_epi32(sum, dotSse41(us + i, weights + i));
+    sum = _mm_add_epi32(sum, dotSse41(them + i, weights + Nnue::hidden + i));
+  }
+  sum = _mm_hadd_epi32(sum, sum);
+  sum = _mm_hadd_epi32(sum, sum);
+  return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2"))) static void applyAvx2(int16_t* out, const int16_t* in, const NnueChanges& changes) {
+  for (int i = 0; i < Nnue::hidden; i += 16) {
+    __m256i value = _mm256_load_si256((const __m256i*)(in + i));
+    for (int j = 0; j < changes.addCount; j++)
+      value = _mm256_add_epi16(value, _mm256_load_si256((const __m256i*)(changes.added[j] + i)));
+    for (int j = 0; j < changes.removeCount; j++)
+      value = _mm256_sub_epi16(value, _mm256_load_si256((const __m256i*)(changes.removed[j] + i)));
+    _mm256_store_si256((__m256i*)(out + i), value);
+  }
+}
+
+/**
+ * Like dotSse41, for 32 activations. Packing works within 128 bit lanes, so the packed bytes are put back into order
+ * before they are multiplied with the weights.
+ */
+__attribute__((target("avx2"))) static __m256i dotAvx2(const int16_t* activations, const int8_t* weights) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max = _mm256_set1_epi16(Nnue::activationMax);
+  __m256i low = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)activations), zero), max);
+  __m256i high = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)(activations + 16)), zero), max);
+  __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+  __m256i products = _mm256_maddubs_epi16(packed, _mm256_load_si256((const __m256i*)weights));
+  return _mm256_madd_epi16(products, _mm256_set1_epi16(1));
+}
+
+__attribute__((target("avx2"))) static int outputAvx2(const int16_t* us, const int16_t* them, const int8_t* weights) {
+  __m256i sum = _mm256_setzero_si256();
+  for (int i = 0; i < Nnue::hidden; i += 32) {
+    sum = _mm256_add_epi32(sum, dotAvx2(us + i, weights + i));
+    sum = _mm256_add_epi32(sum, dotAvx2(them + i, weights + Nnue::hidden + i));
+  }
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  half = _mm_hadd_epi32(half, half);
+  half = _mm_hadd_epi32(half, half);
+  return _mm_cvtsi128_si32(half);
+}
+#endif
+
+// Kernels for the instruction sets of the processor, selected once at startup
+struct NnueKernels {
+  void (*apply)(int16_t* out, const int16_t* in, const NnueChanges& changes);
+  int (*output)(const int16_t* us, const int16_t* them, const int8_t* weights);
+  const char* name;
+};
+
+static NnueKernels selectKernels() {
+#ifdef NNUE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return {applyAvx2, outputAvx2, "avx2"};
+  if (__builtin_cpu_supports("sse4.1")) return {applySse41, outputSse41, "sse4.1"};
+#endif
+  return {applyScalar, outputScalar, "scalar"};
+}
+
+static const NnueKernels kernels = selectKernels();
+
+/**
+ * @brief Constructs a Nnue object without weights. The network is large, so it should be allocated on the heap.
+ */
+Nnue::Nnue() : loaded(false), outputBias(0), outputScale(0) {}
+
+Nnue::~Nnue() {}
+
+/**
+ * Loads the network weights from a binary file. The file starts with the magic "HCNN", the version 1 and the number
+ * of inputs and hidden neurons as uint32, followed by the feature weights (int16, [inputs][hidden]), the feature
+ * biases (int16, [hidden]), the output weights (int8, [2 * hidden], own perspective first), the output bias and the
+ * output scale (int32). All values are little endian.
+ *
+ * @param path The path of the network file.
+ * @return True if the weights were loaded, false if the file is missing or does not match the network.
+ */
+bool Nnue::load(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  char magic[4];
+  uint32_t header[3];
+  file.read(magic, 4);
+  file.read((char*)header, sizeof(header));
+  if (!file || memcmp(magic, "HCNN", 4) != 0 || header[0] != 1 || header[1] != inputs || header[2] != hidden)
+    return false;
+
+  int32_t output[2];
+  file.read((char*)featureWeights, sizeof(featureWeights));
+  file.read((char*)featureBiases, sizeof(featureBiases));
+  file.read((char*)outputWeights, sizeof(outputWeights));
+  file.read((char*)output, sizeof(output));
+  // The file has to end after the weights
+  if (!file || file.peek() != std::ifstream::traits_type::eof()) {
+    loaded = false;
+    return false;
+  }
+  outputBias = output[0];
+  outputScale = output[1];
+  loaded = true;
+  return true;
+}
+
+/**
+ * Calculates both accumulator perspectives from all pieces of a board. Needed after a new position is set up, every
+ * move afterwards is applied with update.
+ *
+ * @param board The chessboard represented as a string.
+ * @param accumulator Receives the accumulator of the board.
+ */
+void Nnue::refresh(const std::string& board, NnueAccumulator* accumulator) {
+  for (int perspective = 0; perspective < 2; perspective++) {
+    NnueChanges changes = {{}, {}, 0, 0};
+    memcpy(accumulator->values[perspective], featureBiases, sizeof(featureBiases));
+    for (int square = 0; square < 64; square++) {
+      if (board[square] == ' ') continue;
+      changes.added[changes.addCount++] = featureWeights[featureIndex(board[square], square, perspective)];
+      if (changes.addCount == 4) {
+        kernels.apply(accumulator->values[perspective], accumulator->values[perspective], changes);
+        changes.addCount = 0;
+      }
+    }
+    kernels.apply(accumulator->values[perspective], accumulator->values[perspective], changes);
+  }
+}
+
+/**
+ * Calculates the accumulator after a move from the accumulator before it. Only the squares, which the move changed,
+ * are applied: at most two pieces are removed and two are added, for example by castling or a capturing promotion.
+ *
+ * @param previous The accumulator of the board before the move.
+ * @param before The chessboard before the move.
+ * @param after The chessboard after the move.
+ * @param next Receives the accumulator of the board after the move. May be the same as previous.
+ */
+void Nnue::update(const NnueAccumulator& previous, const std::string& before, const std::string& after,
+                  NnueAccumulator* next) {
+  int removed[4][2], added[4][2];
+  int removeCount = 0, addCount = 0;
+  for (int square = 0; square < 64; square++) {
+    // Most rows are unchanged, so compare eight squares at once first
+    if (square % 8 == 0) {
+      uint64_t rowBefore, rowAfter;
+      memcpy(&rowBefore, before.data() + square, 8);
+      memcpy(&rowAfter, after.data() + square, 8);
+      if (rowBefore == rowAfter) {
+        square += 7;
+        continue;
+      }
+    }
+    if (before[square] == after[square]) continue;
+    if (before[square] != ' ' && removeCount < 4) {
+      removed[removeCount][0] = featureIndex(before[square], square, 0);
+      removed[removeCount++][1] = featureIndex(before[square], square, 1);
+    }
+    if (after[square] != ' ' && addCount < 4) {
+      added[addCount][0] = featureIndex(after[square], square, 0);
+      added[addCount++][1] = featureIndex(after[square], square, 1);
+    }
+  }
+  for (int perspective = 0; perspective < 2; perspective++) {
+    NnueChanges changes = {{}, {}, addCount, removeCount};
+    for (int i = 0; i < addCount; i++) changes.added[i] = featureWeights[added[i][perspective]];
+    for (int i = 0; i < removeCount; i++) changes.removed[i] = featureWeights[removed[i][perspective]];
+    kernels.apply(next->values[perspective], previous.values[perspective], changes);
+  }
+}
+
+/**
+ * Evaluates a position from its accumulator.
+ *
+ * @param accumulator The accumulator of the position.
+ * @param turn The player to move. `true` for white, `false` for black.
+ * @return The evaluation in centipawns from the view of the player to move, positive if the player is better.
+ */
+int Nnue::evaluate(const NnueAccumulator& accumulator, bool turn) {
+  const int16_t* us = accumulator.values[turn ? 0 : 1];
+  const int16_t* them = accumulator.values[turn ? 1 : 0];
+  long long sum = kernels.output(us, them, outputWeights) + (long long)outputBias;
+  return (int)(sum * outputScale / (activationMax * weightScale));
+}
+
+/**
+ * Returns the index of the input neuron of a piece on a square. Every perspective sees its own pieces first, and the
+ * black perspective mirrors the board vertically, so both players share the same weights.
+ */
+int Nnue::featureIndex(char piece, int square, int perspective) {
+  int type;
+  switch (tolower(piece)) {
+    case 'p':
+      type = 0;
+      break;
+    case 'n':
+      type = 1;
+      break;
+    case 'b':
+      type = 2;
+      break;
+    case 'r':
+      type = 3;
+      break;
+    case 'q':
+      type = 4;
+      break;
+    default:
+      type = 5;
+  }
+  bool own = (isupper(piece) != 0) == (perspective == 0);
+  return (own ? 0 : 384) + type * 64 + (perspective == 0 ? square : square ^ 56);
+}
+
+/**
+ * @brief Getters of the Nnue class.
+ *
+ * */
+bool Nnue::isLoaded() { return loaded; }
+
+const char* Nnue::getKernel() { return kernels.name; }
@@ -0,0 +1,48 @@
+#ifndef NNUE_H_
+#define NNUE_H_
+
+#include <cstdint>
+#include <string>
+
+// Output of the first layer for both perspectives, white (0) and black (1). It only depends on the pieces, so it is
+// updated with the few pieces, which a move changes, instead of being recalculated.
+struct alignas(32) NnueAccumulator {
+  static constexpr int size = 128;
+
+  int16_t values[2][size];
+};
+
+// Small efficiently updatable neural network: 768 piece-square inputs per perspective, a hidden layer of 128 neurons
+// per perspective and one output, the evaluation in centipawns. The hidden layer is the accumulator, the output layer
+// is computed with int8 weights on the clipped accumulators, with AVX2 or SSE4.1 if the processor supports it.
+class Nnue {
+ public:
+  static constexpr int inputs = 768;
+  static constexpr int hidden = NnueAccumulator::size;
+  // Clipped activations range from 0 to activationMax, the output weights are scaled by weightScale
+  static constexpr int activationMax = 127;
+  static constexpr int weightScale = 64;
+
+  Nnue();
+  ~Nnue();
+
+  bool load(const std::string& path);
+  bool isLoaded();
+  void refresh(const std::string& board, NnueAccumulator* accumulator);
+  void update(const NnueAccumulator& previous, const std::string& before, const std::string& after,
+              NnueAccumulator* next);
+  int evaluate(const NnueAccumulator& accumulator, bool turn);
+  const char* getKernel();
+
+ private:
+  int featureIndex(char piece, int square, int perspective);
+
+  bool loaded;
+  int outputBias;
+  int outputScale;
+  alignas(32) int16_t featureWeights[inputs][hidden];
+  alignas(32) int16_t featureBiases[hidden];
+  alignas(32) int8_t outputWeights[2 * hidden];
+};
+
+#endif  // NNUE_H_
@@ -0,0 +1,169 @@
+#include "./PawnHash.h"
+
+// Random keys of the white (0) and black (1) pawns on every square, generated once with splitmix64
+struct PawnKeys {
+  uint64_t keys[2][64];
+
+  PawnKeys() {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int color = 0; color < 2; color++) {
+      for (int square = 0; square < 64; square++) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        keys[color][square] = z ^ (z >> 31);
+      }
+    }
+  }
+};
+
+static const PawnKeys pawnKeys;
+
+// Bonus of a passed pawn by the number of rows it has advanced from its starting row
+static const int passedBonus[6] = {5, 10, 20, 35, 60, 100};
+static const int doubledPenalty = 12;
+static const int isolatedPenalty = 15;
+static const uint64_t fileA = 0x0101010101010101ull;
+
+/**
+ * @brief Constructs a PawnTable.
+ *
+ * The entries start zeroed, which is the correct entry of the key 0, a board without pawns, so empty entries never
+ * have to be told apart from used ones.
+ *
+ * @param pSize The number of entries, rounded down to a power of two.
+ */
+PawnTable::PawnTable(int pSize) : hits(0), misses(0) {
+  int size = 1;
+  while (size * 2 <= pSize) size *= 2;
+  entries.resize(size);
+  mask = size - 1;
+  clear();
+}
+
+PawnTable::~PawnTable() {}
+
+/**
+ * Returns the pawn structure terms of a board. They are only analyzed, if the table holds no entry of the key.
+ *
+ * @param board The chessboard represented as a string.
+ * @param key The pawn key of the board, see computeKey.
+ * @return The entry of the pawn structure. It stays valid until the next probe.
+ */
+const PawnEntry& PawnTable::probe(const std::string& board, uint64_t key) {
+  PawnEntry& entry = entries[key & mask];
+  if (entry.key == key) {
+    hits++;
+    return entry;
+  }
+  misses++;
+  analyze(board, &entry);
+  entry.key = key;
+  return entry;
+}
+
+/**
+ * Removes all entries from the table.
+ */
+void PawnTable::clear() {
+  for (PawnEntry& entry : entries) entry = PawnEntry();
+  hits = 0;
+  misses = 0;
+}
+
+/**
+ * Returns the table of the calling thread, which is created on the first call.
+ */
+PawnTable& PawnTable::local() {
+  static thread_local PawnTable table(1 << 13);
+  return table;
+}
+
+/**
+ * Calculates the pawn key of a board from scratch. Moves update the key with squareKey instead.
+ *
+ * @param board The chessboard represented as a string.
+ * @return The XOR of the keys of all pawns.
+ */
+uint64_t PawnTable::computeKey(const std::string& board) {
+  uint64_t key = 0;
+  for (int square = 0; square < 64; square++) key ^= squareKey(board[square], square);
+  return key;
+}
+
+/**
+ * Returns the key of a piece on a square, 0 for all pieces except pawns. XOR-ing the keys of the old and the new
+ * piece of every changed square updates a pawn key.
+ *
+ * @param piece The character representing the chess piece, or ' ' for an empty square.
+ * @param square The index of the square (y * 8 + x).
+ */
+uint64_t PawnTable::squareKey(char piece, int square) {
+  if (piece == 'P') return pawnKeys.keys[0][square];
+  if (piece == 'p') return pawnKeys.keys[1][square];
+  return 0;
+}
+
+/**
+ * Analyzes the pawn structure of a board: doubled, isolated and passed pawns and the pawn shields.
+ *
+ * @param board The chessboard represented as a string.
+ * @param entry Receives the terms. The key is not changed.
+ */
+void PawnTable::analyze(const std::string& board, PawnEntry* entry) {
+  entry->pawns[0] = entry->pawns[1] = 0;
+  entry->passed[0] = entry->passed[1] = 0;
+  entry->score = 0;
+  for (int square = 0; square < 64; square++) {
+    if (board[square] == 'P') entry->pawns[0] |= 1ull << square;
+    if (board[square] == 'p') entry->pawns[1] |= 1ull << square;
+  }
+
+  for (int color = 0; color < 2; color++) {
+    int sign = color == 0 ? 1 : -1;
+    uint64_t own = entry->pawns[color];
+    uint64_t other = entry->pawns[1 - color];
+    for (int x = 0; x < 8; x++) {
+      uint64_t file = fileA << x;
+      uint64_t neighbours = (x > 0 ? file >> 1 : 0) | (x < 7 ? file << 1 : 0);
+      int count = __builtin_popcountll(own & file);
+      if (count > 1) entry->score -= sign * doubledPenalty * (count - 1);
+      if (count > 0 && (own & neighbours) == 0) entry->score -= sign * isolatedPenalty * count;
+
+      // Passed pawns have no opposing pawn in front of them on their own or a neighbouring file. White pawns move
+      // towards row 0, so the rows in front of a white pawn on row y are the rows 0 to y - 1.
+      for (uint64_t pawns = own & file; pawns != 0; pawns &= pawns - 1) {
+        int square = __builtin_ctzll(pawns);
+        int y = square / 8;
+        uint64_t front = color == 0 ? (1ull << (y * 8)) - 1 : ~0ull << ((y + 1) * 8 - 1) << 1;
+        if ((other & (file | neighbours) & front) != 0) continue;
+        entry->passed[color] |= 1ull << square;
+        int advanced = color == 0 ? 6 - y : y - 1;
+        if (advanced >= 0 && advanced < 6) entry->score += sign * passedBonus[advanced];
+      }
+    }
+
+    // A king on its back row is shielded by the pawns one or two rows in front of it
+    int row1 = color == 0 ? 6 : 1;
+    int row2 = color == 0 ? 5 : 2;
+    for (int king = 0; king < 8; king++) {
+      int shield = 0;
+      for (int x = king - 1; x <= king + 1; x++) {
+        if (x < 0 || x > 7) continue;
+        if (own & (1ull << (row1 * 8 + x)))
+          shield += 10;
+        else if (own & (1ull << (row2 * 8 + x)))
+          shield += 5;
+      }
+      entry->shield[color][king] = shield;
+    }
+  }
+}
+
+/**
+ * @brief Getters of the PawnTable class.
+ *
+ * */
+int PawnTable::getHits() { return hits; }
+
+int PawnTable::getMisses() { return misses; }
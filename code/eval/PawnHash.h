@@ -0,0 +1,44 @@
+#ifndef PAWNHASH_H_
+#define PAWNHASH_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Pawn structure terms of one pawn position, from the view of white (positive is good for white). Bitboards use the
+// square index (y * 8 + x) as bit index, white (0) and black (1).
+struct PawnEntry {
+  uint64_t key;
+  uint64_t pawns[2];
+  uint64_t passed[2];
+  // Doubled, isolated and passed pawns
+  int score;
+  // Bonus of the pawns in front of a king on its back row, for every file the king can stand on
+  int8_t shield[2][8];
+};
+
+// Cache of pawn structure terms, indexed by the pawn key of the position. Most moves do not change the pawns, so the
+// terms are only analyzed, when a pawn structure is seen for the first time. Every thread uses its own table.
+class PawnTable {
+ public:
+  explicit PawnTable(int pSize);
+  ~PawnTable();
+
+  const PawnEntry& probe(const std::string& board, uint64_t key);
+  void clear();
+  int getHits();
+  int getMisses();
+
+  static PawnTable& local();
+  static uint64_t computeKey(const std::string& board);
+  static uint64_t squareKey(char piece, int square);
+  static void analyze(const std::string& board, PawnEntry* entry);
+
+ private:
+  std::vector<PawnEntry> entries;
+  uint64_t mask;
+  int hits;
+  int misses;
+};
+
+#endif  // PAWNHASH_H_
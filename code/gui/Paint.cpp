@@ -1,8 +1,10 @@
-#define UNICODE
-
 #include "./Paint.h"
 
-#include <filesystem>
+#include <cmath>
+#include <cwchar>
+
+#include "../profiling/AllocationProfiler.h"
+#include "../profiling/Trace.h"
 
 /**
  * @brief Constructs a new Paint object.
@@ -13,14 +15,11 @@
  * @param mWidth The width of the paint area.
  * @param mHeight The height of the paint area.
  */
-Paint::Paint(Board* pBoard, int mWidth, int mHeight)
-    : width(mWidth), height(mHeight), board(pBoard), brush(Gdiplus::Color(255, 255, 255, 255)) {
+Paint::Paint(Board* pBoard, int mWidth, int mHeight) : width(mWidth), height(mHeight), board(pBoard) {
   path = L".//graphics//";
-  endingFont = new Gdiplus::Font(new Gdiplus::FontFamily(L"Arial"), 16, Gdiplus::FontStyleRegular, Gdiplus::UnitPixel);
-  timerFont = new Gdiplus::Font(new Gdiplus::FontFamily(L"Arial"), 24, Gdiplus::FontStyleRegular, Gdiplus::UnitPixel);
-  pen = new Gdiplus::Pen(Gdiplus::Color(255, 0, 0, 0));
-  stringFormat.SetAlignment(Gdiplus::StringAlignmentCenter);
-  stringFormat.SetLineAlignment(Gdiplus::StringAlignmentCenter);
+  optionsVersion = 0;
+  hasSnapshot = false;
+  scratch.reserve(64);
 }
 
 /**
@@ -31,87 +30,258 @@ Paint::Paint(Board* pBoard, int mWidth, int mHeight)
 Paint::~Paint() { delete board; }
 
 /**
- * Draws the background of the window.
+ * @brief Records all the windows components of one frame into the render list.
+ *
+ * The list is cleared first, so it can be reused for every frame. The order of the calls matches the order in which
+ * the components overlap each other.
+ *
+ * @param list The render list, which receives the draw commands.
+ * @param dragging True, if a piece is currently dragged by the mouse.
+ * @param x The x-coordinate of the mouse.
+ * @param y The y-coordinate of the mouse.
+ */
+void Paint::drawFrame(RenderList* list, bool dragging, int x, int y) {
+  TRACE_SCOPE("Paint::drawFrame");
+  ALLOCATION_SCOPE("frame");
+  list->clear();
+  drawBgd(list);
+  drawBoard(list);
+  drawMoveOptions(list);
+  drawPieces(list);
+  drawButtons(list);
+  drawPromotionMenu(list);
+  drawTimer(list);
+  drawEndingScreen(list);
+  if (dragging) drawDraggedPiece(list, x, y);
+}
+
+/**
+ * @brief Compares the state of the board with the state at the last call and marks the changed regions.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object used for drawing.
+ * Only the logical regions, which are affected by a change, are marked: the clock fields, the squares whose pieces or
+ * move options changed, and the old and new position of a dragged piece. Changes to the whole layout, like a rotation
+ * of the board, the promotion menu or the ending screen, mark the whole window.
+ *
+ * @param dirty The dirty regions, which receive the changed rectangles.
+ * @param dragging True, if a piece is currently dragged by the mouse.
+ * @param x The x-coordinate of the mouse.
+ * @param y The y-coordinate of the mouse.
  */
-void Paint::drawBgd(Gdiplus::Graphics* graphics) {
-  brush.SetColor(Gdiplus::Color(255, 38, 38, 38));
-  graphics->FillRectangle(&brush, 0, 0, width, height);
+void Paint::collectDirtyRegions(DirtyRegions* dirty, bool dragging, int x, int y) {
+  TRACE_SCOPE("Paint::collectDirtyRegions");
+  BoardView visualBoard = board->viewVisualBoard();
+  const std::wstring& endMessage = board->getEndMessage();
+  wchar_t clocks[2][32];
+  getClockText(0, clocks[0]);
+  getClockText(1, clocks[1]);
+  int selectedPiece = board->getSelectedPiece();
+  bool rotate = board->doesRotate();
+  bool turn = board->getTurn();
+  bool showMoves = board->doesShowMoves();
+  bool promoting = board->isPromoting();
+  bool changed = !hasSnapshot || visualBoard.version != lastVersion;
+  const std::vector<int>& options = changed && showMoves && selectedPiece != -1 ? getMoveOptions() : noOptions;
+
+  if (!hasSnapshot || lastSize[0] != width || lastSize[1] != height ||
+      (changed && (endMessage != lastEndMessage || promoting != lastPromoting || rotate != lastRotate ||
+                   (rotate && turn != lastTurn) || visualBoard.squares.length() != lastVisualBoard.length()))) {
+    dirty->addAll();
+  } else {
+    if (changed) {
+      // Squares, whose piece changed
+      for (int i = 0; i < visualBoard.squares.length(); i++) {
+        if (visualBoard.squares[i] != lastVisualBoard[i]) dirty->add(getSquareRect(i));
+      }
+      // Squares, which gained or lost a move option
+      if (options != lastMoveOptions) {
+        for (int square : lastMoveOptions) dirty->add(getSquareRect(square));
+        for (int square : options) dirty->add(getSquareRect(square));
+      }
+      // The switch of the move options button
+      if (showMoves != lastShowMoves) dirty->add({50 + 150 / 2 - 39, 50 + 170, 78, 40});
+    }
+    // The clock fields
+    if (lastClocks[0] != clocks[0]) dirty->add({width - 300, 60, 200, 80});
+    if (lastClocks[1] != clocks[1]) dirty->add({width - 300, height - 140, 200, 80});
+    // The old and the new position of the dragged piece
+    bool drawsDrag = dragging && selectedPiece != -1;
+    bool drewDrag = lastDragging && lastSelectedPiece != -1;
+    if (drawsDrag != drewDrag || selectedPiece != lastSelectedPiece || x != lastDrag[0] || y != lastDrag[1]) {
+      if (drewDrag) dirty->add(getDraggedPieceRect(lastDrag[0], lastDrag[1]));
+      if (drawsDrag) dirty->add(getDraggedPieceRect(x, y));
+    }
+  }
+
+  // Remember the drawn state. The assignments reuse the storage of the previous snapshot.
+  if (changed) {
+    lastVersion = visualBoard.version;
+    lastVisualBoard.assign(visualBoard.squares);
+    lastEndMessage.assign(endMessage);
+    lastMoveOptions.assign(options.begin(), options.end());
+  }
+  hasSnapshot = true;
+  lastClocks[0].assign(clocks[0]);
+  lastClocks[1].assign(clocks[1]);
+  lastSelectedPiece = selectedPiece;
+  lastDrag[0] = x;
+  lastDrag[1] = y;
+  lastSize[0] = width;
+  lastSize[1] = height;
+  lastDragging = dragging;
+  lastRotate = rotate;
+  lastTurn = turn;
+  lastShowMoves = showMoves;
+  lastPromoting = promoting;
 }
 
 /**
- * Draws the ending screen on the specified graphics object.
+ * Calculates the rectangle on the window, in which a square of the board is drawn, respecting the rotation.
+ *
+ * @param square The index of the square on the board.
+ * @return The rectangle of the square on the window.
+ */
+RenderRect Paint::getSquareRect(int square) {
+  int x = (height - 100) / 2;
+  int y = 50;
+  int width = height - 100;
+  int invert = board->getWidth() * board->getHeight() - 1;
+  int j = board->doesRotate() ? board->getTurn() ? square : (invert - square) : square;
+  return {x + (j % board->getWidth()) * width / board->getWidth(),
+          y + (j / board->getWidth()) * width / board->getHeight(), width / board->getWidth() + 1,
+          width / board->getHeight() + 1};
+}
+
+/**
+ * Calculates the rectangle, in which the dragged piece is drawn.
+ *
+ * @param x The x-coordinate of the mouse.
+ * @param y The y-coordinate of the mouse.
+ * @return The rectangle of the dragged piece on the window.
+ */
+RenderRect Paint::getDraggedPieceRect(int x, int y) { return {x - 46, y - 46, 92, 92}; }
+
+/**
+ * Formats the time of one of the two displayed clocks, respecting the rotation.
+ *
+ * @param clock 0 for the upper clock, 1 for the lower clock.
+ * @param text A buffer of at least 32 characters, which receives the displayed time as minutes, seconds and tenths.
+ */
+void Paint::getClockText(int clock, wchar_t* text) {
+  double time[2] = {round((board->getTime()[0].load()) * 10) / 10, round((board->getTime()[1].load()) * 10) / 10};
+  double visTime = clock == 0 ? time[board->doesRotate() ? !board->getTurn() : 0]
+                              : time[board->doesRotate() ? board->getTurn() : 1];
+  swprintf(text, 32, L"%d:%d.%d", static_cast<int>(floor(visTime / 60)), (static_cast<int>(floor(visTime))) % 60,
+           static_cast<int>(round(visTime * 10)) % 10);
+}
+
+/**
+ * Builds the path to the image of a piece in the scratch buffer, without allocating memory.
+ *
+ * @param piece The character of the piece on the board.
+ * @return A view of the path, which is valid until the scratch buffer is used again.
+ */
+std::wstring_view Paint::getPiecePath(char piece) {
+  scratch.assign(path);
+  scratch.append(L"Pieces//");
+  scratch.push_back(isupper(piece) ? L'w' : L'b');
+  scratch.push_back(tolower(piece));
+  scratch.append(L".png");
+  return scratch;
+}
+
+/**
+ * Builds the path to an image in one of the graphics folders in the scratch buffer, without allocating memory.
+ *
+ * @param folder The folder inside the graphics folder, including the trailing slashes.
+ * @param name The file name of the image.
+ * @return A view of the path, which is valid until the scratch buffer is used again.
+ */
+std::wstring_view Paint::getImagePath(const wchar_t* folder, const wchar_t* name) {
+  scratch.assign(path);
+  scratch.append(folder);
+  scratch.append(name);
+  return scratch;
+}
+
+/**
+ * Returns the available moves of the selected piece. The moves are only generated again, if the version of the board
+ * changed since the last call.
+ *
+ * @return The available moves, the first element being the selected square, or an empty vector.
+ */
+const std::vector<int>& Paint::getMoveOptions() {
+  if (optionsVersion == board->getVersion()) return moveOptions;
+  optionsVersion = board->getVersion();
+  moveOptions.clear();
+  MoveList available;
+  board->testAvailableMoves(&available);
+  for (Move move : available) {
+    if (move.getFrom() != board->getSelectedPiece()) continue;
+    if (moveOptions.empty()) moveOptions.push_back(move.getFrom());
+    // Promotions to the different pieces share the same square
+    if (moveOptions.back() != move.getTo()) moveOptions.push_back(move.getTo());
+  }
+  return moveOptions;
+}
+
+/**
+ * Draws the background of the window.
+ *
+ * @param list The render list, which receives the draw commands.
+ */
+void Paint::drawBgd(RenderList* list) { list->fillRect(0, 0, width, height, {255, 38, 38, 38}); }
+
+/**
+ * Draws the ending screen.
  * The ending screen consists of a background image, a title image, showing the result, and a text message for further
  * details.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which to draw the ending screen.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawEndingScreen(Gdiplus::Graphics* graphics) {
-  int result = board->getEndMessage().substr(0, 5) == L"White"   ? 1
-               : board->getEndMessage().substr(0, 5) == L"Black" ? 2
-                                                                 : 0;
-  if (board->getEndMessage() == L"") return;
+void Paint::drawEndingScreen(RenderList* list) {
+  const std::wstring& message = board->getEndMessage();
+  if (message == L"") return;
+  const wchar_t* result = message.compare(0, 5, L"White") == 0   ? L"White"
+                          : message.compare(0, 5, L"Black") == 0 ? L"Black"
+                                                                 : L"Draw";
   int x = width / 2 - 125;
   int y = height / 2 - 80;
 
-  Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap(
-      (path + L"EndingScreens//" + (result == 0 ? L"Draw" : ((result == 1 ? L"White" : L"Black"))) + L"WinPieces.png")
-          .c_str());
-  graphics->DrawImage(bmp, x, y - 68, 200, 68);
-
-  bmp = new Gdiplus::Bitmap((path + L"EndingScreens//StandartBgd.png").c_str());
-  graphics->DrawImage(bmp, x, y, 200, 160);
-  bmp = new Gdiplus::Bitmap(
-      (path + L"EndingScreens//" + (result == 0 ? L"Draw" : ((result == 1 ? L"White" : L"Black"))) + L"Win.png")
-          .c_str());
-  graphics->DrawImage(bmp, x + 20, y + 10, 160, 40);
-  bmp = new Gdiplus::Bitmap((path + L"Buttons//NewGameBlack.png").c_str());
-  graphics->DrawImage(bmp, x + 20, y + 110, 160, 40);
-
-  pointF.X = x + 100;
-  pointF.Y = y + 72;
-  graphics->DrawString(board->getEndMessage().c_str(), -1, endingFont, pointF, &stringFormat, &brush);
+  getImagePath(L"EndingScreens//", result);
+  list->drawImage(scratch.append(L"WinPieces.png"), x, y - 68, 200, 68);
+  list->drawImage(getImagePath(L"EndingScreens//", L"StandartBgd.png"), x, y, 200, 160);
+  getImagePath(L"EndingScreens//", result);
+  list->drawImage(scratch.append(L"Win.png"), x + 20, y + 10, 160, 40);
+  list->drawImage(getImagePath(L"Buttons//", L"NewGameBlack.png"), x + 20, y + 110, 160, 40);
+
+  list->drawText(message, x + 100, y + 72, 16, {255, 0, 0, 0});
 }
 
 /**
- * Draws the timer on the graphics object.
+ * Draws the timer.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which to draw the timer.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawTimer(Gdiplus::Graphics* graphics) {
+void Paint::drawTimer(RenderList* list) {
   bool color = (board->doesRotate() ? board->getTurn() ? 0 : 1 : 0);
-  brush.SetColor(Gdiplus::Color(255, color * 255, color * 255, color * 255));
-  pointF.X = width - 200;
-  pointF.Y = 100;
-  double time[2] = {round((board->getTime()[0].load()) * 10) / 10, round((board->getTime()[1].load()) * 10) / 10};
-  double visTime[2] = {time[board->doesRotate() ? !board->getTurn() : 0],
-                       time[board->doesRotate() ? board->getTurn() : 1]};
-  graphics->FillRectangle(&brush, width - 300, 60, 200, 80);
-  brush.SetColor(Gdiplus::Color(255, !color * 255, !color * 255, !color * 255));
-  graphics->DrawString((std::to_wstring(static_cast<int>(floor(visTime[0] / 60))) + L":" +
-                        std::to_wstring((static_cast<int>(floor(visTime[0]))) % 60) + L"." +
-                        std::to_wstring(static_cast<int>(round(visTime[0] * 10)) % 10))
-                           .c_str(),
-                       -1, timerFont, pointF, &stringFormat, &brush);
-  pointF.Y = height - 100;
-  graphics->FillRectangle(&brush, width - 300, height - 140, 200, 80);
-  brush.SetColor(Gdiplus::Color(255, color * 255, color * 255, color * 255));
-  graphics->DrawString((std::to_wstring(static_cast<int>(floor(visTime[1] / 60))) + L":" +
-                        std::to_wstring((static_cast<int>(floor(visTime[1]))) % 60) + L"." +
-                        std::to_wstring(static_cast<int>(round(visTime[1] * 10)) % 10))
-                           .c_str(),
-                       -1, timerFont, pointF, &stringFormat, &brush);
+  int c = color * 255;
+  int nc = !color * 255;
+  wchar_t text[32];
+  list->fillRect(width - 300, 60, 200, 80, {255, c, c, c});
+  getClockText(0, text);
+  list->drawText(text, width - 200, 100, 24, {255, nc, nc, nc});
+  list->fillRect(width - 300, height - 140, 200, 80, {255, nc, nc, nc});
+  getClockText(1, text);
+  list->drawText(text, width - 200, height - 100, 24, {255, c, c, c});
 }
 
 /**
- * Draws the promotion menu on the graphics object.
+ * Draws the promotion menu.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which to draw the promotion menu.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawPromotionMenu(Gdiplus::Graphics* graphics) {
+void Paint::drawPromotionMenu(RenderList* list) {
   if (!board->isPromoting() || board->getSelectedPiece() == -1) return;
-  brush.SetColor(Gdiplus::Color(255, 255, 255, 255));
   // Initialize the location variables
   int piece = board->getSelectedPiece();
   int squareWidth = height - 100;
@@ -124,175 +294,125 @@ void Paint::drawPromotionMenu(Gdiplus::Graphics* graphics) {
                                                       : (board->getHeight() - 4)) *
                    squareWidth / board->getHeight();
   squareWidth = (height - 100) / board->getWidth();
-  graphics->FillRectangle(&brush, x, y, squareWidth, 4 * squareWidth);
+  list->fillRect(x, y, squareWidth, 4 * squareWidth, {255, 255, 255, 255});
   for (int i = 0; i < 4; i++) {
-    graphics->DrawRectangle(pen, x, y + i * squareWidth, squareWidth, squareWidth);
+    list->drawRect(x, y + i * squareWidth, squareWidth, squareWidth, {255, 0, 0, 0});
   }
-  // Construct the path to the piece image
-  std::wstring tempPath = path + L"Pieces//";
-  if (isupper(board->getBoard()[piece]))
-    tempPath += L"w";
-  else
-    tempPath += L"b";
-
-  // Draw the promotion pieces
-  Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap((tempPath + L"q.png").c_str());
-  graphics->DrawImage(bmp, x, y, squareWidth, squareWidth);
-  bmp = new Gdiplus::Bitmap((tempPath + L"r.png").c_str());
-  graphics->DrawImage(bmp, x, y + squareWidth, squareWidth, squareWidth);
-  bmp = new Gdiplus::Bitmap((tempPath + L"b.png").c_str());
-  graphics->DrawImage(bmp, x, y + 2 * squareWidth, squareWidth, squareWidth);
-  bmp = new Gdiplus::Bitmap((tempPath + L"n.png").c_str());
-  graphics->DrawImage(bmp, x, y + 3 * squareWidth, squareWidth, squareWidth);
+  // Draw the promotion pieces in the color of the promoting pawn
+  bool white = isupper(board->viewBoard().squares[piece]);
+  list->drawImage(getPiecePath(white ? 'Q' : 'q'), x, y, squareWidth, squareWidth);
+  list->drawImage(getPiecePath(white ? 'R' : 'r'), x, y + squareWidth, squareWidth, squareWidth);
+  list->drawImage(getPiecePath(white ? 'B' : 'b'), x, y + 2 * squareWidth, squareWidth, squareWidth);
+  list->drawImage(getPiecePath(white ? 'N' : 'n'), x, y + 3 * squareWidth, squareWidth, squareWidth);
 }
 
 /**
- * Draws the piece currently being dragged on the graphics object.
+ * Draws the piece currently being dragged.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object.
+ * @param list The render list, which receives the draw commands.
  * @param x The x-coordinate of the dragged piece.
  * @param y The y-coordinate of the dragged piece.
  */
-void Paint::drawDraggedPiece(Gdiplus::Graphics* graphics, int x, int y) {
+void Paint::drawDraggedPiece(RenderList* list, int x, int y) {
   if (board->getSelectedPiece() == -1) return;
-  // Construct the path to the piece image
-  std::wstring tempPath = path + L"Pieces//";
-  if (isupper(board->getBoard()[board->getSelectedPiece()]))
-    tempPath += L"w";
-  else
-    tempPath += L"b";
-
-  tempPath += std::wstring(1, board->getBoard()[board->getSelectedPiece()]);
-  tempPath += L".png";
-
-  Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap(tempPath.c_str());
-  graphics->DrawImage(bmp, x - 45, y - 45, 90, 90);
+  list->drawImage(getPiecePath(board->viewBoard().squares[board->getSelectedPiece()]), x - 45, y - 45, 90, 90);
 }
 
 /**
- * Draws the move options on the graphics object.
+ * Draws the move options.
  * If the board does not show moves or no piece is selected, the function returns early.
  * The move options are determined based on the selected piece and the available moves on the board.
- * The move options are filled rectangles on the graphics object, represented by a solid brush.
+ * The move options are drawn as half transparent filled rectangles.
  * The position and size of each rectangle is calculated based on the board's properties and the moves vector.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which the move options will be drawn.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawMoveOptions(Gdiplus::Graphics* graphics) {
+void Paint::drawMoveOptions(RenderList* list) {
   if (!board->doesShowMoves()) return;
-  std::vector<int> moves;
   if (board->getSelectedPiece() != -1) {
-    int invert = board->getWidth() * board->getHeight() - 1;
-    int j;
-    brush.SetColor(Gdiplus::Color(120, 219, 2, 2));
-    for (int i = 0; i < board->testAvailableMoves().size(); i++) {
-      j = board->doesRotate() ? board->getTurn() ? i : (invert - i) : i;
-      if (board->testAvailableMoves()[i][0] == board->getSelectedPiece()) {
-        moves = board->testAvailableMoves()[i];
-        break;
-      }
-    }
+    const std::vector<int>& moves = getMoveOptions();
     int width = height - 100;
     int x = width / 2;
     int y = 50;
     for (int i = 0; i < moves.size(); i++) {
-      graphics->FillRectangle(&brush,
-                              x + (abs((board->doesRotate() ? board->getTurn() ? 0 : board->getWidth() - 1 : 0) -
-                                       (moves[i] % board->getWidth()))) *
-                                      width / board->getWidth(),
-                              y + (abs((board->doesRotate() ? board->getTurn() ? 0 : board->getHeight() - 1 : 0) -
-                                       ceil(moves[i] / board->getWidth()))) *
-                                      width / board->getHeight(),
-                              width / board->getWidth(), width / board->getHeight());
+      list->fillRect(x + (abs((board->doesRotate() ? board->getTurn() ? 0 : board->getWidth() - 1 : 0) -
+                              (moves[i] % board->getWidth()))) *
+                             width / board->getWidth(),
+                     y + (abs((board->doesRotate() ? board->getTurn() ? 0 : board->getHeight() - 1 : 0) -
+                              (int)ceil(moves[i] / board->getWidth()))) *
+                             width / board->getHeight(),
+                     width / board->getWidth(), width / board->getHeight(), {120, 219, 2, 2});
     }
   }
 }
 
 /**
- * Draws the game board on the specified graphics object.
+ * Draws the game board.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which to draw the board.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawBoard(Gdiplus::Graphics* graphics) {
-  brush.SetColor(Gdiplus::Color(board->style[0], board->style[1], board->style[2], board->style[3]));
+void Paint::drawBoard(RenderList* list) {
   // Initialize the location variables
   int x = (height - 100) / 2;
   int y = 50;
   int width = height - 100;
-  int w = board->getWidth();
-  graphics->FillRectangle(&brush, x, y, width, width);
-  brush.SetColor(Gdiplus::Color(123, 255, 255, 255));
+  list->fillRect(x, y, width, width, {board->style[0], board->style[1], board->style[2], board->style[3]});
   for (int i = 0; i < board->getWidth(); i++) {
     for (int j = 0; j < board->getHeight(); j++) {
       if ((i + j) % 2 == 0)
-        graphics->FillRectangle(&brush, x + i * width / board->getWidth(), y + j * width / board->getHeight(),
-                                width / board->getWidth(), width / board->getHeight());
+        list->fillRect(x + i * width / board->getWidth(), y + j * width / board->getHeight(), width / board->getWidth(),
+                       width / board->getHeight(), {123, 255, 255, 255});
     }
   }
 }
 
 /**
- * Draws the pieces on the graphics object.
+ * Draws the pieces.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which the pieces will be drawn.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawPieces(Gdiplus::Graphics* graphics) {
+void Paint::drawPieces(RenderList* list) {
   // Initialize the location variables
   int x = (height - 100) / 2;
   int y = 50;
   int width = height - 100;
   int invert = board->getWidth() * board->getHeight() - 1;
+  std::string_view squares = board->viewVisualBoard().squares;
   int i;
-  for (int j = 0; j < board->getVisualBoard().length(); j++) {
+  for (int j = 0; j < squares.length(); j++) {
     i = board->doesRotate() ? board->getTurn() ? j : (invert - j) : j;
-    if (board->getVisualBoard()[i] == ' ') continue;
-
-    // Construct the path to the piece image
-    std::wstring tempPath = path + L"Pieces//";
-    if (isupper(board->getVisualBoard()[i]))
-      tempPath += L"w";
-    else
-      tempPath += L"b";
-
-    tempPath += std::wstring(1, board->getVisualBoard()[i]);
-    tempPath += L".png";
-
-    Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap(tempPath.c_str());
-    graphics->DrawImage(bmp, x + (j % board->getWidth()) * width / board->getWidth(),
-                        y + (j / board->getWidth()) * width / board->getHeight(), width / board->getWidth(),
-                        width / board->getHeight());
+    if (squares[i] == ' ') continue;
+
+    list->drawImage(getPiecePath(squares[i]), x + (j % board->getWidth()) * width / board->getWidth(),
+                    y + (j / board->getWidth()) * width / board->getHeight(), width / board->getWidth(),
+                    width / board->getHeight());
   }
 }
 
 /**
- * @brief Draws the buttons on the graphics object.
+ * @brief Draws the buttons.
  *
- * This function is responsible for drawing the buttons on the specified graphics object.
- * It takes the width and height of the window as parameters to calculate the position of the buttons.
- * The buttons are drawn using the specified graphics object and the corresponding bitmaps.
+ * This function is responsible for drawing the buttons.
+ * It uses the width and height of the window to calculate the position of the buttons.
  *
- * @param graphics A pointer to the Gdiplus::Graphics object on which the buttons will be drawn.
+ * @param list The render list, which receives the draw commands.
  */
-void Paint::drawButtons(Gdiplus::Graphics* graphics) {
+void Paint::drawButtons(RenderList* list) {
   int x = 50;
   int y = 50;
   int width = 150;
-  std::wstring tempPath = path + L"Buttons//";
-
-  Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap((tempPath + L"TurnBoardBlackBig.png").c_str());
-  graphics->DrawImage(bmp, x, y, width, 40);
-  bmp = new Gdiplus::Bitmap(
-      (tempPath + (board->doesRotate() ? L"SwitchStandartOn.png" : L"SwitchStandartOff.png")).c_str());
-  graphics->DrawImage(bmp, x + width / 2 - 39, y + 50, 78, 40);
-
-  bmp = new Gdiplus::Bitmap((tempPath + L"MoveOptionsBlack.png").c_str());
-  graphics->DrawImage(bmp, x - 25, y + 120, 200, 40);
-  bmp = new Gdiplus::Bitmap(
-      (tempPath + (board->doesShowMoves() ? L"SwitchStandartOn.png" : L"SwitchStandartOff.png")).c_str());
-  graphics->DrawImage(bmp, x + width / 2 - 39, y + 170, 78, 40);
-
-  bmp = new Gdiplus::Bitmap((tempPath + L"UndoMoveBlack.png").c_str());
-  graphics->DrawImage(bmp, x - 5, y + 240, 160, 40);
+
+  list->drawImage(getImagePath(L"Buttons//", L"TurnBoardBlackBig.png"), x, y, width, 40);
+  list->drawImage(
+      getImagePath(L"Buttons//", board->doesRotate() ? L"SwitchStandartOn.png" : L"SwitchStandartOff.png"),
+      x + width / 2 - 39, y + 50, 78, 40);
+
+  list->drawImage(getImagePath(L"Buttons//", L"MoveOptionsBlack.png"), x - 25, y + 120, 200, 40);
+  list->drawImage(
+      getImagePath(L"Buttons//", board->doesShowMoves() ? L"SwitchStandartOn.png" : L"SwitchStandartOff.png"),
+      x + width / 2 - 39, y + 170, 78, 40);
+
+  list->drawImage(getImagePath(L"Buttons//", L"UndoMoveBlack.png"), x - 5, y + 240, 160, 40);
 }
 
 /**
@@ -314,4 +434,8 @@ Board* Paint::getBoard() { return board; }
 void Paint::setDimensions(int pWidth, int pHeight) {
   width = pWidth;
   height = pHeight;
-}
\ No newline at end of file
+}
+
+int Paint::getWidth() { return width; }
+
+int Paint::getHeight() { return height; }
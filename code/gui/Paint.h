@@ -1,12 +1,13 @@
 #ifndef PAINT_H_
 #define PAINT_H_
 
-#include <Windows.h>
-#include <gdiplus.h>
-
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "../rules/board/Board.h"
+#include "./render/DirtyRegions.h"
+#include "./render/RenderList.h"
 
 class Paint {
  public:
@@ -15,28 +16,55 @@ class Paint {
   ~Paint();
 
   Board* getBoard();
-  void drawBgd(Gdiplus::Graphics* graphics);
-  void drawBoard(Gdiplus::Graphics* graphics);
-  void drawPieces(Gdiplus::Graphics* graphics);
-  void drawButtons(Gdiplus::Graphics* graphics);
-  void drawDraggedPiece(Gdiplus::Graphics* graphics, int x, int y);
-  void drawPromotionMenu(Gdiplus::Graphics* graphics);
-  void drawMoveOptions(Gdiplus::Graphics* graphics);
-  void drawTimer(Gdiplus::Graphics* graphics);
-  void drawEndingScreen(Gdiplus::Graphics* graphics);
+  void drawFrame(RenderList* list, bool dragging, int x, int y);
+  void collectDirtyRegions(DirtyRegions* dirty, bool dragging, int x, int y);
+  void drawBgd(RenderList* list);
+  void drawBoard(RenderList* list);
+  void drawPieces(RenderList* list);
+  void drawButtons(RenderList* list);
+  void drawDraggedPiece(RenderList* list, int x, int y);
+  void drawPromotionMenu(RenderList* list);
+  void drawMoveOptions(RenderList* list);
+  void drawTimer(RenderList* list);
+  void drawEndingScreen(RenderList* list);
   void setDimensions(int pWidth, int pHeight);
+  int getWidth();
+  int getHeight();
 
  private:
-  Gdiplus::Pen* pen;
-  Gdiplus::SolidBrush brush;
-  Gdiplus::Font* endingFont;
-  Gdiplus::Font* timerFont;
-  Gdiplus::PointF pointF;
-  Gdiplus::StringFormat stringFormat;
+  RenderRect getSquareRect(int square);
+  RenderRect getDraggedPieceRect(int x, int y);
+  void getClockText(int clock, wchar_t* text);
+  std::wstring_view getPiecePath(char piece);
+  std::wstring_view getImagePath(const wchar_t* folder, const wchar_t* name);
+  const std::vector<int>& getMoveOptions();
+
   Board* board;
   std::wstring path;
+  std::wstring scratch;
   int width;
   int height;
+
+  // Cached move options of the selected piece
+  std::vector<int> moveOptions;
+  std::vector<int> noOptions;
+  unsigned long long optionsVersion;
+
+  // State, which was last handed to the window as dirty regions
+  bool hasSnapshot;
+  unsigned long long lastVersion;
+  std::string lastVisualBoard;
+  std::wstring lastEndMessage;
+  std::wstring lastClocks[2];
+  std::vector<int> lastMoveOptions;
+  int lastSelectedPiece;
+  int lastDrag[2];
+  int lastSize[2];
+  bool lastDragging;
+  bool lastRotate;
+  bool lastTurn;
+  bool lastShowMoves;
+  bool lastPromoting;
 };
 
-#endif  // PAINT_H_
\ No newline at end of file
+#endif  // PAINT_H_
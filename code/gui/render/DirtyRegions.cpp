@@ -0,0 +1,74 @@
+#include "./DirtyRegions.h"
+
+#include <algorithm>
+
+// Above this many separate rectangles, a redraw of the bounding box is cheaper than playing back the list per rectangle
+const int maxRects = 8;
+
+/**
+ * @brief Constructs an empty set of dirty regions.
+ */
+DirtyRegions::DirtyRegions() : full(false) {}
+
+DirtyRegions::~DirtyRegions() {}
+
+/**
+ * Marks a rectangle as changed. Overlapping rectangles are merged into their bounding box, and if too many rectangles
+ * are collected, all of them are merged into one.
+ *
+ * @param rect The changed rectangle.
+ */
+void DirtyRegions::add(RenderRect rect) {
+  if (full || rect.width <= 0 || rect.height <= 0) return;
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (int i = 0; i < rects.size(); i++) {
+      if (!rects[i].intersects(rect)) continue;
+      int x0 = std::min(rect.x, rects[i].x), y0 = std::min(rect.y, rects[i].y);
+      int x1 = std::max(rect.x + rect.width, rects[i].x + rects[i].width);
+      int y1 = std::max(rect.y + rect.height, rects[i].y + rects[i].height);
+      rect = {x0, y0, x1 - x0, y1 - y0};
+      rects.erase(rects.begin() + i);
+      merged = true;
+      break;
+    }
+  }
+  rects.push_back(rect);
+  if (rects.size() > maxRects) {
+    RenderRect bounds = rects[0];
+    rects.erase(rects.begin());
+    for (const RenderRect& r : rects) {
+      int x0 = std::min(bounds.x, r.x), y0 = std::min(bounds.y, r.y);
+      int x1 = std::max(bounds.x + bounds.width, r.x + r.width), y1 = std::max(bounds.y + bounds.height, r.y + r.height);
+      bounds = {x0, y0, x1 - x0, y1 - y0};
+    }
+    rects = {bounds};
+  }
+}
+
+/**
+ * Marks the whole window as changed.
+ */
+void DirtyRegions::addAll() {
+  full = true;
+  rects.clear();
+}
+
+/**
+ * Removes all dirty regions, after they have been handed to the window.
+ */
+void DirtyRegions::clear() {
+  full = false;
+  rects.clear();
+}
+
+/**
+ * @brief Getters of the DirtyRegions class.
+ *
+ * */
+bool DirtyRegions::isEmpty() { return !full && rects.empty(); }
+
+bool DirtyRegions::isFull() { return full; }
+
+const std::vector<RenderRect>& DirtyRegions::getRects() { return rects; }
@@ -0,0 +1,25 @@
+#ifndef DIRTYREGIONS_H_
+#define DIRTYREGIONS_H_
+
+#include <vector>
+
+#include "./RenderList.h"
+
+class DirtyRegions {
+ public:
+  DirtyRegions();
+  ~DirtyRegions();
+
+  void add(RenderRect rect);
+  void addAll();
+  void clear();
+  bool isEmpty();
+  bool isFull();
+  const std::vector<RenderRect>& getRects();
+
+ private:
+  std::vector<RenderRect> rects;
+  bool full;
+};
+
+#endif  // DIRTYREGIONS_H_
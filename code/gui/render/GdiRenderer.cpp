@@ -0,0 +1,108 @@
+#define UNICODE
+
+#include "./GdiRenderer.h"
+
+/**
+ * @brief Constructs a GdiRenderer without a target.
+ *
+ * GDI+ has to be started, before the renderer is constructed.
+ */
+GdiRenderer::GdiRenderer() : graphics(nullptr) {
+  fontFamily = new Gdiplus::FontFamily(L"Arial");
+  brush = new Gdiplus::SolidBrush(Gdiplus::Color(255, 255, 255, 255));
+  pen = new Gdiplus::Pen(Gdiplus::Color(255, 0, 0, 0));
+  stringFormat.SetAlignment(Gdiplus::StringAlignmentCenter);
+  stringFormat.SetLineAlignment(Gdiplus::StringAlignmentCenter);
+}
+
+/**
+ * @brief Destroys the GdiRenderer and releases all cached bitmaps and fonts.
+ */
+GdiRenderer::~GdiRenderer() {
+  for (auto& bitmap : bitmaps) delete bitmap.second;
+  for (auto& font : fonts) delete font.second;
+  delete fontFamily;
+  delete brush;
+  delete pen;
+}
+
+/**
+ * Sets the graphics object, on which the next render lists are played back.
+ *
+ * @param pGraphics A pointer to the Gdiplus::Graphics object to draw on.
+ */
+void GdiRenderer::setGraphics(Gdiplus::Graphics* pGraphics) { graphics = pGraphics; }
+
+/**
+ * Restricts the drawing on the current graphics object to the given rectangle.
+ *
+ * @param rect The rectangle to draw in, or nullptr to draw on the whole graphics object.
+ */
+void GdiRenderer::beginClip(const RenderRect* rect) {
+  if (graphics == nullptr) return;
+  if (rect == nullptr)
+    graphics->ResetClip();
+  else
+    graphics->SetClip(Gdiplus::Rect(rect->x, rect->y, rect->width, rect->height));
+}
+
+/**
+ * Draws a single command on the current graphics object.
+ *
+ * @param command The command to draw.
+ * @param data The image path or text of the command.
+ */
+void GdiRenderer::drawCommand(const RenderCommand& command, const wchar_t* data) {
+  if (graphics == nullptr) return;
+  Gdiplus::Color color(command.color.a, command.color.r, command.color.g, command.color.b);
+  Gdiplus::PointF pointF;
+  switch (command.type) {
+    case RenderCommand::FillRect:
+      brush->SetColor(color);
+      graphics->FillRectangle(brush, command.x, command.y, command.width, command.height);
+      break;
+    case RenderCommand::DrawRect:
+      pen->SetColor(color);
+      graphics->DrawRectangle(pen, command.x, command.y, command.width, command.height);
+      break;
+    case RenderCommand::Image:
+      graphics->DrawImage(getBitmap(std::wstring_view(data, command.dataLength)), command.x, command.y, command.width,
+                          command.height);
+      break;
+    case RenderCommand::Text:
+      brush->SetColor(color);
+      pointF.X = command.x;
+      pointF.Y = command.y;
+      graphics->DrawString(data, command.dataLength, getFont(command.fontSize), pointF, &stringFormat, brush);
+      break;
+  }
+}
+
+/**
+ * Returns the bitmap for the given path, which is only loaded from disk the first time it is requested.
+ *
+ * @param path The path of the image file.
+ * @return A pointer to the cached bitmap.
+ */
+Gdiplus::Bitmap* GdiRenderer::getBitmap(std::wstring_view path) {
+  auto it = bitmaps.find(path);
+  if (it != bitmaps.end()) return it->second;
+  std::wstring key(path);
+  Gdiplus::Bitmap* bmp = new Gdiplus::Bitmap(key.c_str());
+  bitmaps[key] = bmp;
+  return bmp;
+}
+
+/**
+ * Returns the Arial font with the given pixel size, which is only created the first time it is requested.
+ *
+ * @param size The font size in pixels.
+ * @return A pointer to the cached font.
+ */
+Gdiplus::Font* GdiRenderer::getFont(int size) {
+  auto it = fonts.find(size);
+  if (it != fonts.end()) return it->second;
+  Gdiplus::Font* font = new Gdiplus::Font(fontFamily, size, Gdiplus::FontStyleRegular, Gdiplus::UnitPixel);
+  fonts[size] = font;
+  return font;
+}
@@ -0,0 +1,39 @@
+#ifndef GDIRENDERER_H_
+#define GDIRENDERER_H_
+
+#include <Windows.h>
+#include <gdiplus.h>
+
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "./RenderList.h"
+
+class GdiRenderer : public Renderer {
+ public:
+  GdiRenderer();
+  GdiRenderer(const GdiRenderer&) = delete;
+  GdiRenderer& operator=(const GdiRenderer&) = delete;
+  ~GdiRenderer();
+
+  void setGraphics(Gdiplus::Graphics* pGraphics);
+
+ protected:
+  void beginClip(const RenderRect* rect) override;
+  void drawCommand(const RenderCommand& command, const wchar_t* data) override;
+
+ private:
+  Gdiplus::Bitmap* getBitmap(std::wstring_view path);
+  Gdiplus::Font* getFont(int size);
+
+  Gdiplus::Graphics* graphics;
+  Gdiplus::FontFamily* fontFamily;
+  Gdiplus::SolidBrush* brush;
+  Gdiplus::Pen* pen;
+  Gdiplus::StringFormat stringFormat;
+  std::map<std::wstring, Gdiplus::Bitmap*, std::less<>> bitmaps;
+  std::map<int, Gdiplus::Font*> fonts;
+};
+
+#endif  // GDIRENDERER_H_
@@ -0,0 +1,165 @@
+#include "./RenderList.h"
+
+#include "../../profiling/Trace.h"
+
+/**
+ * @brief Constructs an empty RenderList.
+ *
+ * The command vector and the text buffer keep their capacity between frames, so a list that is cleared and refilled
+ * every frame only allocates while it is still growing.
+ */
+RenderList::RenderList() {
+  commands.reserve(128);
+  texts.reserve(4096);
+}
+
+RenderList::~RenderList() {}
+
+/**
+ * Removes all commands from the list, while keeping the allocated storage.
+ */
+void RenderList::clear() {
+  commands.clear();
+  texts.clear();
+}
+
+/**
+ * Appends a filled rectangle to the list.
+ *
+ * @param x The x-coordinate of the upper left corner.
+ * @param y The y-coordinate of the upper left corner.
+ * @param pWidth The width of the rectangle.
+ * @param pHeight The height of the rectangle.
+ * @param color The fill color (alpha, red, green, blue).
+ */
+void RenderList::fillRect(int x, int y, int pWidth, int pHeight, RenderColor color) {
+  commands.push_back({RenderCommand::FillRect, x, y, pWidth, pHeight, 0, color, 0, 0});
+}
+
+/**
+ * Appends a one pixel wide rectangle outline to the list.
+ *
+ * @param x The x-coordinate of the upper left corner.
+ * @param y The y-coordinate of the upper left corner.
+ * @param pWidth The width of the rectangle.
+ * @param pHeight The height of the rectangle.
+ * @param color The outline color (alpha, red, green, blue).
+ */
+void RenderList::drawRect(int x, int y, int pWidth, int pHeight, RenderColor color) {
+  commands.push_back({RenderCommand::DrawRect, x, y, pWidth, pHeight, 0, color, 0, 0});
+}
+
+/**
+ * Appends an image, which is scaled into the given rectangle, to the list.
+ *
+ * @param path The path of the image file, relative to the working directory.
+ * @param x The x-coordinate of the upper left corner.
+ * @param y The y-coordinate of the upper left corner.
+ * @param pWidth The width, the image is scaled to.
+ * @param pHeight The height, the image is scaled to.
+ */
+void RenderList::drawImage(std::wstring_view path, int x, int y, int pWidth, int pHeight) {
+  int offset = addData(path);
+  commands.push_back({RenderCommand::Image, x, y, pWidth, pHeight, 0, {255, 255, 255, 255}, offset, (int)path.size()});
+}
+
+/**
+ * Appends a text to the list, which is centered horizontally and vertically around the given point.
+ *
+ * @param text The text to draw. Lines are separated by '\n'.
+ * @param x The x-coordinate of the center point.
+ * @param y The y-coordinate of the center point.
+ * @param fontSize The font size in pixels.
+ * @param color The text color (alpha, red, green, blue).
+ */
+void RenderList::drawText(std::wstring_view text, int x, int y, int fontSize, RenderColor color) {
+  int offset = addData(text);
+  commands.push_back({RenderCommand::Text, x, y, 0, 0, fontSize, color, offset, (int)text.size()});
+}
+
+/**
+ * Copies an image path or a text into the text buffer, followed by a terminating zero.
+ *
+ * @param data The characters to store.
+ * @return The offset of the first character in the text buffer.
+ */
+int RenderList::addData(std::wstring_view data) {
+  int offset = texts.size();
+  texts.append(data);
+  texts.push_back(L'\0');
+  return offset;
+}
+
+/**
+ * @brief Getters of the RenderList class.
+ *
+ * */
+const std::vector<RenderCommand>& RenderList::getCommands() const { return commands; }
+
+/**
+ * Returns the zero terminated image path or text of a command. The pointer stays valid until the list is changed.
+ *
+ * @param command A command of this list.
+ * @return The image path or text of the command, or an empty string for rectangles.
+ */
+const wchar_t* RenderList::getData(const RenderCommand& command) const { return texts.c_str() + command.dataOffset; }
+
+int RenderList::size() const { return commands.size(); }
+
+/**
+ * Checks if two rectangles overlap.
+ *
+ * @param other The rectangle to test against.
+ * @return True if the rectangles share at least one pixel, false otherwise.
+ */
+bool RenderRect::intersects(const RenderRect& other) const {
+  return x < other.x + other.width && other.x < x + width && y < other.y + other.height && other.y < y + height;
+}
+
+/**
+ * Checks if the command can touch any pixel inside the rectangle.
+ * Texts have no known extent, so they are always treated as visible and only clipped while drawing.
+ *
+ * @param rect The rectangle to test against.
+ * @return True if the command has to be drawn for the rectangle, false otherwise.
+ */
+bool RenderCommand::isVisibleIn(const RenderRect& rect) const {
+  if (type == Text) return true;
+  // Outlines are drawn one pixel past the right and bottom edge
+  int extra = type == DrawRect ? 1 : 0;
+  return RenderRect{x, y, width + extra, height + extra}.intersects(rect);
+}
+
+/**
+ * Plays back the render list. If clip rectangles are set, the list is played back once for every rectangle, and only
+ * the commands overlapping that rectangle are drawn, so the cost of a partial redraw scales with the changed area.
+ *
+ * @param list The render list to draw.
+ */
+void Renderer::render(const RenderList& list) {
+  TRACE_SCOPE("Renderer::render");
+  if (clip.empty()) {
+    beginClip(nullptr);
+    for (const RenderCommand& command : list.getCommands()) drawCommand(command, list.getData(command));
+    return;
+  }
+  for (const RenderRect& rect : clip) {
+    beginClip(&rect);
+    for (const RenderCommand& command : list.getCommands()) {
+      if (command.isVisibleIn(rect)) drawCommand(command, list.getData(command));
+    }
+  }
+  beginClip(nullptr);
+}
+
+/**
+ * Restricts the following render calls to the given rectangles.
+ *
+ * @param rects The rectangles to redraw. An empty vector redraws everything.
+ */
+void Renderer::setClip(const std::vector<RenderRect>& rects) { clip = rects; }
+
+/**
+ * Removes the clip rectangles, so the following render calls redraw everything.
+ */
+void Renderer::clearClip() { clip.clear(); }
@@ -0,0 +1,78 @@
+#ifndef RENDERLIST_H_
+#define RENDERLIST_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct RenderColor {
+  int a;
+  int r;
+  int g;
+  int b;
+};
+
+struct RenderRect {
+  int x;
+  int y;
+  int width;
+  int height;
+
+  bool intersects(const RenderRect& other) const;
+};
+
+struct RenderCommand {
+  enum Type { FillRect, DrawRect, Image, Text };
+
+  Type type;
+  int x;
+  int y;
+  int width;
+  int height;
+  int fontSize;
+  RenderColor color;
+  // Image path or text, stored in the text buffer of the list
+  int dataOffset;
+  int dataLength;
+
+  bool isVisibleIn(const RenderRect& rect) const;
+};
+
+class RenderList {
+ public:
+  RenderList();
+  ~RenderList();
+
+  void clear();
+  void fillRect(int x, int y, int pWidth, int pHeight, RenderColor color);
+  void drawRect(int x, int y, int pWidth, int pHeight, RenderColor color);
+  void drawImage(std::wstring_view path, int x, int y, int pWidth, int pHeight);
+  void drawText(std::wstring_view text, int x, int y, int fontSize, RenderColor color);
+  const std::vector<RenderCommand>& getCommands() const;
+  const wchar_t* getData(const RenderCommand& command) const;
+  int size() const;
+
+ private:
+  int addData(std::wstring_view data);
+
+  std::vector<RenderCommand> commands;
+  std::wstring texts;
+};
+
+class Renderer {
+ public:
+  virtual ~Renderer() {}
+
+  void render(const RenderList& list);
+  void setClip(const std::vector<RenderRect>& rects);
+  void clearClip();
+
+ protected:
+  virtual void beginClip(const RenderRect* rect) = 0;
+  virtual void drawCommand(const RenderCommand& command, const wchar_t* data) = 0;
+
+ private:
+  std::vector<RenderRect> clip;
+};
+
+#endif  // RENDERLIST_H_
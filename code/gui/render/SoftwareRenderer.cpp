@@ -0,0 +1,265 @@
+#include "./SoftwareRenderer.h"
+
+#include <png.h>
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+// 5x7 bitmap font for the headless text output. Lower case letters are drawn with the upper case glyphs.
+struct Glyph {
+  char character;
+  const char* rows[7];
+};
+
+static const Glyph font[] = {
+    {'0', {" ### ", "#   #", "#  ##", "# # #", "##  #", "#   #", " ### "}},
+    {'1', {"  #  ", " ##  ", "  #  ", "  #  ", "  #  ", "  #  ", " ### "}},
+    {'2', {" ### ", "#   #", "    #", "   # ", "  #  ", " #   ", "#####"}},
+    {'3', {"#####", "   # ", "  #  ", "   # ", "    #", "#   #", " ### "}},
+    {'4', {"   # ", "  ## ", " # # ", "#  # ", "#####", "   # ", "   # "}},
+    {'5', {"#####", "#    ", "#### ", "    #", "    #", "#   #", " ### "}},
+    {'6', {"  ## ", " #   ", "#    ", "#### ", "#   #", "#   #", " ### "}},
+    {'7', {"#####", "    #", "   # ", "  #  ", " #   ", " #   ", " #   "}},
+    {'8', {" ### ", "#   #", "#   #", " ### ", "#   #", "#   #", " ### "}},
+    {'9', {" ### ", "#   #", "#   #", " ####", "    #", "   # ", " ##  "}},
+    {':', {"     ", " ##  ", " ##  ", "     ", " ##  ", " ##  ", "     "}},
+    {'.', {"     ", "     ", "     ", "     ", "     ", " ##  ", " ##  "}},
+    {'!', {"  #  ", "  #  ", "  #  ", "  #  ", "  #  ", "     ", "  #  "}},
+    {'-', {"     ", "     ", "     ", "#####", "     ", "     ", "     "}},
+    {'A', {" ### ", "#   #", "#   #", "#####", "#   #", "#   #", "#   #"}},
+    {'B', {"#### ", "#   #", "#   #", "#### ", "#   #", "#   #", "#### "}},
+    {'C', {" ### ", "#   #", "#    ", "#    ", "#    ", "#   #", " ### "}},
+    {'D', {"#### ", "#   #", "#   #", "#   #", "#   #", "#   #", "#### "}},
+    {'E', {"#####", "#    ", "#    ", "#### ", "#    ", "#    ", "#####"}},
+    {'F', {"#####", "#    ", "#    ", "#### ", "#    ", "#    ", "#    "}},
+    {'G', {" ### ", "#   #", "#    ", "# ###", "#   #", "#   #", " ####"}},
+    {'H', {"#   #", "#   #", "#   #", "#####", "#   #", "#   #", "#   #"}},
+    {'I', {" ### ", "  #  ", "  #  ", "  #  ", "  #  ", "  #  ", " ### "}},
+    {'J', {"  ###", "   # ", "   # ", "   # ", "   # ", "#  # ", " ##  "}},
+    {'K', {"#   #", "#  # ", "# #  ", "##   ", "# #  ", "#  # ", "#   #"}},
+    {'L', {"#    ", "#    ", "#    ", "#    ", "#    ", "#    ", "#####"}},
+    {'M', {"#   #", "## ##", "# # #", "# # #", "#   #", "#   #", "#   #"}},
+    {'N', {"#   #", "#   #", "##  #", "# # #", "#  ##", "#   #", "#   #"}},
+    {'O', {" ### ", "#   #", "#   #", "#   #", "#   #", "#   #", " ### "}},
+    {'P', {"#### ", "#   #", "#   #", "#### ", "#    ", "#    ", "#    "}},
+    {'Q', {" ### ", "#   #", "#   #", "#   #", "# # #", "#  # ", " ## #"}},
+    {'R', {"#### ", "#   #", "#   #", "#### ", "# #  ", "#  # ", "#   #"}},
+    {'S', {" ####", "#    ", "#    ", " ### ", "    #", "    #", "#### "}},
+    {'T', {"#####", "  #  ", "  #  ", "  #  ", "  #  ", "  #  ", "  #  "}},
+    {'U', {"#   #", "#   #", "#   #", "#   #", "#   #", "#   #", " ### "}},
+    {'V', {"#   #", "#   #", "#   #", "#   #", "#   #", " # # ", "  #  "}},
+    {'W', {"#   #", "#   #", "#   #", "# # #", "# # #", "# # #", " # # "}},
+    {'X', {"#   #", "#   #", " # # ", "  #  ", " # # ", "#   #", "#   #"}},
+    {'Y', {"#   #", "#   #", " # # ", "  #  ", "  #  ", "  #  ", "  #  "}},
+    {'Z', {"#####", "    #", "   # ", "  #  ", " #   ", "#    ", "#####"}},
+};
+
+/**
+ * @brief Constructs a SoftwareRenderer with an opaque black RGBA buffer of the given size.
+ *
+ * @param pWidth The width of the buffer in pixels.
+ * @param pHeight The height of the buffer in pixels.
+ *
+ * @throws std::runtime_error if the width or height is not positive.
+ */
+SoftwareRenderer::SoftwareRenderer(int pWidth, int pHeight) : width(0), height(0) { resize(pWidth, pHeight); }
+
+SoftwareRenderer::~SoftwareRenderer() {}
+
+/**
+ * Resizes the buffer. The content of the buffer is reset to opaque black.
+ *
+ * @param pWidth The new width of the buffer in pixels.
+ * @param pHeight The new height of the buffer in pixels.
+ *
+ * @throws std::runtime_error if the width or height is not positive.
+ */
+void SoftwareRenderer::resize(int pWidth, int pHeight) {
+  if (pWidth <= 0 || pHeight <= 0) throw std::runtime_error("Width and height must be positive");
+  width = pWidth;
+  height = pHeight;
+  clipRect = {0, 0, width, height};
+  pixels.assign(width * height * 4, 0);
+  for (int i = 3; i < pixels.size(); i += 4) pixels[i] = 255;
+}
+
+/**
+ * Restricts the rasterization to the given rectangle.
+ *
+ * @param rect The rectangle to draw in, or nullptr to draw on the whole buffer.
+ */
+void SoftwareRenderer::beginClip(const RenderRect* rect) {
+  clipRect = {0, 0, width, height};
+  if (rect == nullptr) return;
+  int x0 = std::max(rect->x, 0), y0 = std::max(rect->y, 0);
+  int x1 = std::min(rect->x + rect->width, width), y1 = std::min(rect->y + rect->height, height);
+  clipRect = {x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)};
+}
+
+/**
+ * Rasterizes a single command into the buffer.
+ *
+ * @param command The command to draw.
+ * @param data The image path or text of the command.
+ */
+void SoftwareRenderer::drawCommand(const RenderCommand& command, const wchar_t* data) {
+  switch (command.type) {
+    case RenderCommand::FillRect:
+      fillRect(command.x, command.y, command.width, command.height, command.color);
+      break;
+    case RenderCommand::DrawRect:
+      drawRect(command.x, command.y, command.width, command.height, command.color);
+      break;
+    case RenderCommand::Image:
+      drawImage(getImage(std::wstring_view(data, command.dataLength)), command.x, command.y, command.width,
+                command.height);
+      break;
+    case RenderCommand::Text:
+      drawText(std::wstring_view(data, command.dataLength), command.x, command.y, command.fontSize, command.color);
+      break;
+  }
+}
+
+/**
+ * Writes the buffer as an 8-bit RGBA PNG file.
+ *
+ * @param path The path of the output file.
+ * @return True if the file was written successfully, false otherwise.
+ */
+bool SoftwareRenderer::savePng(const std::string& path) {
+  png_image image = {};
+  image.version = PNG_IMAGE_VERSION;
+  image.width = width;
+  image.height = height;
+  image.format = PNG_FORMAT_RGBA;
+  return png_image_write_to_file(&image, path.c_str(), 0, pixels.data(), 0, nullptr) != 0;
+}
+
+/**
+ * Returns the decoded image for the given path, which is only loaded from disk the first time it is requested.
+ * Images that cannot be loaded are cached as empty images and skipped when drawing.
+ *
+ * @param path The path of the image file.
+ * @return A pointer to the cached image.
+ */
+const RgbaImage* SoftwareRenderer::getImage(std::wstring_view path) {
+  auto it = images.find(path);
+  if (it != images.end()) return &it->second;
+
+  RgbaImage& result = images[std::wstring(path)];
+  result.width = 0;
+  result.height = 0;
+
+  png_image image = {};
+  image.version = PNG_IMAGE_VERSION;
+  if (png_image_begin_read_from_file(&image, std::string(path.begin(), path.end()).c_str()) == 0) return &result;
+  image.format = PNG_FORMAT_RGBA;
+  std::vector<uint8_t> buffer(PNG_IMAGE_SIZE(image));
+  if (png_image_finish_read(&image, nullptr, buffer.data(), 0, nullptr) == 0) {
+    png_image_free(&image);
+    return &result;
+  }
+  result.width = image.width;
+  result.height = image.height;
+  result.pixels = std::move(buffer);
+  return &result;
+}
+
+/**
+ * Blends a single pixel with the given color, using the colors alpha value.
+ *
+ * @param x The x-coordinate of the pixel.
+ * @param y The y-coordinate of the pixel.
+ * @param color The color to blend over the pixel.
+ */
+void SoftwareRenderer::blend(int x, int y, RenderColor color) {
+  if (x < clipRect.x || y < clipRect.y || x >= clipRect.x + clipRect.width || y >= clipRect.y + clipRect.height ||
+      color.a == 0)
+    return;
+  uint8_t* pixel = &pixels[(y * width + x) * 4];
+  pixel[0] = (color.r * color.a + pixel[0] * (255 - color.a)) / 255;
+  pixel[1] = (color.g * color.a + pixel[1] * (255 - color.a)) / 255;
+  pixel[2] = (color.b * color.a + pixel[2] * (255 - color.a)) / 255;
+}
+
+void SoftwareRenderer::fillRect(int x, int y, int pWidth, int pHeight, RenderColor color) {
+  int x0 = std::max(x, clipRect.x), y0 = std::max(y, clipRect.y);
+  int x1 = std::min(x + pWidth, clipRect.x + clipRect.width), y1 = std::min(y + pHeight, clipRect.y + clipRect.height);
+  for (int j = y0; j < y1; j++) {
+    for (int i = x0; i < x1; i++) blend(i, j, color);
+  }
+}
+
+void SoftwareRenderer::drawRect(int x, int y, int pWidth, int pHeight, RenderColor color) {
+  for (int i = x; i <= x + pWidth; i++) {
+    blend(i, y, color);
+    blend(i, y + pHeight, color);
+  }
+  for (int j = y + 1; j < y + pHeight; j++) {
+    blend(x, j, color);
+    blend(x + pWidth, j, color);
+  }
+}
+
+/**
+ * Draws an image scaled into the given rectangle, by sampling the nearest source pixel.
+ */
+void SoftwareRenderer::drawImage(const RgbaImage* image, int x, int y, int pWidth, int pHeight) {
+  if (image->width == 0 || pWidth <= 0 || pHeight <= 0) return;
+  int x0 = std::max(x, clipRect.x), y0 = std::max(y, clipRect.y);
+  int x1 = std::min(x + pWidth, clipRect.x + clipRect.width), y1 = std::min(y + pHeight, clipRect.y + clipRect.height);
+  for (int j = y0; j < y1; j++) {
+    const uint8_t* row = &image->pixels[((j - y) * image->height / pHeight) * image->width * 4];
+    for (int i = x0; i < x1; i++) {
+      const uint8_t* src = &row[((i - x) * image->width / pWidth) * 4];
+      blend(i, j, {src[3], src[0], src[1], src[2]});
+    }
+  }
+}
+
+/**
+ * Draws a text with the built in 5x7 font, centered around the given point.
+ * The font is scaled by whole pixels, so that a glyph cell is roughly as high as the requested font size.
+ */
+void SoftwareRenderer::drawText(std::wstring_view text, int x, int y, int fontSize, RenderColor color) {
+  int scale = std::max(1, fontSize / 8);
+  int lineHeight = 9 * scale;
+  int lines = 1;
+  for (wchar_t c : text) {
+    if (c == L'\n') lines++;
+  }
+
+  int top = y - lines * lineHeight / 2;
+  size_t start = 0;
+  for (int l = 0; l < lines; l++) {
+    size_t end = text.find(L'\n', start);
+    if (end == std::wstring_view::npos) end = text.size();
+    int left = x - (int)(end - start) * 6 * scale / 2;
+    for (int c = 0; c < (int)(end - start); c++) {
+      char character = toupper(static_cast<char>(text[start + c]));
+      const Glyph* glyph = nullptr;
+      for (const Glyph& g : font) {
+        if (g.character == character) glyph = &g;
+      }
+      if (glyph == nullptr) continue;
+      for (int row = 0; row < 7; row++) {
+        for (int col = 0; col < 5; col++) {
+          if (glyph->rows[row][col] == ' ') continue;
+          fillRect(left + (c * 6 + col) * scale, top + l * lineHeight + row * scale, scale, scale, color);
+        }
+      }
+    }
+    start = end + 1;
+  }
+}
+
+/**
+ * @brief Getters of the SoftwareRenderer class.
+ *
+ * */
+const std::vector<uint8_t>& SoftwareRenderer::getPixels() const { return pixels; }
+
+int SoftwareRenderer::getWidth() const { return width; }
+
+int SoftwareRenderer::getHeight() const { return height; }
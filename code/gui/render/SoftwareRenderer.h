@@ -0,0 +1,48 @@
+#ifndef SOFTWARERENDERER_H_
+#define SOFTWARERENDERER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "./RenderList.h"
+
+struct RgbaImage {
+  int width;
+  int height;
+  std::vector<uint8_t> pixels;
+};
+
+class SoftwareRenderer : public Renderer {
+ public:
+  SoftwareRenderer(int pWidth, int pHeight);
+  ~SoftwareRenderer();
+
+  void resize(int pWidth, int pHeight);
+  bool savePng(const std::string& path);
+  const std::vector<uint8_t>& getPixels() const;
+  int getWidth() const;
+  int getHeight() const;
+
+ protected:
+  void beginClip(const RenderRect* rect) override;
+  void drawCommand(const RenderCommand& command, const wchar_t* data) override;
+
+ private:
+  const RgbaImage* getImage(std::wstring_view path);
+  void blend(int x, int y, RenderColor color);
+  void fillRect(int x, int y, int pWidth, int pHeight, RenderColor color);
+  void drawRect(int x, int y, int pWidth, int pHeight, RenderColor color);
+  void drawImage(const RgbaImage* image, int x, int y, int pWidth, int pHeight);
+  void drawText(std::wstring_view text, int x, int y, int fontSize, RenderColor color);
+
+  std::vector<uint8_t> pixels;
+  std::map<std::wstring, RgbaImage, std::less<>> images;
+  RenderRect clipRect;
+  int width;
+  int height;
+};
+
+#endif  // SOFTWARERENDERER_H_
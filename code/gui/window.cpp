@@ -2,58 +2,110 @@
 
 #include "./window.h"
 
+#include "../profiling/Trace.h"
+
 int mouseCoords[2];
 Paint* wPaint;
 Input* wInput;
+RenderList* wFrame;
+GdiRenderer* wRenderer;
+DirtyRegions* wDirty;
+HDC hdcBack;
+HBITMAP hbmBack;
+HBITMAP hbmBackOld;
+int backSize[2];
 bool clicked;
 HWND mainWindow;
 HWND hEdit;
 HMENU hMenu;
+std::vector<RenderRect> Window::clip;
+std::vector<char> Window::regionData;
 
 /**
  * @brief This function is responsible for performing the drawing procedure on the specified window.
  *
+ * The frame is drawn into a persistent back buffer, which is only recreated if the size of the window changes. Only
+ * the invalidated parts of the window are redrawn in the back buffer and copied onto the window, the rest of the back
+ * buffer still holds the content of the previous frames.
+ *
  * @param hWnd The handle to the window on which the drawing procedure is performed.
  * @param lpPS A pointer to a PAINTSTRUCT structure that contains information about the painting request.
  */
 void Window::DrawingProcedure(HWND hWnd, LPPAINTSTRUCT lpPS) {
+  TRACE_SCOPE("Window::DrawingProcedure");
   RECT rc;
-  HDC hdcMem;
-  HBITMAP hbmMem, hbmOld;
+  clip.clear();
+
+  // Collect the invalidated rectangles, before BeginPaint validates them
+  HRGN region = CreateRectRgn(0, 0, 0, 0);
+  if (GetUpdateRgn(hWnd, region, FALSE) == COMPLEXREGION) {
+    regionData.resize(GetRegionData(region, 0, NULL));
+    RGNDATA* data = reinterpret_cast<RGNDATA*>(regionData.data());
+    GetRegionData(region, regionData.size(), data);
+    RECT* rects = reinterpret_cast<RECT*>(data->Buffer);
+    for (DWORD i = 0; i < data->rdh.nCount; i++)
+      clip.push_back({rects[i].left, rects[i].top, rects[i].right - rects[i].left, rects[i].bottom - rects[i].top});
+  }
+  DeleteObject(region);
 
   BeginPaint(hWnd, lpPS);
 
   GetClientRect(hWnd, &rc);
+  if (clip.empty())
+    clip.push_back({lpPS->rcPaint.left, lpPS->rcPaint.top, lpPS->rcPaint.right - lpPS->rcPaint.left,
+                    lpPS->rcPaint.bottom - lpPS->rcPaint.top});
+
+  // Create the back buffer once, or again if the window was resized, and redraw it completely
+  if (hdcBack == NULL || backSize[0] != rc.right - rc.left || backSize[1] != rc.bottom - rc.top) {
+    if (hdcBack != NULL) {
+      SelectObject(hdcBack, hbmBackOld);
+      DeleteObject(hbmBack);
+      DeleteDC(hdcBack);
+    }
+    backSize[0] = rc.right - rc.left;
+    backSize[1] = rc.bottom - rc.top;
+    hdcBack = CreateCompatibleDC(lpPS->hdc);
+    hbmBack = CreateCompatibleBitmap(lpPS->hdc, backSize[0], backSize[1]);
+    hbmBackOld = (HBITMAP)SelectObject(hdcBack, hbmBack);
+    clip.clear();
+  }
 
-  // Create an identical copy of the window's device context
-  hdcMem = CreateCompatibleDC(lpPS->hdc);
-
-  hbmMem = CreateCompatibleBitmap(lpPS->hdc, rc.right - rc.left, rc.bottom - rc.top);
-
-  hbmOld = (HBITMAP)SelectObject(hdcMem, hbmMem);
-
-  Gdiplus::Graphics graphics(hdcMem);
-
-  // Draw all the windows components
-  wPaint->drawBgd(&graphics);
-  wPaint->drawBoard(&graphics);
-  wPaint->drawMoveOptions(&graphics);
-  wPaint->drawPieces(&graphics);
-  wPaint->drawButtons(&graphics);
-  wPaint->drawPromotionMenu(&graphics);
-  wPaint->drawTimer(&graphics);
-  wPaint->drawEndingScreen(&graphics);
-  if (clicked) wPaint->drawDraggedPiece(&graphics, mouseCoords[0], mouseCoords[1]);
+  Gdiplus::Graphics graphics(hdcBack);
 
-  BitBlt(lpPS->hdc, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top, hdcMem, 0, 0, SRCCOPY);
+  // Record all the windows components and play the invalidated parts back through GDI+
+  wPaint->drawFrame(wFrame, clicked, mouseCoords[0], mouseCoords[1]);
+  wRenderer->setGraphics(&graphics);
+  wRenderer->setClip(clip);
+  wRenderer->render(*wFrame);
+  wRenderer->clearClip();
+  wRenderer->setGraphics(nullptr);
 
-  SelectObject(hdcMem, hbmOld);
-  DeleteObject(hbmMem);
-  DeleteDC(hdcMem);
+  if (clip.empty()) clip.push_back({rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top});
+  for (const RenderRect& rect : clip) {
+    BitBlt(lpPS->hdc, rect.x, rect.y, rect.width, rect.height, hdcBack, rect.x, rect.y, SRCCOPY);
+  }
 
   EndPaint(hWnd, lpPS);
 }
 
+/**
+ * @brief Invalidates only the regions of the window, whose content changed since the last call.
+ *
+ * @param hWnd The handle to the window.
+ */
+void Window::invalidateChanges(HWND hWnd) {
+  wPaint->collectDirtyRegions(wDirty, clicked, mouseCoords[0], mouseCoords[1]);
+  if (wDirty->isFull()) {
+    InvalidateRect(hWnd, NULL, FALSE);
+  } else {
+    for (const RenderRect& rect : wDirty->getRects()) {
+      RECT rc = {rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+      InvalidateRect(hWnd, &rc, FALSE);
+    }
+  }
+  wDirty->clear();
+}
+
 /**
  * @brief The return type of the window procedure callback function.
  *
@@ -89,8 +141,9 @@ LRESULT CALLBACK Window::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM
           break;
         case 4:
           DestroyWindow(hwnd);
-          break;
+          return 0;
       }
+      invalidateChanges(hwnd);
       return 0;
     case WM_MOUSEMOVE:
       if (!clicked) {
@@ -98,11 +151,14 @@ LRESULT CALLBACK Window::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM
       } else {
         mouseCoords[0] = GET_X_LPARAM(lParam);
         mouseCoords[1] = GET_Y_LPARAM(lParam);
-        InvalidateRect(hwnd, NULL, TRUE);
+        invalidateChanges(hwnd);
       }
       return 0;
+    case WM_REDRAW:
+      invalidateChanges(hwnd);
+      return 0;
     case WM_ACTIVATE:
-      InvalidateRect(hwnd, NULL, TRUE);
+      InvalidateRect(hwnd, NULL, FALSE);
       return 0;
     case WM_CREATE:
       AddMenus(hwnd);
@@ -112,12 +168,12 @@ LRESULT CALLBACK Window::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM
       wInput->handleMouseDown(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
       mouseCoords[0] = GET_X_LPARAM(lParam);
       mouseCoords[1] = GET_Y_LPARAM(lParam);
-      InvalidateRect(hwnd, NULL, TRUE);
+      invalidateChanges(hwnd);
       return 0;
     case WM_LBUTTONUP:
       clicked = false;
       wInput->handleMouseUp(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
-      InvalidateRect(hwnd, NULL, TRUE);
+      invalidateChanges(hwnd);
       return 0;
     case WM_PAINT:
       DrawingProcedure(hwnd, &ps);
@@ -146,6 +202,10 @@ Window::Window(Board* mBoard) : h_hInstance(GetModuleHandle(nullptr)) {
   // Initializing GDI+
   Gdiplus::GdiplusStartupInput gdiplusStartupInput;
   Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, nullptr);
+  wFrame = new RenderList();
+  wRenderer = new GdiRenderer();
+  wDirty = new DirtyRegions();
+  hdcBack = NULL;
 
   // Initializing window class
   WNDCLASS wndClass = {};
@@ -203,6 +263,14 @@ Window::~Window() {
 
   // Clean up resources
   DestroyMenu(hMenu);
+  if (hdcBack != NULL) {
+    SelectObject(hdcBack, hbmBackOld);
+    DeleteObject(hbmBack);
+    DeleteDC(hdcBack);
+  }
+  delete wDirty;
+  delete wRenderer;
+  delete wFrame;
   delete wPaint;
   delete paint;
 }
@@ -334,6 +402,8 @@ bool Window::ProcessMessages() {
 
   while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
     if (msg.message == WM_QUIT) {
+      delete wRenderer;
+      wRenderer = nullptr;
       Gdiplus::GdiplusShutdown(gdiplusToken);
       return false;
     }
@@ -358,4 +428,4 @@ Paint* Window::getPaint() { return paint; }
  *
  * @return The handle to the window.
  */
-HWND Window::getHWnd() { return h_hWnd; }
\ No newline at end of file
+HWND Window::getHWnd() { return h_hWnd; }
\ No newline at end of file
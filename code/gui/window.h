@@ -10,6 +10,10 @@
 
 #include "../input/Input.h"
 #include "./Paint.h"
+#include "./render/GdiRenderer.h"
+
+// Posted by other threads, to request a redraw of the changed parts of the window
+#define WM_REDRAW (WM_APP + 1)
 
 class Window {
  public:
@@ -21,6 +25,7 @@ class Window {
   static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
   static LRESULT CALLBACK DialogProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
   static void DrawingProcedure(HWND hWnd, LPPAINTSTRUCT lpPS);
+  static void invalidateChanges(HWND hWnd);
   static void displayDialog(HWND hWnd);
   static void AddControls(HWND hDlg);
   static void AddMenus(HWND hWnd);
@@ -37,6 +42,9 @@ class Window {
   Input* input;
   int width;
   int height;
+  // Invalidated rectangles and region data of the last paint, kept, so a paint does not allocate
+  static std::vector<RenderRect> clip;
+  static std::vector<char> regionData;
 };
 
-#endif  // WINDOW_H_
\ No newline at end of file
+#endif  // WINDOW_H_
\ No newline at end of file
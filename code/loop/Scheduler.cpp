@@ -0,0 +1,67 @@
+#include "./Scheduler.h"
+
+#include <chrono>
+#include <cmath>
+
+/**
+ * @brief Constructs a Scheduler without a redraw hook.
+ */
+Scheduler::Scheduler() : notified(false) {}
+
+Scheduler::~Scheduler() {}
+
+/**
+ * Signals a change of the game state, like a move, an undo or the end of the game.
+ * A thread, which is blocked in waitFor, wakes up immediately. The notification is kept, if no thread is waiting.
+ */
+void Scheduler::notify() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    notified = true;
+  }
+  condition.notify_all();
+}
+
+/**
+ * Blocks until the next notification or until the timeout expires, whichever comes first.
+ *
+ * @param seconds The maximum time to wait, in seconds.
+ * @return True if the thread was woken up by a notification, false if the timeout expired.
+ */
+bool Scheduler::waitFor(double seconds) {
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait_for(lock, std::chrono::duration<double>(seconds), [this] { return notified; });
+  bool result = notified;
+  notified = false;
+  return result;
+}
+
+/**
+ * Asks the UI thread to redraw the changed parts of the window, by calling the redraw hook.
+ * This is safe to call from any thread, as long as the hook itself is.
+ */
+void Scheduler::requestRedraw() {
+  if (redrawHook) redrawHook();
+}
+
+/**
+ * Sets the function, which wakes up the UI thread for a redraw.
+ *
+ * @param hook The function to call on every redraw request.
+ */
+void Scheduler::setRedrawHook(std::function<void()> hook) { redrawHook = hook; }
+
+/**
+ * Calculates the time until the displayed tenth of a second of a running clock changes.
+ *
+ * @param remaining The remaining time on the running clock, in seconds.
+ * @return The time until the clock reaches the next lower tenth of a second, in seconds. Never more than 0.1 and never
+ * more than the remaining time.
+ */
+double Scheduler::untilNextTenth(double remaining) {
+  if (remaining <= 0.0) return 0.0;
+  double tenths = remaining * 10;
+  // A clock, which is exactly on a boundary, has a whole tenth until the next one
+  double boundary = std::ceil(tenths - 1e-6) - 1;
+  return std::fmin((tenths - boundary) / 10, remaining);
+}
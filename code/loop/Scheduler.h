@@ -0,0 +1,28 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+class Scheduler {
+ public:
+  Scheduler();
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+  ~Scheduler();
+
+  void notify();
+  bool waitFor(double seconds);
+  void requestRedraw();
+  void setRedrawHook(std::function<void()> hook);
+  static double untilNextTenth(double remaining);
+
+ private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::function<void()> redrawHook;
+  bool notified;
+};
+
+#endif  // SCHEDULER_H_
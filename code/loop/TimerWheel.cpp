@@ -0,0 +1,221 @@
+#include "./TimerWheel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+/**
+ * @brief Constructs a TimerWheel and starts its thread.
+ *
+ * @param pTickSeconds The length of a tick in seconds, the timers fire at the end of the tick of their expiry.
+ */
+TimerWheel::TimerWheel(double pTickSeconds)
+    : origin(std::chrono::steady_clock::now()),
+      tick(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(std::max(pTickSeconds, 1e-6)))),
+      occupied{0},
+      current(0),
+      wakeTick(0),
+      count(0),
+      stopping(false) {
+  std::fill(heads, heads + levels * slots, -1);
+  thread = std::thread(&TimerWheel::run, this);
+}
+
+/**
+ * @brief Stops the thread. Timers, which did not fire yet, are dropped.
+ */
+TimerWheel::~TimerWheel() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  changed.notify_all();
+  thread.join();
+}
+
+/**
+ * Starts a timer.
+ *
+ * @param seconds The time from now, until the callback is called.
+ * @param callback Called once on the thread of the wheel. It must not wait for a thread, which schedules or cancels
+ * timers of this wheel.
+ * @return The id of the timer for cancel, never 0.
+ */
+uint64_t TimerWheel::schedule(double seconds, std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(mutex);
+  // An empty wheel has nothing to move down the levels, so it skips the ticks, which passed since its last timer
+  if (count == 0) current = std::max(current, getTick());
+  int index;
+  if (spare.empty()) {
+    index = timers.size();
+    timers.push_back({-1, -1, levels * slots, 1, 0, nullptr});
+  } else {
+    index = spare.back();
+    spare.pop_back();
+  }
+  Timer& timer = timers[index];
+  // The first tick, which starts at or after the expiry, so a timer never fires early
+  auto expiry = std::chrono::steady_clock::now() - origin + std::chrono::duration<double>(std::max(seconds, 0.0));
+  double ticks = expiry / std::chrono::duration<double>(tick);
+  timer.expiry = std::max(current + 1, (uint64_t)std::ceil(std::min(ticks, 1e15)));
+  timer.callback = std::move(callback);
+  place(index);
+  count++;
+  if (timer.expiry < wakeTick) changed.notify_one();
+  return (uint64_t)timer.generation << 32 | index;
+}
+
+/**
+ * Stops a timer, before it fires. A callback, which is already due, may still run, while cancel returns.
+ *
+ * @param id The id of schedule.
+ * @return True if the timer was stopped, false if it fired or was cancelled before.
+ */
+bool TimerWheel::cancel(uint64_t id) {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t index = id & 0xFFFFFFFF;
+  if (index >= timers.size() || timers[index].generation != id >> 32 || timers[index].slot == levels * slots)
+    return false;
+  unlink(index);
+  release(index);
+  return true;
+}
+
+/**
+ * @brief Getters of the TimerWheel class. The count is the number of timers, which did not fire yet.
+ *
+ * */
+int TimerWheel::getCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return count;
+}
+
+/**
+ * Returns the number of ticks since the construction.
+ */
+uint64_t TimerWheel::getTick() { return (std::chrono::steady_clock::now() - origin) / tick; }
+
+/**
+ * Puts a timer into the slot of its expiry: the lowest level, where the higher bits of the expiry and the current tick
+ * are equal. Expiries beyond the highest level wait in it and are placed again, when it wraps around.
+ */
+void TimerWheel::place(int index) {
+  Timer& timer = timers[index];
+  uint64_t expiry = std::min(timer.expiry, current + ((uint64_t)1 << (levels * slotBits)) - 1);
+  int level = 0;
+  while (level < levels - 1 && expiry >> (slotBits * (level + 1)) != current >> (slotBits * (level + 1))) level++;
+  int position = (expiry >> (slotBits * level)) & (slots - 1);
+  timer.slot = level * slots + position;
+  timer.previous = -1;
+  timer.next = heads[timer.slot];
+  if (timer.next >= 0) timers[timer.next].previous = index;
+  heads[timer.slot] = index;
+  occupied[level] |= (uint64_t)1 << position;
+}
+
+/**
+ * Removes a timer from the list of its slot.
+ */
+void TimerWheel::unlink(int index) {
+  Timer& timer = timers[index];
+  if (timer.previous >= 0) {
+    timers[timer.previous].next = timer.next;
+  } else {
+    heads[timer.slot] = timer.next;
+  }
+  if (timer.next >= 0) timers[timer.next].previous = timer.previous;
+  if (heads[timer.slot] < 0) occupied[timer.slot / slots] &= ~((uint64_t)1 << (timer.slot % slots));
+  timer.slot = levels * slots;
+}
+
+/**
+ * Gives an unlinked timer back to the pool. The new generation makes the old id invalid.
+ */
+void TimerWheel::release(int index) {
+  timers[index].callback = nullptr;
+  timers[index].generation++;
+  spare.push_back(index);
+  count--;
+}
+
+/**
+ * Advances the wheel tick by tick up to a tick. With every tick, the levels, which wrap around, move their next slot
+ * down, and the timers of the slot of the tick in the first level are due.
+ *
+ * @param target The tick to advance to.
+ * @param due Receives the callbacks of the due timers.
+ */
+void TimerWheel::advance(uint64_t target, std::vector<std::function<void()>>* due) {
+  while (current < target) {
+    if (count == 0) {
+      current = target;
+      return;
+    }
+    // Without timers in the rest of the first level, the ticks up to the next wrap around have nothing to do
+    uint64_t position = current & (slots - 1);
+    if ((occupied[0] & ~(((uint64_t)2 << position) - 1)) == 0) current = std::min(target - 1, current | (slots - 1));
+    current++;
+
+    int level = 0;
+    while (level < levels - 1 && (current & (((uint64_t)1 << (slotBits * (level + 1))) - 1)) == 0) level++;
+    for (; level > 0; level--) {
+      int slot = level * slots + ((current >> (slotBits * level)) & (slots - 1));
+      int index = heads[slot];
+      heads[slot] = -1;
+      occupied[level] &= ~((uint64_t)1 << (slot % slots));
+      while (index >= 0) {
+        int next = timers[index].next;
+        place(index);
+        index = next;
+      }
+    }
+
+    int slot = current & (slots - 1);
+    while (heads[slot] >= 0) {
+      int index = heads[slot];
+      unlink(index);
+      due->push_back(std::move(timers[index].callback));
+      release(index);
+    }
+  }
+}
+
+/**
+ * Returns the next tick, which has to be advanced to: the next occupied slot of the first level, or the wrap around
+ * of the first level, if its other slots are empty.
+ */
+uint64_t TimerWheel::getNextTick() {
+  if (count == 0) return UINT64_MAX;
+  uint64_t position = current & (slots - 1);
+  uint64_t later = occupied[0] & ~(((uint64_t)2 << position) - 1);
+  if (later != 0) return (current & ~(uint64_t)(slots - 1)) + __builtin_ctzll(later);
+  return (current | (slots - 1)) + 1;
+}
+
+/**
+ * Fires the due timers and sleeps until the next tick, which has to be advanced to, or until an earlier timer is
+ * scheduled.
+ */
+void TimerWheel::run() {
+  std::vector<std::function<void()>> due;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopping) {
+    advance(getTick(), &due);
+    if (!due.empty()) {
+      lock.unlock();
+      for (auto& callback : due) callback();
+      due.clear();
+      lock.lock();
+      continue;
+    }
+    wakeTick = getNextTick();
+    if (wakeTick == UINT64_MAX) {
+      changed.wait(lock);
+    } else {
+      changed.wait_until(lock, origin + tick * wakeTick);
+    }
+    // Timers, which are scheduled while the thread is awake, are seen by the next advance
+    wakeTick = 0;
+  }
+}
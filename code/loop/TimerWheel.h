@@ -0,0 +1,71 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hashed hierarchical timer wheel, which runs the callbacks of many timers, like the flag falls of the clocks of many
+// games, on one thread. Time is counted in ticks, written as digits of 6 bits. Every level has 64 slots, one for every
+// value of its digit: a slot of the first level is one tick, a slot of every further level spans all slots of the
+// level below. A timer is put into the level of the highest digit, in which its expiry differs from the current tick,
+// and moves down, when the levels below wrap around, until it fires in the first level. Scheduling and cancelling a
+// timer is constant time: the timers of a slot are a doubly linked list in a pool, and an id names a timer of the pool
+// with its generation, which starts at 1, so an old id never cancels a reused timer and 0 is never an id. The thread
+// sleeps until the next occupied slot of the first level, or until the first level wraps around.
+class TimerWheel {
+ public:
+  explicit TimerWheel(double pTickSeconds = 0.001);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  ~TimerWheel();
+
+  uint64_t schedule(double seconds, std::function<void()> callback);
+  bool cancel(uint64_t id);
+  int getCount();
+
+ private:
+  static constexpr int levels = 5;
+  static constexpr int slotBits = 6;
+  static constexpr int slots = 1 << slotBits;
+
+  struct Timer {
+    int previous;
+    int next;
+    // Slot of the timer, levels * slots if it is not scheduled
+    int slot;
+    uint32_t generation;
+    uint64_t expiry;
+    std::function<void()> callback;
+  };
+
+  uint64_t getTick();
+  void place(int index);
+  void unlink(int index);
+  void release(int index);
+  void advance(uint64_t target, std::vector<std::function<void()>>* due);
+  uint64_t getNextTick();
+  void run();
+
+  std::chrono::steady_clock::time_point origin;
+  std::chrono::steady_clock::duration tick;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<Timer> timers;
+  std::vector<int> spare;
+  // First timer of every slot, -1 for an empty slot, and the occupied slots of every level as bits
+  int heads[levels * slots];
+  uint64_t occupied[levels];
+  uint64_t current;
+  // Tick, until which the thread sleeps
+  uint64_t wakeTick;
+  int count;
+  bool stopping;
+  std::thread thread;
+};
+
+#endif  // TIMERWHEEL_H_
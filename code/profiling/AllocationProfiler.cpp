@@ -0,0 +1,170 @@
+#include "./AllocationProfiler.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+static std::atomic<unsigned long long> totalAllocations(0);
+static std::atomic<unsigned long long> totalBytes(0);
+static std::atomic<unsigned long long> totalFrees(0);
+
+// Registered regions, newest first
+static std::atomic<AllocationRegion*> regions(nullptr);
+static std::atomic<int> regionCount(0);
+
+// Regions, which are active on the current thread. Plain arrays, so the hooks need no initialization of their own.
+static constexpr int maxDepth = 16;
+static thread_local AllocationRegion* activeRegions[maxDepth];
+static thread_local int activeDepth = 0;
+
+#ifdef ENABLE_ALLOCATION_PROFILING
+void* operator new(std::size_t size) {
+  AllocationProfiler::count(size);
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr) throw std::bad_alloc();
+  return pointer;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* pointer) noexcept {
+  if (pointer != nullptr) AllocationProfiler::countFree();
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept { operator delete(pointer); }
+
+void operator delete[](void* pointer, std::size_t) noexcept { operator delete(pointer); }
+#endif
+
+/**
+ * @brief Constructs a region and adds it to the list of all regions.
+ *
+ * @param pName The name of the region, a string literal.
+ */
+AllocationRegion::AllocationRegion(const char* pName) : name(pName), allocations(0), bytes(0) {
+  index = regionCount.fetch_add(1);
+  next = regions.load();
+  while (!regions.compare_exchange_weak(next, this)) {
+  }
+}
+
+/**
+ * @brief Activates a region on the current thread. Scopes nested deeper than the supported depth are ignored.
+ *
+ * @param region The region to activate.
+ */
+AllocationScope::AllocationScope(AllocationRegion* region) : active(activeDepth < maxDepth) {
+  if (active) activeRegions[activeDepth] = region;
+  activeDepth++;
+}
+
+AllocationScope::~AllocationScope() { activeDepth--; }
+
+/**
+ * Counts an allocation for the totals and for every region, which is active on the current thread.
+ *
+ * @param size The size of the allocation in bytes.
+ */
+void AllocationProfiler::count(std::size_t size) {
+  totalAllocations.fetch_add(1, std::memory_order_relaxed);
+  totalBytes.fetch_add(size, std::memory_order_relaxed);
+  int depth = activeDepth < maxDepth ? activeDepth : maxDepth;
+  for (int i = 0; i < depth; i++) {
+    activeRegions[i]->allocations.fetch_add(1, std::memory_order_relaxed);
+    activeRegions[i]->bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * Counts a freed allocation.
+ */
+void AllocationProfiler::countFree() { totalFrees.fetch_add(1, std::memory_order_relaxed); }
+
+/**
+ * Reads the counts of all regions, indexed by the order of their registration.
+ *
+ * @param allocations Receives the number of allocations of every region.
+ * @param bytes Receives the allocated bytes of every region.
+ */
+void AllocationProfiler::readRegions(unsigned long long allocations[maxRegions], unsigned long long bytes[maxRegions]) {
+  for (int i = 0; i < maxRegions; i++) allocations[i] = bytes[i] = 0;
+  for (AllocationRegion* region = regions.load(); region != nullptr; region = region->next) {
+    if (region->index >= maxRegions) continue;
+    allocations[region->index] = region->allocations.load(std::memory_order_relaxed);
+    bytes[region->index] = region->bytes.load(std::memory_order_relaxed);
+  }
+}
+
+/**
+ * Prints the totals and the counts of every region, regions with the same name are added up.
+ *
+ * @param out The stream to print to.
+ */
+void AllocationProfiler::print(std::ostream& out) {
+  char line[256];
+  snprintf(line, sizeof(line), "%-20s %14s %16s\n", "region", "allocations", "bytes");
+  out << line;
+  snprintf(line, sizeof(line), "%-20s %14llu %16llu\n", "total", getAllocations(), getBytes());
+  out << line;
+  for (AllocationRegion* region = regions.load(); region != nullptr; region = region->next) {
+    // Only print a name at its first region in the list, with the counts of all regions of that name
+    bool printed = false;
+    for (AllocationRegion* other = regions.load(); other != region; other = other->next) {
+      if (std::string(other->name) == region->name) printed = true;
+    }
+    if (printed) continue;
+    unsigned long long allocations = 0, bytes = 0;
+    for (AllocationRegion* other = region; other != nullptr; other = other->next) {
+      if (std::string(other->name) != region->name) continue;
+      allocations += other->allocations.load(std::memory_order_relaxed);
+      bytes += other->bytes.load(std::memory_order_relaxed);
+    }
+    snprintf(line, sizeof(line), "%-20s %14llu %16llu\n", region->name, allocations, bytes);
+    out << line;
+  }
+  out.flush();
+}
+
+/**
+ * Writes the report of print into a file.
+ *
+ * @param path The path of the report file.
+ * @return True if the file was written, false otherwise.
+ */
+bool AllocationProfiler::writeReport(const std::string& path) {
+  std::ofstream file(path);
+  if (!file) return false;
+  print(file);
+  return file.good();
+}
+
+/**
+ * @brief Getters of the AllocationProfiler class.
+ *
+ * */
+bool AllocationProfiler::isEnabled() {
+#ifdef ENABLE_ALLOCATION_PROFILING
+  return true;
+#else
+  return false;
+#endif
+}
+
+unsigned long long AllocationProfiler::getAllocations() { return totalAllocations.load(std::memory_order_relaxed); }
+
+unsigned long long AllocationProfiler::getBytes() { return totalBytes.load(std::memory_order_relaxed); }
+
+unsigned long long AllocationProfiler::getFrees() { return totalFrees.load(std::memory_order_relaxed); }
+
+int AllocationProfiler::getRegionCount() { return regionCount.load() < maxRegions ? regionCount.load() : maxRegions; }
+
+const char* AllocationProfiler::getRegionName(int index) {
+  for (AllocationRegion* region = regions.load(); region != nullptr; region = region->next) {
+    if (region->index == index) return region->name;
+  }
+  return "";
+}
@@ -0,0 +1,64 @@
+#ifndef ALLOCATIONPROFILER_H_
+#define ALLOCATIONPROFILER_H_
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+// The allocation profiler is compiled in with -DENABLE_ALLOCATION_PROFILING (make flags=-DENABLE_ALLOCATION_PROFILING,
+// always on for the benchmarks). It replaces the global operator new and delete with counting versions and attributes
+// every allocation to the regions, which are active on the allocating thread. Otherwise the macros expand to nothing.
+#ifdef ENABLE_ALLOCATION_PROFILING
+#define ALLOCATION_CONCAT_(a, b) a##b
+#define ALLOCATION_CONCAT(a, b) ALLOCATION_CONCAT_(a, b)
+#define ALLOCATION_SCOPE(name)                                                         \
+  static AllocationRegion ALLOCATION_CONCAT(allocationRegion, __LINE__)(name);         \
+  AllocationScope ALLOCATION_CONCAT(allocationScope, __LINE__)(&ALLOCATION_CONCAT(allocationRegion, __LINE__))
+#define ALLOCATION_DUMP(path) AllocationProfiler::writeReport(path)
+#else
+#define ALLOCATION_SCOPE(name)
+#define ALLOCATION_DUMP(path)
+#endif
+
+// Allocations made while a scope of the region was active. Regions register themselves in a list, which needs no heap
+// memory, so they can be created from inside the allocation hooks. Several regions may share a name, their counts are
+// added up in the reports.
+struct AllocationRegion {
+  explicit AllocationRegion(const char* pName);
+
+  const char* name;
+  int index;
+  std::atomic<unsigned long long> allocations;
+  std::atomic<unsigned long long> bytes;
+  AllocationRegion* next;
+};
+
+// Activates a region on the current thread, until the scope ends. Scopes can be nested, an allocation counts for all
+// active regions.
+class AllocationScope {
+ public:
+  explicit AllocationScope(AllocationRegion* region);
+  ~AllocationScope();
+
+ private:
+  bool active;
+};
+
+class AllocationProfiler {
+ public:
+  static constexpr int maxRegions = 32;
+
+  static bool isEnabled();
+  static unsigned long long getAllocations();
+  static unsigned long long getBytes();
+  static unsigned long long getFrees();
+  static void readRegions(unsigned long long allocations[maxRegions], unsigned long long bytes[maxRegions]);
+  static const char* getRegionName(int index);
+  static int getRegionCount();
+  static void print(std::ostream& out);
+  static bool writeReport(const std::string& path);
+  static void count(std::size_t size);
+  static void countFree();
+};
+
+#endif  // ALLOCATIONPROFILER_H_
@@ -0,0 +1,96 @@
+#include "./PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+/**
+ * @brief Constructs closed PerfCounters. Call open to start counting.
+ */
+PerfCounters::PerfCounters() {
+  for (int i = 0; i < count; i++) fds[i] = -1;
+}
+
+PerfCounters::~PerfCounters() { close(); }
+
+/**
+ * Opens all counters for the calling thread. The counters start counting immediately, the caller reads them before and
+ * after the measured code and uses the difference.
+ *
+ * @return True if at least one counter could be opened, false otherwise.
+ */
+bool PerfCounters::open() {
+#ifdef __linux__
+  const unsigned long long cacheReadMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  const unsigned int types[count] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                     PERF_TYPE_HW_CACHE};
+  const unsigned long long configs[count] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_L1D | cacheReadMiss,
+                                             PERF_COUNT_HW_CACHE_LL | cacheReadMiss};
+  close();
+  for (int i = 0; i < count; i++) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = types[i];
+    attr.config = configs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Needed to scale the value, if the kernel has to multiplex more counters than the CPU has
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+#endif
+  return isOpen();
+}
+
+/**
+ * Closes all open counters.
+ */
+void PerfCounters::close() {
+  for (int i = 0; i < count; i++) {
+#ifdef __linux__
+    if (fds[i] != -1) ::close(fds[i]);
+#endif
+    fds[i] = -1;
+  }
+}
+
+/**
+ * Reads the current values of all counters. Unavailable counters read as 0.
+ *
+ * @param values Receives the values, indexed by Counter.
+ */
+void PerfCounters::read(unsigned long long values[count]) {
+  for (int i = 0; i < count; i++) {
+    values[i] = 0;
+#ifdef __linux__
+    unsigned long long data[3];
+    if (fds[i] == -1 || ::read(fds[i], data, sizeof(data)) != sizeof(data)) continue;
+    // Scale the value up to the whole time, if the counter was only running part of the time
+    values[i] = data[2] > 0 && data[2] < data[1] ? (unsigned long long)((double)data[0] * data[1] / data[2]) : data[0];
+#endif
+  }
+}
+
+/**
+ * @brief Getters of the PerfCounters class.
+ *
+ * */
+bool PerfCounters::isOpen() {
+  for (int i = 0; i < count; i++) {
+    if (fds[i] != -1) return true;
+  }
+  return false;
+}
+
+bool PerfCounters::isAvailable(int counter) { return fds[counter] != -1; }
+
+const char* PerfCounters::getName(int counter) {
+  static const char* names[count] = {"cycles", "instructions", "branch-misses", "L1-misses", "LLC-misses"};
+  return names[counter];
+}
@@ -0,0 +1,29 @@
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+/**
+ * Hardware performance counters of the calling thread, opened with perf_event_open. Only user space events are counted.
+ * The counters are only available on Linux, if the kernel allows it (perf_event_paranoid) and the CPU or virtual
+ * machine exposes a PMU. Every counter is opened on its own, so a missing counter does not disable the others.
+ */
+class PerfCounters {
+ public:
+  enum Counter { Cycles, Instructions, BranchMisses, L1Misses, LlcMisses };
+  static constexpr int count = 5;
+
+  PerfCounters();
+  ~PerfCounters();
+
+  bool open();
+  void close();
+  void read(unsigned long long values[count]);
+  bool isOpen();
+  bool isAvailable(int counter);
+
+  static const char* getName(int counter);
+
+ private:
+  int fds[count];
+};
+
+#endif  // PERFCOUNTERS_H_
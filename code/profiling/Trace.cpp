@@ -0,0 +1,113 @@
+#include "./Trace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+// Buffers of all threads, which ever recorded a span. They are never freed, so the spans of finished threads, like a
+// timer thread of an earlier game, are still part of the dump.
+static std::mutex registryMutex;
+static std::vector<TraceBuffer*> registry;
+static thread_local TraceBuffer* localBuffer = nullptr;
+
+// Tick count and steady clock time of the first registered thread, to convert ticks into time when writing the trace
+static long long startTicks;
+static std::chrono::steady_clock::time_point startTime;
+
+/**
+ * Creates the buffer of the calling thread. Only called once per thread, on its first span.
+ *
+ * @return The buffer of the calling thread.
+ */
+TraceBuffer* Trace::registerThread() {
+  TraceBuffer* buffer = new TraceBuffer();
+  buffer->written.store(0, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(registryMutex);
+  if (registry.empty()) {
+    startTicks = now();
+    startTime = std::chrono::steady_clock::now();
+  }
+  buffer->threadId = registry.size() + 1;
+  buffer->threadName = "thread " + std::to_string(buffer->threadId);
+  registry.push_back(buffer);
+  localBuffer = buffer;
+  return buffer;
+}
+
+/**
+ * Adds a span to the ring buffer of the calling thread. If the buffer is full, the oldest span is overwritten.
+ *
+ * @param name The name of the span, a string literal.
+ * @param begin The start time in nanoseconds.
+ * @param end The end time in nanoseconds.
+ */
+void Trace::record(const char* name, long long begin, long long end) {
+  TraceBuffer* buffer = localBuffer != nullptr ? localBuffer : registerThread();
+  unsigned long long index = buffer->written.load(std::memory_order_relaxed);
+  buffer->events[index & (TraceBuffer::capacity - 1)] = {name, begin, end};
+  buffer->written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * Names the calling thread in the trace, like "ui" or "timer".
+ *
+ * @param name The name of the thread.
+ */
+void Trace::setThreadName(const char* name) {
+  TraceBuffer* buffer = localBuffer != nullptr ? localBuffer : registerThread();
+  std::lock_guard<std::mutex> lock(registryMutex);
+  buffer->threadName = name;
+}
+
+/**
+ * Writes the spans of all threads in the Chrome trace_event JSON format, which can be opened in Perfetto or
+ * chrome://tracing. All threads share one timeline. Spans, which a thread records during the dump, may be missing.
+ *
+ * @param path The path of the JSON file.
+ * @return True if the file was written, false otherwise.
+ */
+bool Trace::writeJson(const std::string& path) {
+  std::ofstream file(path);
+  if (!file) return false;
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  // Measure the tick rate over the traced time
+  double ticksPerUs = 1000.0;
+  double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+  if (!registry.empty() && elapsed > 1000.0) ticksPerUs = (now() - startTicks) / elapsed;
+
+  // Timestamps start at the earliest recorded span
+  long long origin = -1;
+  for (TraceBuffer* buffer : registry) {
+    unsigned long long written = buffer->written.load(std::memory_order_acquire);
+    unsigned long long first = written > TraceBuffer::capacity ? written - TraceBuffer::capacity : 0;
+    if (written > first) {
+      long long begin = buffer->events[first & (TraceBuffer::capacity - 1)].begin;
+      if (origin == -1 || begin < origin) origin = begin;
+    }
+  }
+
+  char line[256];
+  bool first = true;
+  file << "{\"traceEvents\": [\n";
+  for (TraceBuffer* buffer : registry) {
+    snprintf(line, sizeof(line),
+             "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+             first ? "" : ",\n", buffer->threadId, buffer->threadName.c_str());
+    file << line;
+    first = false;
+
+    unsigned long long written = buffer->written.load(std::memory_order_acquire);
+    unsigned long long start = written > TraceBuffer::capacity ? written - TraceBuffer::capacity : 0;
+    for (unsigned long long i = start; i < written; i++) {
+      const TraceEvent& event = buffer->events[i & (TraceBuffer::capacity - 1)];
+      snprintf(line, sizeof(line),
+               ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}", event.name,
+               buffer->threadId, (event.begin - origin) / ticksPerUs, (event.end - event.begin) / ticksPerUs);
+      file << line;
+    }
+  }
+  file << "\n]}\n";
+  return file.good();
+}
@@ -0,0 +1,78 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Tracing is compiled in with -DENABLE_TRACING (make flags=-DENABLE_TRACING). Otherwise the macros expand to nothing
+// and the traced code is not changed at all.
+#ifdef ENABLE_TRACING
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_THREAD(name) Trace::setThreadName(name)
+#define TRACE_DUMP(path) Trace::writeJson(path)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_THREAD(name)
+#define TRACE_DUMP(path)
+#endif
+
+// A finished span. The name has to be a string literal, since only the pointer is stored. The times are in ticks of
+// Trace::now and converted to microseconds, when the trace is written.
+struct TraceEvent {
+  const char* name;
+  long long begin;
+  long long end;
+};
+
+// Ring buffer of the spans of one thread. Only the owning thread writes, so recording needs no lock.
+struct TraceBuffer {
+  static constexpr int capacity = 1 << 16;
+
+  TraceEvent events[capacity];
+  std::atomic<unsigned long long> written;
+  int threadId;
+  std::string threadName;
+};
+
+class Trace {
+ public:
+  /**
+   * Returns the current time in ticks. On x86 the time stamp counter is read, which costs only a fraction of a clock
+   * call, otherwise the steady clock in nanoseconds is used.
+   */
+  static long long now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static void record(const char* name, long long begin, long long end);
+  static void setThreadName(const char* name);
+  static bool writeJson(const std::string& path);
+
+ private:
+  static TraceBuffer* registerThread();
+};
+
+// Records the time between its construction and destruction as a span
+class TraceSpan {
+ public:
+  explicit TraceSpan(const char* pName) : name(pName), begin(Trace::now()) {}
+  ~TraceSpan() { Trace::record(name, begin, Trace::now()); }
+
+ private:
+  const char* name;
+  long long begin;
+};
+
+#endif  // TRACE_H_
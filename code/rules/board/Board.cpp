@@ -1,8 +1,13 @@
 #include "./Board.h"
 
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
+#include "../../eval/Evaluation.h"
+#include "../../profiling/AllocationProfiler.h"
+#include "../../profiling/Trace.h"
+
 std::string protoBoard = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
 
 /**
@@ -14,26 +19,26 @@ std::string protoBoard = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
  * @throws std::runtime_error if the width or height is negative or if they are not equal.
  */
 Board::Board(int pWidth, int pHeight)
-    : width(pWidth), height(pHeight), style{255, 168, 139, 103}, maxTime(600.0), castling{0, 0, 0, 0} {
+    : width(pWidth), height(pHeight), style{255, 168, 139, 103}, maxTime(600.0), castling{0, 0, 0, 0}, version(0) {
   // Initialize the board dimensions and setup the board
   if (pWidth < 0 || pHeight < 0)
     throw std::runtime_error("Width and height must be positive");
   else if (pWidth != pHeight)
     throw std::runtime_error("Width and height must be equal");
+  piece = new Piece();
+  network = nullptr;
   setup(protoBoard);
 
   // Initialize the standart board state
-  piece = new Piece();
   selectedPiece = -1;
   turn = true;
   rotate = true;
   showMoves = true;
   promoting = false;
-  passant = false;
-  drawCounter = 0;
-  lastMove = "";
+  lastMove = Move();
   gameStarted = false;
   gameEnded = L"";
+  result = "*";
   time[0] = maxTime;
   time[1] = maxTime;
   fen = protoBoard;
@@ -45,7 +50,7 @@ Board::Board(int pWidth, int pHeight)
  * This destructor is responsible for deleting the dynamically allocated piece object.
  *
  */
-Board::~Board() {}
+Board::~Board() { delete piece; }
 
 /**
  * @brief Sets up the board based on the given FEN (Forsyth-Edwards Notation) string.
@@ -69,6 +74,8 @@ Board::~Board() {}
  * @see https://en.wikipedia.org/wiki/Forsyth%E2%80%93Edwards_Notation
  */
 bool Board::setup(std::string fen) {
+  TRACE_SCOPE("Board::setup");
+  touch();
   board = "";
 
   int count = 0;
@@ -98,23 +105,69 @@ bool Board::setup(std::string fen) {
     return false;
   }
   visualBoard = board;
+  countMaterial();
+  if (network != nullptr) {
+    accumulators.resize(1);
+    network->refresh(board, &accumulators[0]);
+  }
   return true;
 }
 
 /**
- * Calculates the material value of the board for a given player's turn.
+ * Recalculates the counters from the whole board. Only needed after a new position is set up, every move updates the
+ * counters incrementally.
+ */
+void Board::countMaterial() {
+  counters = {0, {0, 0}, {0, 0}, {0, 0}, {0, 0}, PawnTable::computeKey(board)};
+  undoCounters.clear();
+  for (int i = 0; i < board.length(); i++) {
+    counters.material[isupper(board[i]) == 0] += piece->getValue(board[i]);
+    if (board[i] != ' ') countPiece(board[i], i, 1);
+  }
+}
+
+/**
+ * Adds a piece to the piece counters of the dead position test, or removes it.
+ *
+ * @param pieceType The piece, uppercase for white. Kings are not counted.
+ * @param square The square of the piece, whose color counts for bishops.
+ * @param sign 1 to add the piece, -1 to remove it.
+ */
+void Board::countPiece(char pieceType, int square, int sign) {
+  char type = tolower(pieceType);
+  if (type == 'k') return;
+  int side = isupper(pieceType) == 0;
+  counters.pieces[side] += sign;
+  if (type == 'n' || type == 'b') counters.minors[side] += sign;
+  if (type == 'b') counters.bishops[(square % width + square / width) % 2] += sign;
+}
+
+/**
+ * Returns the material value of the board for a given player's turn.
  *
  * @param turn A boolean value indicating the player's turn. True for white, false for black.
  * @return The material value of the board for the specified player's turn.
  */
-int Board::material(bool turn) {
-  int material = 0;
-  for (int i = 0; i < board.length(); i++) {
-    if ((isupper(board[i]) == 0) == turn) {
-      material += piece->getValue(board[i]);
-    }
-  }
-  return material;
+int Board::material(bool turn) { return counters.material[turn]; }
+
+/**
+ * Returns the Zobrist key of the pawns of the current position, which is updated with every move.
+ *
+ * @return The XOR of the keys of all pawns, see PawnTable::squareKey.
+ */
+uint64_t Board::getPawnKey() { return counters.pawnKey; }
+
+/**
+ * Tests, whether no series of legal moves can checkmate either king: only the kings are left, or one knight or
+ * bishop besides them, or only bishops, which all stand on squares of one color.
+ *
+ * @return True if the game is a draw by insufficient material.
+ */
+bool Board::isDeadPosition() {
+  if (counters.pieces[0] != counters.minors[0] || counters.pieces[1] != counters.minors[1]) return false;
+  int minors = counters.minors[0] + counters.minors[1];
+  if (minors <= 1) return true;
+  return counters.bishops[0] + counters.bishops[1] == minors && (counters.bishops[0] == 0 || counters.bishops[1] == 0);
 }
 
 /**
@@ -124,6 +177,7 @@ int Board::material(bool turn) {
  * @param fromY The y-coordinate of the piece to move.
  */
 void Board::beginMovePiece(int fromX, int fromY) {
+  touch();
   if (gameEnded != L"") return;
   if (promoting) return;
   if (fromX < 0 || fromY < 0 || fromX >= width || fromY >= height) {
@@ -155,6 +209,9 @@ void Board::beginMovePiece(int fromX, int fromY) {
  * @return True if the move was successful, false otherwise.
  */
 bool Board::movePiece(int fromX, int fromY, int toX, int toY, char promotionPiece) {
+  TRACE_SCOPE("Board::movePiece");
+  ALLOCATION_SCOPE("movePiece");
+  touch();
   // Check if the game has already ended
   if (gameEnded != L"") return false;
 
@@ -183,156 +240,130 @@ bool Board::movePiece(int fromX, int fromY, int toX, int toY, char promotionPiec
     return false;
   }
 
-  // Check if the move is a pawn promotion
-  if ((toY == 0 || toY == 7) && (curPiece == 'P' || curPiece == 'p') && !promoting) {
-    tempMove = curPiece + std::to_string(fromX) + std::to_string(fromY) + (visualBoard[posTo] != ' ' ? "x" : "") +
-               std::to_string(toX) + std::to_string(toY) + "=";
-    promoting = true;
-    selectedPiece = posFrom;
-    return false;
-  }
-
-  // Reset en passant flag
-  piece->setPassant(false);
-
-  // Move the piece and check if the move is valid
-  if (!piece->move(promotionPiece != ' '
-                       ? (tempMove + promotionPiece)
-                       : (curPiece + std::to_string(fromX) + std::to_string(fromY) +
-                          (visualBoard[posTo] != ' ' ? "x" : "") + std::to_string(toX) + std::to_string(toY)),
-                   visualBoard, curPiece, width, turn, lastMove, castling)) {
-    visualBoard = visualBoard.substr(0, posFrom) + curPiece + visualBoard.substr(posFrom + 1);
-    return false;
-  }
+  // Find the move in the legal moves of the current player
+  Move move;
+  if (promoting) {
+    // Complete the pending promotion with the chosen piece, or cancel it
+    promoting = false;
+    if (promotionPiece != ' ' && (isupper(promotionPiece) != 0) == turn)
+      move = pendingPromotion.withPromotionPiece(promotionPiece);
+    if (move.isNull()) {
+      visualBoard = board;
+      return false;
+    }
+  } else {
+    MoveList moves;
+    piece->testAvailableMoves(board, turn, lastMove, castling, &moves);
+    move = moves.find(posFrom, posTo);
+    if (move.isNull()) {
+      visualBoard = visualBoard.substr(0, posFrom) + curPiece + visualBoard.substr(posFrom + 1);
+      return false;
+    }
 
-  // Update en passant flag
-  if (piece->getPassant()) {
-    passant = true;
+    // Let the player choose the piece, before a pawn is promoted
+    if (move.isPromotion()) {
+      pendingPromotion = move;
+      promoting = true;
+      selectedPiece = posFrom;
+      return false;
+    }
   }
+  posFrom = move.getFrom();
+  posTo = move.getTo();
+  char movedPiece = board[posFrom];
 
-  // Update position if promoting
-  if (promoting) {
-    posFrom = tempMove[1] - '0' + (tempMove[2] - '0') * width;
-    posTo = tempMove[tempMove[3] == 'x' ? 4 : 3] - '0' + (tempMove[tempMove[3] == 'x' ? 5 : 4] - '0') * width;
-  }
+  // The first move of a game saves the start position for the analysis
+  if (undo.empty()) gameStart = getPosition();
 
   // Save the current board state for undo
   undo.push_back(board);
+  undoCounters.push_back(counters);
 
-  // Handle en passant capture
-  if (passant) {
-    visualBoard[lastMove[3] - '0' + (lastMove[4] - '0') * width] = ' ';
-    passant = false;
-  }
+  // Find the captured piece. The pawn captured en passant stands next to the capturing pawn
+  char captured = move.isEnPassant() ? board[posFrom / width * width + posTo % width]
+                  : move.isCapture() ? board[posTo]
+                                     : ' ';
 
   // Update last move
-  lastMove = curPiece + std::to_string(fromX) + std::to_string(fromY) + std::to_string(toX) + std::to_string(toY);
+  lastMove = move;
 
   // Update castling availability
-  if (curPiece == 'K' && (castling[0] == 0 || castling[1] == 0)) {
+  if (movedPiece == 'K' && (castling[0] == 0 || castling[1] == 0)) {
     castling[0] = undo.size();
     castling[1] = undo.size();
-  } else if (curPiece == 'k' && (castling[2] == 0 || castling[3] == 0)) {
+  } else if (movedPiece == 'k' && (castling[2] == 0 || castling[3] == 0)) {
     castling[2] = undo.size();
     castling[3] = undo.size();
-  } else if (tolower(curPiece) == 'r') {
-    if (fromX == 0 || fromX == 7) {
-      if (castling[(turn ? 0 : 2) + (fromX == 0 ? 0 : 1)] == 0)
-        castling[(turn ? 0 : 2) + (fromX == 0 ? 0 : 1)] = undo.size();
-    }
+  }
+  // Moving or capturing a rook in its corner loses the castling on that side
+  int corners[4] = {56, 63, 0, 7};
+  for (int i = 0; i < 4; i++) {
+    if ((posFrom == corners[i] || (posTo == corners[i] && move.isCapture())) && castling[i] == 0)
+      castling[i] = undo.size();
   }
 
   // Save the last move for undo
-  undoMoves.push_back(lastMove);
-
-  // Update the visual board after the move
-  if (posFrom < posTo)
-    visualBoard = visualBoard.substr(0, posFrom) + " " + visualBoard.substr(posFrom + 1, posTo - posFrom - 1) +
-                  (promotionPiece != ' ' ? promotionPiece : curPiece) + visualBoard.substr(posTo + 1);
-  else if (posFrom > posTo)
-    visualBoard = visualBoard.substr(0, posTo) + (promotionPiece != ' ' ? promotionPiece : curPiece) +
-                  visualBoard.substr(posTo + 1, posFrom - posTo - 1) + " " + visualBoard.substr(posFrom + 1);
-
-  std::vector<std::vector<int>> moves = piece->testAvailableMoves(board, !turn, lastMove, castling);
-  // Unecessarily long check if castling is obstructed by checks.
-
-  if (lastMove.compare("K4777") == 0 || lastMove.compare("K4707") == 0 || lastMove.compare("k4070") == 0 ||
-      lastMove.compare("k4000") == 0) {
-    if (piece->testCheck(board, turn, lastMove, castling)) {
-      undoMove();
-      drawCounter++;
-      turn = !turn;
-      return false;
-    }
-    for (int i = 0; i < moves.size(); i++) {
-      if ((lastMove.compare("K4777") == 0 && (std::find(moves[i].begin(), moves[i].end(), 62) != moves[i].end() ||
-                                              std::find(moves[i].begin(), moves[i].end(), 61) != moves[i].end())) ||
-          (lastMove.compare("K4707") == 0 && (std::find(moves[i].begin(), moves[i].end(), 59) != moves[i].end() ||
-                                              std::find(moves[i].begin(), moves[i].end(), 58) != moves[i].end() ||
-                                              std::find(moves[i].begin(), moves[i].end(), 57) != moves[i].end())) ||
-          (lastMove.compare("k4070") == 0 && (std::find(moves[i].begin(), moves[i].end(), 6) != moves[i].end() ||
-                                              std::find(moves[i].begin(), moves[i].end(), 5) != moves[i].end())) ||
-          (lastMove.compare("K4000") == 0 && (std::find(moves[i].begin(), moves[i].end(), 3) != moves[i].end() ||
-                                              std::find(moves[i].begin(), moves[i].end(), 2) != moves[i].end() ||
-                                              std::find(moves[i].begin(), moves[i].end(), 1) != moves[i].end()))) {
-        undoMove();
-        drawCounter++;
-        turn = !turn;
-        return false;
-      }
-    }
-    if (lastMove.compare("K4777") == 0)
-      visualBoard = visualBoard.substr(0, 60) + " RK ";
-    else if (lastMove.compare("K4707") == 0)
-      visualBoard = visualBoard.substr(0, 56) + "  KR " + visualBoard.substr(61);
-    else if (lastMove.compare("k4070") == 0)
-      visualBoard = visualBoard.substr(0, 4) + " kr " + visualBoard.substr(8);
-    else if (lastMove.compare("k4000") == 0)
-      visualBoard = "  kr " + visualBoard.substr(5);
-  }
+  undoMoves.push_back(move);
 
-  // Test if the move puts the current player's king in check
-  moves = piece->testAvailableMoves(board, !turn, lastMove, castling);
-  if (piece->testCheck(visualBoard, turn, lastMove, castling)) {
-    undoMove();
-    drawCounter++;
-    turn = !turn;
-    return false;
+  // Update the board after the move. The move generator only returns legal moves, so the move can not leave the own
+  // king in check, and castling through check is already excluded.
+  piece->makeMove(board, move);
+  visualBoard = board;
+  if (network != nullptr) {
+    accumulators.emplace_back();
+    network->update(accumulators[accumulators.size() - 2], undo.back(), board, &accumulators.back());
   }
 
-  // Update the board state
-  board = visualBoard;
+  // Update the counters with the captured and the promoted piece
+  if (captured != ' ') {
+    counters.material[isupper(captured) == 0] -= piece->getValue(captured);
+    countPiece(captured, posTo, -1);
+  }
+  if (move.isPromotion()) {
+    counters.material[isupper(movedPiece) == 0] += piece->getValue(board[posTo]) - piece->getValue(movedPiece);
+    countPiece(movedPiece, posFrom, -1);
+    countPiece(board[posTo], posTo, 1);
+  }
+  counters.halfmoveClock = (tolower(movedPiece) == 'p' || captured != ' ') ? 0 : counters.halfmoveClock + 1;
+  // Only pawn moves and captures of pawns change the pawn key. The pawn captured en passant is next to the target
+  if (tolower(movedPiece) == 'p' || tolower(captured) == 'p') {
+    const std::string& before = undo.back();
+    int squares[3] = {posFrom, posTo, posFrom / width * width + posTo % width};
+    for (int i = 0; i < (move.isEnPassant() ? 3 : 2); i++) {
+      int square = squares[i];
+      counters.pawnKey ^= PawnTable::squareKey(before[square], square) ^ PawnTable::squareKey(board[square], square);
+    }
+  }
 
   // Check for end game conditions
-  if (material(!turn) + material(turn) < 5) {
+  if (isDeadPosition()) {
     endGame(false, false, false);
     return false;
   }
 
-  // Check for draw by repetition
-  for (int i = 0; i < undo.size(); i++) {
-    for (int j = 0; j < undo.size(); j++) {
-      for (int l = 0; l < undo.size(); l++) {
-        if (undo[i] == undo[j] && undo[i] == undo[l] && i != j && i != l && j != l) {
-          endGame(true, false, false);
-          return false;
-        }
-      }
+  // Check for draw by repetition. Positions before the last capture or pawn move can not occur again, so only the
+  // positions since then are compared with the position before this move.
+  int repetitions = 0;
+  {
+    TRACE_SCOPE("Board::repetition");
+    int firstReversible = undo.size() - 1 - undoCounters.back().halfmoveClock;
+    for (int i = undo.size() - 1; i >= 0 && i >= firstReversible; i--) {
+      if (undo[i] == undo.back()) repetitions++;
     }
   }
+  if (repetitions >= 3) {
+    endGame(true, false, false);
+    return false;
+  }
 
-  // Test available moves for the opponent
-  moves = piece->testAvailableMoves(board, !turn, lastMove, castling);
-
-  // Check for draw by insufficient material or 50-move rule
-  if (moves.size() == 0 || drawCounter >= 50) {
+  // Check for checkmate, stalemate or the 50-move rule (100 plies without capture or pawn move)
+  if (counters.halfmoveClock >= 100 || !piece->hasLegalMove(board, !turn, lastMove, castling)) {
     endGame(false, false, false);
     return false;
   }
 
   // Update game state
   promoting = false;
-  drawCounter++;
   turn = !turn;
 
   return true;
@@ -343,23 +374,28 @@ bool Board::movePiece(int fromX, int fromY, int toX, int toY, char promotionPiec
  * If there are no moves to undo, the function returns immediately.
  */
 void Board::undoMove() {
+  TRACE_SCOPE("Board::undoMove");
+  touch();
   if (undo.empty() || undoMoves.empty()) return;
   board = undo[undo.size() - 1];
   undoMoves.pop_back();
-  lastMove = undoMoves.size() > 0 ? undoMoves[undoMoves.size() - 1] : "";
+  lastMove = undoMoves.size() > 0 ? undoMoves[undoMoves.size() - 1] : Move();
   undo.pop_back();
+  if (accumulators.size() > 1) accumulators.pop_back();
+  if (!undoCounters.empty()) {
+    counters = undoCounters.back();
+    undoCounters.pop_back();
+  }
   if (undo.empty()) {
     newGame(maxTime);
     return;
   }
   for (int i = 0; i < 4; i++) {
-    if (castling[i] >= undo.size()) castling[i] = 0;
+    if (castling[i] > 0 && castling[i] >= undo.size()) castling[i] = 0;
   }
   visualBoard = board;
   turn = !turn;
-  drawCounter--;
   promoting = false;
-  passant = false;
 }
 
 /**
@@ -369,26 +405,39 @@ void Board::undoMove() {
  * @param timeOut Indicates if the game ended due to timeout.
  */
 void Board::endGame(bool repetition, bool timeOut, bool resignation) {
+  touch();
   // Check for end game conditions
+  result = "1/2-1/2";
   if (repetition) {
     gameEnded = L"Draw by repetition!";
   } else if (timeOut) {
-    gameEnded = (material(!turn) > 4 ? (turn ? L"Black wins" : L"White wins") : L"Draw by insufficient \n material");
+    // The player on turn ran out of time, and loses, unless the opponent can never checkmate
+    bool canMate = counters.pieces[turn ? 1 : 0] > 0 && !isDeadPosition();
+    gameEnded = (canMate ? (turn ? L"Black wins" : L"White wins") : L"Draw by insufficient \n material");
     gameEnded += L" by Timeout!";
-  } else if (drawCounter >= 50) {
-    gameEnded = L"Draw by 50-move rule!";
-  } else if (material(true) + material(false) < 5) {
+    if (canMate) result = turn ? "0-1" : "1-0";
+  } else if (isDeadPosition()) {
     gameEnded = L"Draw by insufficient \n material!";
-  } else if (piece->testCheck(visualBoard, !turn, lastMove, castling)) {
-    gameEnded = (turn ? L"White" : L"Black");
-    gameEnded += L" wins \n by Checkmate!";
+  } else if (!piece->hasLegalMove(board, !turn, lastMove, castling)) {
+    // Checkmate ends the game also on the 100th ply without capture or pawn move
+    if (piece->testCheck(board, !turn)) {
+      gameEnded = (turn ? L"White" : L"Black");
+      gameEnded += L" wins \n by Checkmate!";
+      result = turn ? "1-0" : "0-1";
+    } else {
+      gameEnded = L"Draw by stalemate!";
+    }
+  } else if (counters.halfmoveClock >= 100) {
+    gameEnded = L"Draw by 50-move rule!";
   } else {
     gameEnded = L"Draw by stalemate!";
   }
 
-  // Reset game state
+  // Reset game state, but keep the moves for the analysis of the game
+  endedMoves = undoMoves;
   undo = std::vector<std::string>();
-  undoMoves = std::vector<std::string>();
+  undoMoves = std::vector<Move>();
+  undoCounters = std::vector<GameCounters>();
   promoting = false;
   turn = true;
   gameStarted = false;
@@ -401,6 +450,7 @@ void Board::endGame(bool repetition, bool timeOut, bool resignation) {
  * @param maxTimeT The maximum time allowed for each move in the game.
  */
 void Board::newGame(double maxTimeT) {
+  touch();
   if (gameStarted) endGame(false, false, true);
   if (!setup(fen)) setup(protoBoard);
   for (int i = 0; i < 4; i++) castling[i] = 0;
@@ -408,27 +458,137 @@ void Board::newGame(double maxTimeT) {
   time[0] = maxTime;
   time[1] = maxTime;
   gameEnded = L"";
+  result = "*";
 }
 
+/**
+ * Starts a new game from a complete FEN string, including the player to move, the castling availability, the en
+ * passant square and the halfmove clock. Undoing the first move of this game starts a new game from the FEN of setFen.
+ *
+ * @param positionFen The FEN string of the position.
+ * @return True if the position was set, false if the FEN is invalid.
+ */
+bool Board::setPosition(const std::string& positionFen) {
+  Position position;
+  if (!position.setFen(positionFen)) return false;
+  touch();
+  if (gameStarted) endGame(false, false, true);
+  if (!setup(positionFen.substr(0, positionFen.find(' ')))) return false;
+  undo.clear();
+  undoMoves.clear();
+  turn = position.turn;
+  lastMove = position.lastMove;
+  // Castling lost before the game started is never restored by undoing moves
+  for (int i = 0; i < 4; i++) castling[i] = position.castling[i] == 0 ? 0 : -1;
+  counters.halfmoveClock = position.halfmoveClock;
+  promoting = false;
+  selectedPiece = -1;
+  gameEnded = L"";
+  result = "*";
+  return true;
+}
+
+/**
+ * Returns the current position without the history, for example to search it.
+ *
+ * @return The board, the player to move, the last move, the castling availability and the halfmove clock.
+ */
+Position Board::getPosition() {
+  Position position;
+  position.board = board;
+  position.turn = turn;
+  position.lastMove = lastMove;
+  for (int i = 0; i < 4; i++) position.castling[i] = castling[i] == 0 ? 0 : 1;
+  position.halfmoveClock = counters.halfmoveClock;
+  return position;
+}
+
+/**
+ * Returns the start position of the current game, or of the last ended game. Together with getMoves, this is the
+ * complete game, for example to analyse it after it ended.
+ *
+ * @return The position before the first move, or the current position if no move was made yet.
+ */
+Position Board::getStartPosition() { return getMoves().empty() ? getPosition() : gameStart; }
+
+/**
+ * Returns the moves of the current game. After the game ended, the undo history is cleared, but the moves of the
+ * ended game are still returned, until the next game starts.
+ *
+ * @return The moves since the start position.
+ */
+const std::vector<Move>& Board::getMoves() { return gameEnded == L"" ? undoMoves : endedMoves; }
+
+/**
+ * Increases the version of the board. Called at the start of every function, which can change the board, the visual
+ * board or the selection, so views handed out before are known to be outdated.
+ */
+void Board::touch() { version++; }
+
 /**
  * @brief Setters of the Board class.
  *
  * */
 void Board::setStyle(int pStyle[4]) {
+  touch();
   for (int i = 0; i < 4; i++) style[i] = pStyle[i];
 }
 
-std::vector<std::vector<int>> Board::testAvailableMoves() {
-  return piece->testAvailableMoves(board, turn, lastMove, castling);
-};
+void Board::testAvailableMoves(MoveList* list) { piece->testAvailableMoves(board, turn, lastMove, castling, list); }
+
+/**
+ * Evaluates the exchange on the target square of a move in the current position, see Piece::see.
+ *
+ * @param move A move of the current player.
+ * @return The material the current player wins (positive) or loses (negative) in centipawns.
+ */
+int Board::see(Move move) { return piece->see(board, move); }
+
+/**
+ * Sets the network, which evaluates the positions of this board, and calculates the accumulators of the current
+ * position and of all positions, which can be restored by undoing moves.
+ *
+ * @param pNetwork A loaded network, or nullptr to evaluate by material.
+ */
+void Board::setNetwork(Nnue* pNetwork) {
+  network = pNetwork != nullptr && pNetwork->isLoaded() ? pNetwork : nullptr;
+  accumulators.clear();
+  if (network == nullptr) return;
+  accumulators.resize(undo.size() + 1);
+  for (int i = 0; i < undo.size(); i++) network->refresh(undo[i], &accumulators[i]);
+  network->refresh(board, &accumulators.back());
+}
+
+/**
+ * Evaluates the current position with the network, whose accumulator is updated with every move. Without a network,
+ * the hand written Evaluation is used.
+ *
+ * @return The evaluation in centipawns from the view of the player to move, positive if the player is better.
+ */
+int Board::evaluate() {
+  if (network != nullptr) return network->evaluate(accumulators.back(), turn);
+  return Evaluation::evaluate(board, turn, counters.pawnKey);
+}
 
-void Board::setDoesRotate(bool pRotate) { rotate = pRotate; }
+void Board::setDoesRotate(bool pRotate) {
+  touch();
+  rotate = pRotate;
+}
 
-void Board::setShowMoves(bool pShowMoves) { showMoves = pShowMoves; }
+void Board::setShowMoves(bool pShowMoves) {
+  touch();
+  showMoves = pShowMoves;
+}
 
-void Board::setSelectedPiece(int pSelectedPiece) { selectedPiece = pSelectedPiece; }
+void Board::setSelectedPiece(int pSelectedPiece) {
+  touch();
+  selectedPiece = pSelectedPiece;
+}
 
-void Board::setIsPromoting(bool pPromoting) { promoting = pPromoting; }
+void Board::setIsPromoting(bool pPromoting) {
+  touch();
+  promoting = pPromoting;
+}
 
 void Board::setMaxTime(double pMaxTime) { maxTime = pMaxTime; }
 
@@ -472,6 +632,14 @@ int Board::getMoveCount() { return undo.size(); }
 
 std::atomic<double>* Board::getTime() { return time; }
 
-std::wstring Board::getEndMessage() { return gameEnded; }
+const std::wstring& Board::getEndMessage() { return gameEnded; }
+
+const std::string& Board::getResult() { return result; }
+
+BoardView Board::viewBoard() { return {board, version}; }
+
+BoardView Board::viewVisualBoard() { return {visualBoard, version}; }
+
+unsigned long long Board::getVersion() { return version; }
 
-std::wstring Board::getFen() { return std::wstring(fen.begin(), fen.end()); }
\ No newline at end of file
+std::wstring Board::getFen() { return std::wstring(fen.begin(), fen.end()); }
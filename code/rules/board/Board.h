@@ -3,21 +3,58 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "../../eval/Nnue.h"
+#include "../../eval/PawnHash.h"
 #include "../pieces/Piece.h"
+#include "./Position.h"
+
+// Read-only view of a board string. The view stays valid until the next change of the board, which also increases
+// the version, so a consumer can compare versions to skip work instead of comparing the squares.
+struct BoardView {
+  std::string_view squares;
+  unsigned long long version;
+};
+
+// Values, which are updated incrementally with every move, instead of being recalculated from the whole board. A copy
+// is saved for every move, so undoing a move restores them.
+struct GameCounters {
+  // Plies since the last capture or pawn move
+  int halfmoveClock;
+  // Material value of the white (0) and black (1) pieces
+  int material[2];
+  // Pieces of white and black without the kings, and of those the knights and bishops
+  int pieces[2];
+  int minors[2];
+  // Bishops of both players on light (0) and dark (1) squares
+  int bishops[2];
+  // Zobrist key of the pawns, which indexes the pawn table
+  uint64_t pawnKey;
+};
 
 class Board {
  public:
   Board(int pWidth, int pHeight);
   ~Board();
 
-  std::vector<std::vector<int>> testAvailableMoves();
+  void testAvailableMoves(MoveList* list);
+  int see(Move move);
+  int evaluate();
   std::string getBoard();
   std::string getVisualBoard();
   std::wstring getFen();
-  std::wstring getEndMessage();
+  const std::wstring& getEndMessage();
+  const std::string& getResult();
+  Position getPosition();
+  Position getStartPosition();
+  const std::vector<Move>& getMoves();
+  BoardView viewBoard();
+  BoardView viewVisualBoard();
+  unsigned long long getVersion();
   void undoMove();
   void setTime(double* pTime);
   void setStyle(int pStyle[4]);
@@ -27,6 +64,7 @@ class Board {
   void setShowMoves(bool pShowMoves);
   void setIsPromoting(bool pPromoting);
   void setSelectedPiece(int pSelectedPiece);
+  void setNetwork(Nnue* pNetwork);
   void beginMovePiece(int fromX, int fromY);
   void newGame(double maxTimeT);
   void endGame(bool rep, bool timeOut, bool resignation);
@@ -36,39 +74,55 @@ class Board {
   bool isPromoting();
   bool doesShowMoves();
   bool setup(std::string fen);
+  bool setPosition(const std::string& positionFen);
   bool gameStarted;
   int getWidth();
   int getHeight();
   int getMoveCount();
   int getSelectedPiece();
   int material(bool turn);
+  bool isDeadPosition();
+  uint64_t getPawnKey();
   int style[4];
   double getMaxTime();
   std::atomic<double>* getTime();
 
  private:
+  void touch();
+  void countMaterial();
+  void countPiece(char pieceType, int square, int sign);
+
   Piece* piece;
+  // Evaluation network, not owned by the board, and the accumulators of the current and all undoable positions
+  Nnue* network;
+  std::vector<NnueAccumulator> accumulators;
   std::vector<std::string> undo;
-  std::vector<std::string> undoMoves;
+  std::vector<Move> undoMoves;
+  // Start position of the game and the moves of the last ended game, which are kept for its analysis
+  Position gameStart;
+  std::vector<Move> endedMoves;
+  std::vector<GameCounters> undoCounters;
+  GameCounters counters;
   std::string visualBoard;
-  std::string tempMove;
-  std::string lastMove;
   std::string board;
   std::string fen;
   std::wstring gameEnded;
+  // Result of the ended game in PGN notation ("1-0", "0-1", "1/2-1/2"), "*" while the game is running
+  std::string result;
+  Move lastMove;
+  Move pendingPromotion;
   char curPiece;
   bool rotate;
   bool turn;
   bool showMoves;
   bool promoting;
-  bool passant;
   int castling[4];
   int width;
   int height;
   int selectedPiece;
-  int drawCounter;
   double maxTime;
   std::atomic<double> time[2];
+  std::atomic<unsigned long long> version;
 };
 
-#endif  // BOARD_H_
\ No newline at end of file
+#endif  // BOARD_H_
@@ -0,0 +1,170 @@
+#include "./Position.h"
+
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+// Random keys of every piece on every square, the player to move, the castling sides and the en passant files
+struct PositionKeys {
+  uint64_t pieces[12][64];
+  uint64_t turn;
+  uint64_t castling[4];
+  uint64_t passant[8];
+  // Index into pieces of every piece character
+  int index[128];
+
+  PositionKeys() {
+    for (int i = 0; i < 12; i++) index[(int)"PNBRQKpnbrqk"[i]] = i;
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    uint64_t* keys[] = {&pieces[0][0], &turn, castling, passant};
+    int counts[] = {12 * 64, 1, 4, 8};
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < counts[i]; j++) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        keys[i][j] = z ^ (z >> 31);
+      }
+    }
+  }
+};
+
+static const PositionKeys positionKeys;
+static const char* pieceNames = "PNBRQKpnbrqk";
+static const char* castlingNames = "QKqk";
+static const int corners[4] = {56, 63, 0, 7};
+
+/**
+ * @brief Constructs the starting position.
+ */
+Position::Position() : turn(true), castling{0, 0, 0, 0}, halfmoveClock(0) {
+  board = "rnbqkbnrpppppppp                                PPPPPPPPRNBQKBNR";
+}
+
+/**
+ * Sets the position from a FEN string. The piece placement is required, the player to move, the castling
+ * availability, the en passant square and the halfmove clock are optional and default to the values of the starting
+ * position.
+ *
+ * @param fen The FEN string.
+ * @return True if the FEN was valid, false otherwise. The position is unchanged on failure.
+ */
+bool Position::setFen(const std::string& fen) {
+  std::istringstream fields(fen);
+  std::string placement, side = "w", castlingField = "KQkq", passantField = "-";
+  int clock = 0;
+  fields >> placement >> side >> castlingField >> passantField >> clock;
+
+  std::string squares;
+  int count = 0;
+  for (char c : placement) {
+    if (c == '/') {
+      if (count != 8) return false;
+      count = 0;
+    } else if (c >= '1' && c <= '8') {
+      squares.append(c - '0', ' ');
+      count += c - '0';
+    } else if (strchr(pieceNames, c) != nullptr) {
+      squares += c;
+      count++;
+    } else {
+      return false;
+    }
+  }
+  if (squares.size() != 64 || (side != "w" && side != "b")) return false;
+
+  board = squares;
+  turn = side == "w";
+  for (int i = 0; i < 4; i++) castling[i] = castlingField.find(castlingNames[i]) != std::string::npos ? 0 : 1;
+  // The en passant square is behind the pawn, which was just pushed two squares
+  lastMove = Move();
+  if (passantField.size() == 2 && passantField[0] >= 'a' && passantField[0] <= 'h') {
+    int x = passantField[0] - 'a';
+    int y = '8' - passantField[1];
+    int direction = turn ? 1 : -1;
+    if (y == 2 || y == 5) lastMove = Move((y - direction) * 8 + x, (y + direction) * 8 + x, Move::DoublePush);
+  }
+  halfmoveClock = clock;
+  return true;
+}
+
+/**
+ * Returns the FEN string of the position. The fullmove number is not tracked and always 1.
+ *
+ * @return The FEN string.
+ */
+std::string Position::getFen() const {
+  std::string fen;
+  for (int y = 0; y < 8; y++) {
+    int empty = 0;
+    for (int x = 0; x < 8; x++) {
+      char c = board[y * 8 + x];
+      if (c == ' ') {
+        empty++;
+        continue;
+      }
+      if (empty > 0) fen += '0' + empty;
+      empty = 0;
+      fen += c;
+    }
+    if (empty > 0) fen += '0' + empty;
+    if (y < 7) fen += '/';
+  }
+  fen += turn ? " w " : " b ";
+  std::string castlingField;
+  for (int i : {1, 0, 3, 2}) {
+    if (castling[i] == 0) castlingField += castlingNames[i];
+  }
+  fen += castlingField.empty() ? "-" : castlingField;
+  if (lastMove.isDoublePush()) {
+    int square = (lastMove.getFrom() + lastMove.getTo()) / 2;
+    fen += ' ';
+    fen += 'a' + square % 8;
+    fen += '8' - square / 8;
+  } else {
+    fen += " -";
+  }
+  return fen + " " + std::to_string(halfmoveClock) + " 1";
+}
+
+/**
+ * Makes a legal move into a new position. Moving the king loses both castling sides, moving or capturing a rook in its
+ * corner loses that side, the same way Board::movePiece does.
+ *
+ * @param piece The rules to apply the move with.
+ * @param move A legal move of the player to move.
+ * @param next Receives the position after the move. Its board keeps its capacity, so reusing it does not allocate.
+ */
+void Position::makeMove(Piece* piece, Move move, Position* next) const {
+  char movedPiece = board[move.getFrom()];
+  next->board = board;
+  piece->makeMove(next->board, move);
+  next->turn = !turn;
+  next->lastMove = move;
+  for (int i = 0; i < 4; i++) {
+    next->castling[i] = castling[i];
+    if (move.getFrom() == corners[i] || (move.getTo() == corners[i] && move.isCapture())) next->castling[i] = 1;
+  }
+  if (movedPiece == 'K') next->castling[0] = next->castling[1] = 1;
+  if (movedPiece == 'k') next->castling[2] = next->castling[3] = 1;
+  next->halfmoveClock = tolower(movedPiece) == 'p' || move.isCapture() ? 0 : halfmoveClock + 1;
+}
+
+/**
+ * Calculates the Zobrist key of the position from scratch. Positions with the same pieces, player to move, castling
+ * availability and en passant file have the same key.
+ *
+ * @return The key of the position.
+ */
+uint64_t Position::getKey() const {
+  uint64_t key = turn ? positionKeys.turn : 0;
+  for (int square = 0; square < 64; square++) {
+    if (board[square] == ' ') continue;
+    key ^= positionKeys.pieces[positionKeys.index[(unsigned char)board[square] & 127]][square];
+  }
+  for (int i = 0; i < 4; i++) {
+    if (castling[i] == 0) key ^= positionKeys.castling[i];
+  }
+  if (lastMove.isDoublePush()) key ^= positionKeys.passant[lastMove.getTo() % 8];
+  return key;
+}
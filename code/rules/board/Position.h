@@ -0,0 +1,28 @@
+#ifndef POSITION_H_
+#define POSITION_H_
+
+#include <cstdint>
+#include <string>
+
+#include "../moves/Move.h"
+#include "../pieces/Piece.h"
+
+// Complete state of a position, as needed by a search: the board, the player to move, the last move (for en passant),
+// the castling availability (0 means available, like in Board) and the halfmove clock. Unlike Board, a position has
+// no history, so it is cheap to copy and is made move by move into a new position.
+struct Position {
+  std::string board;
+  bool turn;
+  Move lastMove;
+  int castling[4];
+  int halfmoveClock;
+
+  Position();
+
+  bool setFen(const std::string& fen);
+  std::string getFen() const;
+  void makeMove(Piece* piece, Move move, Position* next) const;
+  uint64_t getKey() const;
+};
+
+#endif  // POSITION_H_
@@ -0,0 +1,154 @@
+#include "./GameArchive.h"
+
+// Start of every archive, the digit is the version of the format
+static const char magic[] = "HGA2";
+
+/**
+ * Writes a number as varint, 7 bits per byte, the low bits first, with the high bit set on all bytes but the last.
+ */
+static void writeNumber(std::ostream& out, unsigned long long value) {
+  while (value >= 128) {
+    out.put((char)((value & 127) | 128));
+    value >>= 7;
+  }
+  out.put((char)value);
+}
+
+/**
+ * Reads a varint.
+ *
+ * @return False at the end of the stream or if the number is too long.
+ */
+static bool readNumber(std::istream& in, unsigned long long* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = in.get();
+    if (byte == EOF) return false;
+    *value |= (unsigned long long)(byte & 127) << shift;
+    if (byte < 128) return true;
+  }
+  return false;
+}
+
+/**
+ * Writes a string with its length before it.
+ */
+static void writeString(std::ostream& out, const std::string& value) {
+  writeNumber(out, value.size());
+  out.write(value.data(), value.size());
+}
+
+/**
+ * Reads a string with its length before it, at most limit bytes.
+ */
+static bool readString(std::istream& in, std::string* value, unsigned long long limit = 1 << 16) {
+  unsigned long long size;
+  if (!readNumber(in, &size) || size > limit) return false;
+  value->resize(size);
+  in.read(value->data(), size);
+  return in.gcount() == (std::streamsize)size;
+}
+
+/**
+ * Writes the header of an archive.
+ *
+ * @param adaptive True if the games are coded with the adaptive model.
+ */
+bool GameArchive::writeHeader(std::ostream& out, bool adaptive) {
+  out.write(magic, 4);
+  out.put(adaptive ? 1 : 0);
+  return (bool)out;
+}
+
+/**
+ * Reads the header of an archive.
+ *
+ * @param adaptive Set to true if the games are coded with the adaptive model.
+ * @return False if the stream is not an archive of this version.
+ */
+bool GameArchive::readHeader(std::istream& in, bool* adaptive) {
+  char header[5];
+  in.read(header, 5);
+  if (in.gcount() != 5 || std::string(header, 4) != magic || (header[4] != 0 && header[4] != 1)) return false;
+  *adaptive = header[4] == 1;
+  return true;
+}
+
+/**
+ * Codes a game and writes it to an archive.
+ *
+ * @param out The stream after the header.
+ * @param game The game, whose comments and annotation glyphs are dropped.
+ * @param adaptive The model of the header.
+ * @return False if a move of the game is not legal, then nothing is written.
+ */
+bool GameArchive::write(std::ostream& out, const PgnGame& game, bool adaptive) {
+  GameEncoder encoder(game.getStartPosition(), adaptive);
+  for (Move move : game.moves) {
+    if (!encoder.add(move)) return false;
+  }
+  const std::string& bytes = encoder.finish();
+  writeNumber(out, game.tags.size());
+  for (const auto& tag : game.tags) {
+    writeString(out, tag.first);
+    writeString(out, tag.second);
+  }
+  writeString(out, game.startFen);
+  writeString(out, game.result);
+  writeNumber(out, game.moves.size());
+  writeString(out, bytes);
+  return (bool)out;
+}
+
+/**
+ * Reads the next game of an archive without decoding its moves.
+ *
+ * @return True if a game was read, false at the end of the stream or if the archive is damaged.
+ */
+bool GameArchive::readCoded(std::istream& in, ArchiveGame* game) {
+  unsigned long long tagCount, moveCount;
+  if (!readNumber(in, &tagCount) || tagCount > 1024) return false;
+  game->tags.resize(tagCount);
+  for (auto& tag : game->tags) {
+    if (!readString(in, &tag.first) || !readString(in, &tag.second)) return false;
+  }
+  if (!readString(in, &game->startFen) || !readString(in, &game->result)) return false;
+  if (!readNumber(in, &moveCount) || moveCount > 1 << 20) return false;
+  game->moveCount = (int)moveCount;
+  return readString(in, &game->bytes, moveCount * 2 + 8);
+}
+
+/**
+ * Decodes the moves of a game of an archive.
+ *
+ * @param coded The game of readCoded.
+ * @param adaptive The model of the header.
+ * @param game Receives the game.
+ * @return False if the coded moves are damaged.
+ */
+bool GameArchive::decode(const ArchiveGame& coded, bool adaptive, PgnGame* game) {
+  *game = PgnGame();
+  game->tags = coded.tags;
+  game->startFen = coded.startFen;
+  game->result = coded.result;
+  Position start;
+  if (!coded.startFen.empty() && !start.setFen(coded.startFen)) return false;
+  GameDecoder decoder(start, adaptive, (const uint8_t*)coded.bytes.data(), coded.bytes.size(), coded.moveCount);
+  game->moves.reserve(coded.moveCount);
+  Move move;
+  while (decoder.next(&move)) game->moves.push_back(move);
+  return (int)game->moves.size() == coded.moveCount;
+}
+
+/**
+ * Reads and decodes the next game of an archive.
+ *
+ * @param in The stream after the header.
+ * @param adaptive The model of the header.
+ * @param game Receives the game.
+ * @return True if a game was read, false at the end of the stream or if the archive is damaged.
+ */
+bool GameArchive::read(std::istream& in, bool adaptive, PgnGame* game) {
+  ArchiveGame coded;
+  return readCoded(in, &coded) && decode(coded, adaptive, game);
+}
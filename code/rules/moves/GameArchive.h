@@ -0,0 +1,35 @@
+#ifndef GAMEARCHIVE_H_
+#define GAMEARCHIVE_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "./GameCodec.h"
+#include "./Pgn.h"
+
+// A game of an archive, whose moves are still coded, so a reader can skip or hand out games without decoding them
+struct ArchiveGame {
+  std::vector<std::pair<std::string, std::string>> tags;
+  std::string startFen;
+  std::string result;
+  int moveCount;
+  std::string bytes;
+};
+
+// Archive of games, whose moves are coded by GameEncoder. The file starts with the magic "HGA2" and a byte with the
+// model (1 for the adaptive model), then the games follow one after another: the number of tags, the names and values
+// of the tags, the FEN of the start position, the result, the number of moves and the number of coded bytes, then the
+// coded bytes. Numbers are stored as varints with 7 bits per byte, strings with their length before them. Comments
+// and annotation glyphs are not stored.
+class GameArchive {
+ public:
+  static bool writeHeader(std::ostream& out, bool adaptive);
+  static bool readHeader(std::istream& in, bool* adaptive);
+  static bool write(std::ostream& out, const PgnGame& game, bool adaptive);
+  static bool readCoded(std::istream& in, ArchiveGame* game);
+  static bool decode(const ArchiveGame& coded, bool adaptive, PgnGame* game);
+  static bool read(std::istream& in, bool adaptive, PgnGame* game);
+};
+
+#endif  // GAMEARCHIVE_H_
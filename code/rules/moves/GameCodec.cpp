@@ -0,0 +1,399 @@
+#include "./GameCodec.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Bytes of the range coder, the range is renormalized below 2^24
+static constexpr uint32_t topValue = 1u << 24;
+
+/**
+ * @brief Constructs a RangeEncoder.
+ *
+ * @param pOutput The string, the encoded bytes are appended to.
+ */
+RangeEncoder::RangeEncoder(std::string* pOutput)
+    : output(pOutput), low(0), range(0xFFFFFFFF), cache(0), cacheSize(1) {}
+
+/**
+ * Encodes a symbol.
+ *
+ * @param symbolLow The sum of the frequencies of the symbols before it.
+ * @param frequency The frequency of the symbol.
+ * @param total The sum of all frequencies.
+ */
+void RangeEncoder::encode(uint32_t symbolLow, uint32_t frequency, uint32_t total) {
+  uint32_t step = range / total;
+  low += (uint64_t)step * symbolLow;
+  range = step * frequency;
+  while (range < topValue) {
+    range <<= 8;
+    shiftLow();
+  }
+}
+
+/**
+ * Writes the rest of the state, after the last symbol.
+ */
+void RangeEncoder::finish() {
+  for (int i = 0; i < 5; i++) shiftLow();
+}
+
+/**
+ * Writes the top byte of low. Bytes of 0xFF are held back, until it is known if a carry reaches them.
+ */
+void RangeEncoder::shiftLow() {
+  if ((uint32_t)low < 0xFF000000u || (low >> 32) != 0) {
+    uint8_t carry = low >> 32;
+    uint8_t next = cache;
+    do {
+      *output += (char)(uint8_t)(next + carry);
+      next = 0xFF;
+    } while (--cacheSize != 0);
+    cache = (low >> 24) & 0xFF;
+  }
+  cacheSize++;
+  low = (low & 0x00FFFFFF) << 8;
+}
+
+/**
+ * @brief Constructs a RangeDecoder, which reads the bytes of a RangeEncoder.
+ */
+RangeDecoder::RangeDecoder(const uint8_t* pData, size_t pSize)
+    : data(pData), size(pSize), position(0), code(0), range(0xFFFFFFFF), step(1) {
+  for (int i = 0; i < 5; i++) code = (code << 8) | nextByte();
+}
+
+/**
+ * Returns the cumulative frequency, which the next symbol covers. Must be followed by decode with that symbol.
+ */
+uint32_t RangeDecoder::getTarget(uint32_t total) {
+  step = range / total;
+  return std::min(code / step, total - 1);
+}
+
+/**
+ * Removes the symbol, which covers the target of getTarget.
+ */
+void RangeDecoder::decode(uint32_t symbolLow, uint32_t frequency) {
+  code -= step * symbolLow;
+  range = step * frequency;
+  while (range < topValue) {
+    code = (code << 8) | nextByte();
+    range <<= 8;
+  }
+}
+
+/**
+ * @brief Returns true if more bytes were read than the data holds, so the data is damaged.
+ */
+bool RangeDecoder::isOverrun() { return position > size; }
+
+/**
+ * Reads the next byte, or 0 after the end of the data.
+ */
+uint8_t RangeDecoder::nextByte() {
+  uint8_t value = position < size ? data[position] : 0;
+  position++;
+  return value;
+}
+
+/**
+ * @brief Constructs a MoveModel with the initial frequencies.
+ *
+ * @param pAdaptive True to learn the frequencies from the coded indices, false for the static model.
+ */
+MoveModel::MoveModel(bool pAdaptive) : adaptive(pAdaptive) {
+  // About the distribution of the indices in engine games, where most moves are among the first of the order
+  for (int i = 0; i < symbols; i++) frequencies[i] = std::max(1, 4000 / (i + 3) - 60);
+  build();
+}
+
+/**
+ * Returns the range of an index among the first count indices.
+ */
+void MoveModel::getRange(int index, int count, uint32_t* low, uint32_t* frequency, uint32_t* total) {
+  *low = getLow(index);
+  *frequency = frequencies[index];
+  *total = getLow(count);
+}
+
+/**
+ * Returns the sum of the frequencies of the first count indices.
+ */
+uint32_t MoveModel::getTotal(int count) { return getLow(count); }
+
+/**
+ * Finds the index, whose range covers a cumulative frequency, by descending the Fenwick tree.
+ *
+ * @return The index, or -1 if the target is beyond the first count indices.
+ */
+int MoveModel::find(uint32_t target, int count, uint32_t* low, uint32_t* frequency) {
+  if (target >= getLow(count)) return -1;
+  int index = 0;
+  uint32_t below = 0;
+  for (int step = symbols; step > 0; step >>= 1) {
+    if (index + step <= symbols && below + tree[index + step] <= target) {
+      index += step;
+      below += tree[index];
+    }
+  }
+  *low = below;
+  *frequency = frequencies[index];
+  return index;
+}
+
+/**
+ * Learns a coded index in the adaptive model. The frequencies are halved, before their sum gets too large for the
+ * range coder.
+ */
+void MoveModel::update(int index) {
+  if (!adaptive) return;
+  frequencies[index] += 32;
+  for (int i = index + 1; i <= symbols; i += i & -i) tree[i] += 32;
+  if (getLow(symbols) < 60000) return;
+  for (int i = 0; i < symbols; i++) frequencies[i] = std::max(1, frequencies[i] / 2);
+  build();
+}
+
+/**
+ * Returns the sum of the frequencies of the indices below index.
+ */
+uint32_t MoveModel::getLow(int index) {
+  uint32_t low = 0;
+  for (int i = index; i > 0; i -= i & -i) low += tree[i];
+  return low;
+}
+
+/**
+ * Builds the Fenwick tree from the frequencies.
+ */
+void MoveModel::build() {
+  memset(tree, 0, sizeof(tree));
+  for (int i = 1; i <= symbols; i++) {
+    tree[i] += frequencies[i - 1];
+    int parent = i + (i & -i);
+    if (parent <= symbols) tree[parent] += tree[i];
+  }
+}
+
+/**
+ * Returns the score of a piece for the order of the moves. The values are those of Piece::getExchangeValue, but kept
+ * here, since the order of the moves is part of the archive format: changing them would make the archives, which were
+ * already written, unreadable.
+ */
+static int getOrderValue(char piece) {
+  switch (piece | 32) {
+    case 'p':
+      return 100;
+    case 'n':
+      return 320;
+    case 'b':
+      return 330;
+    case 'r':
+      return 500;
+    case 'q':
+      return 900;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Checks if a square is attacked by a pawn of the opponent.
+ *
+ * @param turn True if white is to move, so the black pawns attack.
+ */
+static bool isPawnAttacked(const std::string& board, int square, bool turn) {
+  int y = square / 8 + (turn ? -1 : 1), x = square % 8;
+  if (y < 0 || y > 7) return false;
+  char pawn = turn ? 'p' : 'P';
+  return (x > 0 && board[y * 8 + x - 1] == pawn) || (x < 7 && board[y * 8 + x + 1] == pawn);
+}
+
+/**
+ * @brief Constructs a MoveOrder, which scores the pseudo-legal moves of a position in the order of the codec:
+ * recaptures, captures by the most valuable victim and the least valuable attacker, queen promotions, castling, then
+ * the quiet moves, which centralize or advance a piece the most. Equal moves are ordered by their bits, so the order
+ * does not depend on the move generator.
+ *
+ * @param pPiece The move generator.
+ * @param pPosition The position, which must outlive the MoveOrder.
+ */
+MoveOrder::MoveOrder(Piece* pPiece, const Position& pPosition)
+    : piece(pPiece), position(pPosition), inCheck(pPiece->testCheck(pPosition.board, pPosition.turn)), read(0) {
+  MoveList moves;
+  piece->testPseudoLegalMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+  count = moves.size();
+  int lastTo = position.lastMove.isNull() ? -1 : position.lastMove.getTo();
+  for (int i = 0; i < count; i++) {
+    Move move = moves[i];
+    int from = move.getFrom(), to = move.getTo();
+    char moved = position.board[from];
+    int score = 0;
+    if (move.isCapture()) {
+      int victim = move.isEnPassant() ? 100 : getOrderValue(position.board[to]);
+      score = 10000 + 10 * victim - getOrderValue(moved) / 10 + (to == lastTo ? 5000 : 0);
+    }
+    if (move.isPromotion()) score += (move.getType() & 3) == 3 ? 9000 : -5000;
+    if (move.isCastling()) score += 300;
+    if (!move.isCapture() && !move.isPromotion() && !move.isCastling()) {
+      // Distance to the center, from 0 in the center to 12 in the corners
+      int fromCenter = abs(2 * (from % 8) - 7) + abs(2 * (from / 8) - 7);
+      int toCenter = abs(2 * (to % 8) - 7) + abs(2 * (to / 8) - 7);
+      static const char* weightedPieces = "pnbrqk";
+      static const int weights[] = {2, 6, 4, 1, 2, -3};
+      int weight = weights[strchr(weightedPieces, moved | 32) - weightedPieces];
+      score += (fromCenter - toCenter) * weight;
+      // Pawns advance towards the promotion
+      if ((moved | 32) == 'p') score += 3 * abs(to / 8 - from / 8);
+    }
+    // Pieces flee from the pawns of the opponent and do not step in front of them
+    if ((moved | 32) != 'p') {
+      int value = getOrderValue(moved);
+      if (isPawnAttacked(position.board, from, position.turn)) score += value / 4;
+      if (isPawnAttacked(position.board, to, position.turn)) score -= value / 2;
+    }
+    keys[i] = ((uint64_t)(score + 100000) << 16) | (uint16_t)~move.getData();
+  }
+  std::make_heap(keys, keys + count);
+}
+
+/**
+ * @brief Returns the number of pseudo-legal moves, which bounds the index of a legal move.
+ */
+int MoveOrder::getCandidateCount() { return count; }
+
+/**
+ * Returns the legal move at an index of the order.
+ *
+ * @return The move, or a null move if the position has fewer legal moves.
+ */
+Move MoveOrder::getMove(int index) {
+  Move move;
+  while (next(&move)) {
+    if (index-- == 0) return move;
+  }
+  return Move();
+}
+
+/**
+ * Returns the index of a move among the legal moves in the order.
+ *
+ * @return The index, or -1 if the move is not legal.
+ */
+int MoveOrder::getIndex(Move move) {
+  Move candidate;
+  for (int index = 0; next(&candidate); index++) {
+    if (candidate == move) return index;
+  }
+  return -1;
+}
+
+/**
+ * Takes the best of the remaining moves from the heap and returns it, if it is legal. Illegal moves are skipped.
+ *
+ * @return False after the last legal move.
+ */
+bool MoveOrder::next(Move* move) {
+  while (read < count) {
+    // The keys, which were not read yet, form a heap with the best move on top
+    std::pop_heap(keys, keys + count - read);
+    uint16_t data = ~(uint16_t)keys[count - 1 - read++];
+    Move candidate(data & 63, (data >> 6) & 63, data >> 12);
+    if (piece->isLegal(position.board, position.turn, candidate, inCheck)) {
+      *move = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Constructs a GameEncoder.
+ *
+ * @param start The start position of the game.
+ * @param adaptive True for the adaptive model, false for the static model.
+ */
+GameEncoder::GameEncoder(const Position& start, bool adaptive)
+    : position(start), model(adaptive), encoder(&bytes), moveCount(0) {}
+
+/**
+ * Encodes the next move of the game.
+ *
+ * @param move The move.
+ * @return True if the move was encoded, false if it is not legal.
+ */
+bool GameEncoder::add(Move move) {
+  MoveOrder order(&piece, position);
+  int index = order.getIndex(move);
+  if (index < 0) return false;
+  uint32_t low, frequency, total;
+  model.getRange(index, order.getCandidateCount(), &low, &frequency, &total);
+  encoder.encode(low, frequency, total);
+  model.update(index);
+  // Swapping keeps the buffer of the board of the next position, so a move does not allocate
+  position.makeMove(&piece, move, &nextPosition);
+  std::swap(position, nextPosition);
+  moveCount++;
+  return true;
+}
+
+/**
+ * Finishes the encoding.
+ *
+ * @return The encoded bytes.
+ */
+const std::string& GameEncoder::finish() {
+  encoder.finish();
+  return bytes;
+}
+
+/**
+ * @brief Getters of the GameEncoder class.
+ *
+ * */
+int GameEncoder::getMoveCount() { return moveCount; }
+
+/**
+ * @brief Constructs a GameDecoder.
+ *
+ * @param start The start position of the game.
+ * @param adaptive True for the adaptive model, false for the static model, like the encoder.
+ * @param data The encoded bytes, which must stay valid while decoding.
+ * @param size The number of bytes.
+ * @param pMoveCount The number of moves of the game.
+ */
+GameDecoder::GameDecoder(const Position& start, bool adaptive, const uint8_t* data, size_t size, int pMoveCount)
+    : position(start), model(adaptive), decoder(data, size), moveCount(pMoveCount) {}
+
+/**
+ * Decodes the next move, and makes it on the position of the decoder.
+ *
+ * @param move Set to the move.
+ * @return True if a move was decoded, false after the last move or if the data is damaged.
+ */
+bool GameDecoder::next(Move* move) {
+  if (moveCount == 0) return false;
+  MoveOrder order(&piece, position);
+  int count = order.getCandidateCount();
+  if (count == 0) return false;
+  uint32_t low, frequency;
+  int index = model.find(decoder.getTarget(model.getTotal(count)), count, &low, &frequency);
+  if (index < 0) return false;
+  decoder.decode(low, frequency);
+  if (decoder.isOverrun()) return false;
+  *move = order.getMove(index);
+  if (move->isNull()) return false;
+  model.update(index);
+  position.makeMove(&piece, *move, &nextPosition);
+  std::swap(position, nextPosition);
+  moveCount--;
+  return true;
+}
+
+/**
+ * @brief Getters of the GameDecoder class.
+ *
+ * */
+const Position& GameDecoder::getPosition() { return position; }
@@ -0,0 +1,132 @@
+#ifndef GAMECODEC_H_
+#define GAMECODEC_H_
+
+#include <cstdint>
+#include <string>
+
+#include "../board/Position.h"
+#include "./Move.h"
+
+// Range coder with carry propagation: a symbol with the cumulative frequency low and the frequency frequency out of
+// total narrows the range. The totals must stay below 2^16.
+class RangeEncoder {
+ public:
+  explicit RangeEncoder(std::string* pOutput);
+
+  void encode(uint32_t low, uint32_t frequency, uint32_t total);
+  void finish();
+
+ private:
+  void shiftLow();
+
+  std::string* output;
+  uint64_t low;
+  uint32_t range;
+  uint8_t cache;
+  uint64_t cacheSize;
+};
+
+class RangeDecoder {
+ public:
+  RangeDecoder(const uint8_t* pData, size_t pSize);
+
+  uint32_t getTarget(uint32_t total);
+  void decode(uint32_t low, uint32_t frequency);
+  bool isOverrun();
+
+ private:
+  uint8_t nextByte();
+
+  const uint8_t* data;
+  size_t size;
+  size_t position;
+  uint32_t code;
+  uint32_t range;
+  uint32_t step;
+};
+
+// Frequencies of the move indices. The static model keeps the initial frequencies, which fall with the index, since
+// the order puts the likely moves first. The adaptive model starts from them and learns the indices of the game.
+// The cumulative frequencies are kept in a Fenwick tree, so a range and a lookup take O(log n).
+class MoveModel {
+ public:
+  static constexpr int symbols = MoveList::capacity;
+
+  explicit MoveModel(bool pAdaptive);
+
+  void getRange(int index, int count, uint32_t* low, uint32_t* frequency, uint32_t* total);
+  uint32_t getTotal(int count);
+  int find(uint32_t target, int count, uint32_t* low, uint32_t* frequency);
+  void update(int index);
+
+ private:
+  uint32_t getLow(int index);
+  void build();
+
+  bool adaptive;
+  uint16_t frequencies[symbols];
+  // tree[i] holds the sum of the frequencies of the indices from i - (i & -i) to i - 1
+  uint32_t tree[symbols + 1];
+};
+
+// The moves of a position in the order of the codec. The pseudo-legal moves are scored at once, but only taken from a
+// heap and tested for legality as far as they are read, since most coded moves are among the first of the order.
+class MoveOrder {
+ public:
+  MoveOrder(Piece* pPiece, const Position& pPosition);
+
+  int getCandidateCount();
+  Move getMove(int index);
+  int getIndex(Move move);
+
+ private:
+  bool next(Move* move);
+
+  Piece* piece;
+  const Position& position;
+  bool inCheck;
+  uint64_t keys[MoveList::capacity];
+  int count;
+  int read;
+};
+
+// Codec of the moves of a game: every move is stored as its index in the legal moves of its position, ordered by
+// MoveOrder, and the indices are entropy coded with a range coder, out of the number of pseudo-legal moves. Games of
+// the engine need about half a byte per move. The order is part of the format, so changing it needs a new version of
+// the archive. The encoder takes a game move by move.
+class GameEncoder {
+ public:
+  GameEncoder(const Position& start, bool adaptive);
+
+  bool add(Move move);
+  const std::string& finish();
+  int getMoveCount();
+
+ private:
+  Piece piece;
+  Position position;
+  Position nextPosition;
+  MoveModel model;
+  std::string bytes;
+  RangeEncoder encoder;
+  int moveCount;
+};
+
+// Decodes the moves of a game one by one, the number of moves is stored outside of the codec
+class GameDecoder {
+ public:
+  GameDecoder(const Position& start, bool adaptive, const uint8_t* data, size_t size, int pMoveCount);
+
+  bool next(Move* move);
+  const Position& getPosition();
+
+ private:
+  Piece piece;
+  Position position;
+  Position nextPosition;
+  MoveModel model;
+  RangeDecoder decoder;
+  int moveCount;
+};
+
+#endif  // GAMECODEC_H_
@@ -0,0 +1,142 @@
+#ifndef MOVE_H_
+#define MOVE_H_
+
+#include <cstdint>
+
+/**
+ * A move packed into 16 bits: the Move-From square (bits 0-5), the Move-To square (bits 6-11) and the type of the move
+ * (bits 12-15). Squares are board indices (y * 8 + x). Castling moves go from the king to the own rook, the same way
+ * the king is dragged onto the rook on the board.
+ *
+ * The methods are defined in the header, since moves are created and read in the innermost loops of the move
+ * generation.
+ */
+class Move {
+ public:
+  // Move types. Bit 2 marks captures, bit 3 promotions, the lower two bits of a promotion select the piece.
+  enum Type {
+    Quiet = 0,
+    DoublePush = 1,
+    KingCastle = 2,
+    QueenCastle = 3,
+    Capture = 4,
+    EnPassant = 5,
+    KnightPromotion = 8,
+    BishopPromotion = 9,
+    RookPromotion = 10,
+    QueenPromotion = 11,
+    KnightPromotionCapture = 12,
+    BishopPromotionCapture = 13,
+    RookPromotionCapture = 14,
+    QueenPromotionCapture = 15
+  };
+
+  Move() : data(0) {}
+  Move(int from, int to, int type) : data(from | (to << 6) | (type << 12)) {}
+
+  /**
+   * @brief Getters of the Move class.
+   *
+   * */
+  int getFrom() const { return data & 63; }
+  int getTo() const { return (data >> 6) & 63; }
+  int getType() const { return data >> 12; }
+  uint16_t getData() const { return data; }
+  bool isNull() const { return data == 0; }
+  bool isCapture() const { return (data >> 12) & Capture; }
+  bool isPromotion() const { return (data >> 12) & KnightPromotion; }
+  bool isEnPassant() const { return getType() == EnPassant; }
+  bool isDoublePush() const { return getType() == DoublePush; }
+  bool isCastling() const { return getType() == KingCastle || getType() == QueenCastle; }
+
+  /**
+   * Returns the piece, a pawn is promoted to.
+   *
+   * @param white True for a white pawn, false for a black pawn.
+   * @return The piece character in the case of the player, or ' ' if the move is no promotion.
+   */
+  char getPromotionPiece(bool white) const {
+    if (!isPromotion()) return ' ';
+    char piece = "nbrq"[getType() & 3];
+    return white ? piece - 'a' + 'A' : piece;
+  }
+
+  /**
+   * Returns a copy of this promotion move, promoting to another piece.
+   *
+   * @param piece The piece to promote to, in any case ('Q', 'r', ...).
+   * @return The changed move, or a null move if the piece can not be promoted to.
+   */
+  Move withPromotionPiece(char piece) const {
+    int index;
+    switch (piece | 32) {
+      case 'n':
+        index = 0;
+        break;
+      case 'b':
+        index = 1;
+        break;
+      case 'r':
+        index = 2;
+        break;
+      case 'q':
+        index = 3;
+        break;
+      default:
+        return Move();
+    }
+    return Move(getFrom(), getTo(), (getType() & ~3) | index);
+  }
+
+  bool operator==(Move other) const { return data == other.data; }
+  bool operator!=(Move other) const { return data != other.data; }
+
+ private:
+  uint16_t data;
+};
+
+/**
+ * A list of moves with a fixed capacity, which is stored inline, so a list on the stack needs no heap allocation.
+ * No legal chess position has more than 218 moves, so the capacity can not be exceeded.
+ */
+class MoveList {
+ public:
+  static constexpr int capacity = 256;
+
+  MoveList() : count(0) {}
+
+  void add(Move move) { moves[count++] = move; }
+  void clear() { count = 0; }
+
+  /**
+   * Finds the first move between two squares. Promotions are generated with the queen first, so this returns the
+   * queen promotion for a pawn reaching the last rank.
+   *
+   * @param from The Move-From square.
+   * @param to The Move-To square.
+   * @return The move, or a null move if the list contains no such move.
+   */
+  Move find(int from, int to) const {
+    for (int i = 0; i < count; i++) {
+      if (moves[i].getFrom() == from && moves[i].getTo() == to) return moves[i];
+    }
+    return Move();
+  }
+
+  /**
+   * @brief Getters of the MoveList class.
+   *
+   * */
+  int size() const { return count; }
+  bool isEmpty() const { return count == 0; }
+  Move operator[](int index) const { return moves[index]; }
+  Move& operator[](int index) { return moves[index]; }
+  const Move* begin() const { return moves; }
+  const Move* end() const { return moves + count; }
+
+ private:
+  Move moves[capacity];
+  int count;
+};
+
+#endif  // MOVE_H_
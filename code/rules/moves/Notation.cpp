@@ -0,0 +1,140 @@
+#include "./Notation.h"
+
+#include <cctype>
+
+/**
+ * Returns the name of a square in algebraic notation.
+ *
+ * @param square The index of the square (y * 8 + x).
+ * @return The name, like "e4".
+ */
+std::string Notation::squareName(int square) {
+  std::string name = "a1";
+  name[0] = 'a' + square % 8;
+  name[1] = '8' - square / 8;
+  return name;
+}
+
+/**
+ * Writes a legal move in standard algebraic notation, with the file or rank of the piece, if another piece of the
+ * same type can move to the same square, and with "+" or "#", if the move gives check or mate.
+ *
+ * @param position The position before the move.
+ * @param move A legal move of the position.
+ * @return The move in SAN.
+ */
+std::string Notation::toSan(const Position& position, Move move) {
+  Piece piece;
+  std::string san;
+  int from = move.getFrom();
+  int to = move.getTo();
+  char type = toupper(position.board[from]);
+
+  if (move.isCastling()) {
+    san = move.getType() == Move::KingCastle ? "O-O" : "O-O-O";
+  } else if (type == 'P') {
+    if (move.isCapture()) {
+      san += 'a' + from % 8;
+      san += 'x';
+    }
+    san += squareName(to);
+    if (move.isPromotion()) {
+      san += '=';
+      san += move.getPromotionPiece(true);
+    }
+  } else {
+    san += type;
+    // Other pieces of the same type, which can move to the same square
+    MoveList moves;
+    piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+    bool ambiguous = false, sameFile = false, sameRank = false;
+    for (Move other : moves) {
+      if (other.getTo() != to || other.getFrom() == from || other.isCastling()) continue;
+      if (position.board[other.getFrom()] != position.board[from]) continue;
+      ambiguous = true;
+      if (other.getFrom() % 8 == from % 8) sameFile = true;
+      if (other.getFrom() / 8 == from / 8) sameRank = true;
+    }
+    if (ambiguous && (!sameFile || sameRank)) san += 'a' + from % 8;
+    if (ambiguous && sameFile) san += '8' - from / 8;
+    if (move.isCapture()) san += 'x';
+    san += squareName(to);
+  }
+
+  Position next;
+  position.makeMove(&piece, move, &next);
+  if (piece.testCheck(next.board, next.turn))
+    san += piece.hasLegalMove(next.board, next.turn, next.lastMove, next.castling) ? "+" : "#";
+  return san;
+}
+
+/**
+ * Finds the legal move, which is written in standard algebraic notation. Check and annotation marks are ignored, and
+ * castling may be written with zeros.
+ *
+ * @param position The position before the move.
+ * @param san The move in SAN.
+ * @return The move, or a null move if no legal move matches.
+ */
+Move Notation::fromSan(const Position& position, const std::string& san) {
+  std::string text;
+  for (char c : san) {
+    if (c == '+' || c == '#' || c == '!' || c == '?') continue;
+    text += c == '0' ? 'O' : c;
+  }
+  if (text.empty()) return Move();
+
+  Piece piece;
+  MoveList moves;
+  piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+  for (Move move : moves) {
+    std::string candidate = toSan(position, move);
+    while (!candidate.empty() && (candidate.back() == '+' || candidate.back() == '#')) candidate.pop_back();
+    if (candidate == text) return move;
+  }
+  // Some writers always add the file or rank of the piece, so compare the squares as well
+  for (Move move : moves) {
+    char type = toupper(position.board[move.getFrom()]);
+    if (move.isCastling() || type == 'P' || text[0] != type || text.size() < 3) continue;
+    if (text.substr(text.size() - 2) != squareName(move.getTo())) continue;
+    std::string hint = text.substr(1, text.size() - 3);
+    if (!hint.empty() && hint.back() == 'x') hint.pop_back();
+    if (hint == squareName(move.getFrom()) || (hint.size() == 1 && squareName(move.getFrom()).find(hint) == 0) ||
+        (hint.size() == 1 && squareName(move.getFrom())[1] == hint[0]))
+      return move;
+  }
+  return Move();
+}
+
+/**
+ * Writes a move in UCI coordinate notation. Castling is written as the two squares of the king.
+ *
+ * @param move The move.
+ * @return The move, like "e2e4", "e1g1" or "e7e8q", or "0000" for a null move.
+ */
+std::string Notation::toUci(Move move) {
+  if (move.isNull()) return "0000";
+  int to = move.getTo();
+  if (move.getType() == Move::KingCastle) to = move.getFrom() / 8 * 8 + 6;
+  if (move.getType() == Move::QueenCastle) to = move.getFrom() / 8 * 8 + 2;
+  std::string uci = squareName(move.getFrom()) + squareName(to);
+  if (move.isPromotion()) uci += move.getPromotionPiece(false);
+  return uci;
+}
+
+/**
+ * Finds the legal move, which is written in UCI coordinate notation.
+ *
+ * @param position The position before the move.
+ * @param uci The move in UCI notation.
+ * @return The move, or a null move if no legal move matches.
+ */
+Move Notation::fromUci(const Position& position, const std::string& uci) {
+  Piece piece;
+  MoveList moves;
+  piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+  for (Move move : moves) {
+    if (toUci(move) == uci) return move;
+  }
+  return Move();
+}
@@ -0,0 +1,20 @@
+#ifndef NOTATION_H_
+#define NOTATION_H_
+
+#include <string>
+
+#include "../board/Position.h"
+#include "./Move.h"
+
+// Conversion of moves from and to standard algebraic notation (SAN, like "Nf3" or "exd8=Q+") and the coordinate
+// notation of the UCI protocol (like "g1f3" or "e1g1" for castling).
+class Notation {
+ public:
+  static std::string toSan(const Position& position, Move move);
+  static Move fromSan(const Position& position, const std::string& san);
+  static std::string toUci(Move move);
+  static Move fromUci(const Position& position, const std::string& uci);
+  static std::string squareName(int square);
+};
+
+#endif  // NOTATION_H_
@@ -0,0 +1,181 @@
+#include "./Pgn.h"
+
+#include <cctype>
+
+#include "./Notation.h"
+
+/**
+ * @brief Constructs an empty game, which starts from the standard starting position.
+ */
+PgnGame::PgnGame() : result("*") {}
+
+/**
+ * Returns the value of a tag.
+ *
+ * @param name The name of the tag, like "White".
+ * @return The value, or an empty string if the game has no such tag.
+ */
+std::string PgnGame::getTag(const std::string& name) const {
+  for (const auto& tag : tags) {
+    if (tag.first == name) return tag.second;
+  }
+  return "";
+}
+
+/**
+ * Sets the value of a tag, which is added after the existing tags if the game does not have it yet.
+ *
+ * @param name The name of the tag.
+ * @param value The new value.
+ */
+void PgnGame::setTag(const std::string& name, const std::string& value) {
+  for (auto& tag : tags) {
+    if (tag.first == name) {
+      tag.second = value;
+      return;
+    }
+  }
+  tags.push_back({name, value});
+}
+
+/**
+ * Returns the position, the game starts from.
+ */
+Position PgnGame::getStartPosition() const {
+  Position position;
+  if (!startFen.empty()) position.setFen(startFen);
+  return position;
+}
+
+/**
+ * Reads the next game from a PGN stream. Variations are skipped, comments and annotation glyphs are kept with the
+ * move before them. Reading stops at the result or at the start of the next game.
+ *
+ * @param in The stream to read from.
+ * @param game Receives the game.
+ * @return True if a game was read, false at the end of the stream or if a move is not legal.
+ */
+bool Pgn::read(std::istream& in, PgnGame* game) {
+  *game = PgnGame();
+  Piece piece;
+  Position position;
+  bool started = false;
+  int variation = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '%') continue;
+
+    // Tags, like [White "Name"]
+    if (line[0] == '[' && variation == 0) {
+      size_t space = line.find(' ');
+      size_t open = line.find('"');
+      size_t close = line.rfind('"');
+      if (space == std::string::npos || open == std::string::npos || close <= open) continue;
+      game->setTag(line.substr(1, space - 1), line.substr(open + 1, close - open - 1));
+      if (line.substr(1, space - 1) == "FEN") {
+        game->startFen = game->getTag("FEN");
+        if (!position.setFen(game->startFen)) return false;
+      }
+      started = true;
+      continue;
+    }
+
+    for (size_t i = 0; i < line.size();) {
+      char c = line[i];
+      if (isspace((unsigned char)c)) {
+        i++;
+      } else if (c == '{') {
+        // Comments may span several lines
+        std::string comment;
+        size_t start = i + 1;
+        size_t close = line.find('}', i);
+        while (close == std::string::npos) {
+          comment += line.substr(start) + " ";
+          if (!std::getline(in, line)) return false;
+          start = 0;
+          close = line.find('}');
+        }
+        comment += line.substr(start, close - start);
+        if (variation == 0 && !game->moves.empty()) game->comments.back() = comment;
+        i = close + 1;
+      } else if (c == ';') {
+        break;
+      } else if (c == '(') {
+        variation++;
+        i++;
+      } else if (c == ')') {
+        variation--;
+        i++;
+      } else {
+        size_t end = i;
+        while (end < line.size() && !isspace((unsigned char)line[end]) && line[end] != '{' && line[end] != '(' &&
+               line[end] != ')')
+          end++;
+        std::string token = line.substr(i, end - i);
+        i = end;
+        started = true;
+        if (variation > 0) continue;
+        if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+          game->result = token;
+          return true;
+        }
+        if (token[0] == '$') {
+          if (!game->moves.empty()) game->nags.back() = std::stoi(token.substr(1));
+          continue;
+        }
+        // Move numbers, like "12." or "12..."
+        size_t dot = token.find_last_of('.');
+        if (isdigit((unsigned char)token[0])) {
+          if (dot == std::string::npos) continue;
+          token = token.substr(dot + 1);
+          if (token.empty()) continue;
+        }
+        Move move = Notation::fromSan(position, token);
+        if (move.isNull()) return false;
+        Position next;
+        position.makeMove(&piece, move, &next);
+        position = next;
+        game->moves.push_back(move);
+        game->comments.push_back("");
+        game->nags.push_back(0);
+      }
+    }
+  }
+  return started;
+}
+
+/**
+ * Writes a game in PGN, with the moves in SAN and lines of at most 80 characters.
+ *
+ * @param out The stream to write to.
+ * @param game The game.
+ */
+void Pgn::write(std::ostream& out, const PgnGame& game) {
+  for (const auto& tag : game.tags) out << "[" << tag.first << " \"" << tag.second << "\"]\n";
+  out << "\n";
+
+  Position position = game.getStartPosition();
+  std::string line;
+  auto append = [&](const std::string& token) {
+    if (!line.empty() && line.size() + 1 + token.size() > 80) {
+      out << line << "\n";
+      line.clear();
+    }
+    line += (line.empty() ? "" : " ") + token;
+  };
+  Piece piece;
+  int number = 1;
+  for (int i = 0; i < game.moves.size(); i++) {
+    if (position.turn || i == 0) append(std::to_string(number) + (position.turn ? "." : "..."));
+    if (!position.turn) number++;
+    append(Notation::toSan(position, game.moves[i]));
+    if (i < game.nags.size() && game.nags[i] != 0) append("$" + std::to_string(game.nags[i]));
+    if (i < game.comments.size() && !game.comments[i].empty()) append("{" + game.comments[i] + "}");
+    Position next;
+    position.makeMove(&piece, game.moves[i], &next);
+    position = next;
+  }
+  append(game.result);
+  out << line << "\n\n";
+}
@@ -0,0 +1,37 @@
+#ifndef PGN_H_
+#define PGN_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../board/Position.h"
+#include "./Move.h"
+
+// A game in Portable Game Notation: the tags, the start position, the moves and the result. Comments and numeric
+// annotation glyphs (like $2 for "?") belong to the move before them, empty strings and 0 mean none.
+struct PgnGame {
+  std::vector<std::pair<std::string, std::string>> tags;
+  // FEN of the start position, empty for the standard starting position
+  std::string startFen;
+  std::vector<Move> moves;
+  std::vector<std::string> comments;
+  std::vector<int> nags;
+  std::string result;
+
+  PgnGame();
+
+  std::string getTag(const std::string& name) const;
+  void setTag(const std::string& name, const std::string& value);
+  Position getStartPosition() const;
+};
+
+class Pgn {
+ public:
+  static bool read(std::istream& in, PgnGame* game);
+  static void write(std::ostream& out, const PgnGame& game);
+};
+
+#endif  // PGN_H_
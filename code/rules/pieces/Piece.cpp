@@ -1,25 +1,27 @@
 #include "./Piece.h"
 
-/**
- * @brief Default constructor for the Piece class.
- *
- * Initializes a new instance of the Piece class with the passant flag set to false.
- */
-Piece::Piece() : passant(false) {}
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 
-/**
- * Returns the passant status of the piece.
- *
- * @return true if the piece is passant, false otherwise.
- */
-bool Piece::getPassant() { return passant; }
+#include "../../profiling/AllocationProfiler.h"
+#include "../../profiling/Trace.h"
+
+// Directions of the sliding pieces as {x, y} steps
+static const int straight[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int diagonal[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+static const int knightJumps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+static const int kingSteps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
 
 /**
- * Sets the passant flag for the piece.
+ * @brief Default constructor for the Piece class.
  *
- * @param pPassant The value to set for the passant flag.
+ * The Piece class holds no state, all information about the position is passed to the functions.
  */
-void Piece::setPassant(bool pPassant) { passant = pPassant; }
+Piece::Piece() {}
+
+Piece::~Piece() {}
 
 /**
  * Returns the value of a chess piece, Adjusted to validifying insufficient material checks.
@@ -44,284 +46,503 @@ int Piece::getValue(char piece) {
   }
 }
 
+/**
+ * Returns the value of a chess piece in centipawns, as used for exchanges. The king is worth more than all other
+ * pieces together, so it is only ever the last piece to capture.
+ *
+ * @param piece The character representing the chess piece.
+ * @return The value of the chess piece.
+ */
+int Piece::getExchangeValue(char piece) {
+  switch (tolower(piece)) {
+    case 'p':
+      return 100;
+    case 'n':
+      return 320;
+    case 'b':
+      return 330;
+    case 'r':
+      return 500;
+    case 'q':
+      return 900;
+    case 'k':
+      return 20000;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Static exchange evaluation: resolves the sequence of captures on the target square of a move, without generating
+ * or making any other moves. Both players always recapture with their least valuable piece and may stop capturing,
+ * whenever that is better for them. Pieces are removed from a copy of the board as they capture, so sliding pieces
+ * behind them (x-ray attackers) join the exchange. Pins are ignored, a king only captures if the square is no longer
+ * attacked afterwards.
+ *
+ * @param board The current state of the chessboard represented as a string.
+ * @param move The move to evaluate, usually a capture of the player to move.
+ * @return The material the moving player wins (positive) or loses (negative) in centipawns. 0 for castling.
+ */
+int Piece::see(const string& board, Move move) {
+  if (move.isCastling()) return 0;
+  char copy[64];
+  memcpy(copy, board.data(), 64);
+  int from = move.getFrom();
+  int to = move.getTo();
+  bool white = isupper(copy[from]) != 0;
+
+  // gain[i] is the material of the player making the i-th capture, if the exchange ends after it
+  int gain[32];
+  int depth = 0;
+  char mover = move.isPromotion() ? move.getPromotionPiece(white) : copy[from];
+  if (move.isEnPassant()) {
+    gain[0] = getExchangeValue('p');
+    copy[from / 8 * 8 + to % 8] = ' ';
+  } else {
+    gain[0] = getExchangeValue(copy[to]);
+  }
+  if (move.isPromotion()) gain[0] += getExchangeValue(mover) - getExchangeValue('p');
+  copy[from] = ' ';
+  copy[to] = mover;
+
+  bool side = !white;
+  while (depth < 31) {
+    int attacker = leastValuableAttacker(copy, to, side);
+    if (attacker < 0) break;
+    char capturer = copy[attacker];
+    copy[attacker] = ' ';
+    // The king may not capture into an attack
+    if (tolower(capturer) == 'k' && leastValuableAttacker(copy, to, !side) >= 0) break;
+
+    depth++;
+    gain[depth] = getExchangeValue(copy[to]) - gain[depth - 1];
+    // Pawns capturing on the last row promote to a queen
+    if (tolower(capturer) == 'p' && (to < 8 || to >= 56)) {
+      capturer = side ? 'Q' : 'q';
+      gain[depth] += getExchangeValue('q') - getExchangeValue('p');
+    }
+    copy[to] = capturer;
+    side = !side;
+  }
+
+  // Every player only continues the exchange, if that is better than stopping
+  while (depth > 0) {
+    gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    depth--;
+  }
+  return gain[0];
+}
+
+/**
+ * Checks if a piece can be won by the opponent, because capturing it with the opponent's least valuable attacker
+ * wins material after all recaptures.
+ *
+ * @param board The current state of the chessboard represented as a string.
+ * @param square The index of the square (y * 8 + x) of the piece.
+ * @return True if the piece is hanging, false otherwise or if the square is empty.
+ */
+bool Piece::isHanging(const string& board, int square) {
+  char target = board[square];
+  if (target == ' ') return false;
+  int attacker = leastValuableAttacker(board.data(), square, islower(target) != 0);
+  if (attacker < 0) return false;
+  Move capture(attacker, square, Move::Capture);
+  if (tolower(board[attacker]) == 'p' && (square < 8 || square >= 56)) capture = capture.withPromotionPiece('q');
+  return see(board, capture) > 0;
+}
+
 /**
  * Checks if the current player's king is in check.
  *
  * @param board The current state of the chessboard represented as a string.
  * @param turn The current player's turn. `true` for white, `false` for black.
- * @param lastMove The last move made on the chessboard.
- * @param castling An array representing the availability of castling for both players.
- *                Index 0 and 1 represent white's castling availability, while index 2 and 3 represent black's castling
- * availability. A value of 1 indicates that castling is available, while a value of 0 indicates that castling is not
+ * @return True if the king is in check, false otherwise or if the player has no king.
+ */
+bool Piece::testCheck(const string& board, bool turn) {
+  const char* king = (const char*)memchr(board.data(), turn ? 'K' : 'k', 64);
+  if (king == nullptr) return false;
+  return attacked(board.data(), king - board.data(), !turn);
+}
+
 /**
- * This function tests if the current player's king is in check.
+ * Checks if a square is attacked by any piece of a player.
+ *
+ * @param board The current state of the chessboard represented as a string.
+ * @param square The index of the square (y * 8 + x).
+ * @param byWhite True to test the white pieces, false to test the black pieces.
+ * @return True if at least one piece of the player attacks the square.
+ */
+bool Piece::isAttacked(const string& board, int square, bool byWhite) {
+  return attacked(board.data(), square, byWhite);
+}
+
+/**
+ * This function calculates the available moves for all pieces of the current player.
  * It takes the current state of the chessboard, the turn, the last move made, and the castling availability as input.
- * It iterates through the chessboard to find the position of the current player's king.
- * Then, it checks if any opponent's piece can capture the king.
- * If a capture is possible, it simulates the move and checks if the king is still in check.
- * If the king is not in check after the move, it means the current player's king is not in check.
- * The function returns true if the king is in check, and false otherwise.
+ * The legal moves are written into the given list, grouped by the Move-From square.
  */
-bool Piece::testCheck(string board, bool turn, string lastMove, int castling[4]) {
-  // Find the position of the current player's king
-  char curKing = turn == 0 ? 'k' : 'K';
-  int width = std::sqrt(board.length());
-  string kingPos = "";
-  for (int i = 0; i < width; i++) {
-    for (int j = 0; j < width; j++) {
-      if (board[i * width + j] == curKing) {
-        string str1(1, j + '0');
-        string str2(1, i + '0');
-        kingPos = str1 + str2;
+void Piece::testAvailableMoves(const string& board, bool turn, Move lastMove, const int castling[4], MoveList* list) {
+  TRACE_SCOPE("Piece::testAvailableMoves");
+  ALLOCATION_SCOPE("legalMoves");
+  list->clear();
+  findMoves(board, turn, lastMove, castling, list, true);
+}
+
+/**
+ * This function calculates the pseudo-legal moves of the current player, in the same order as testAvailableMoves, but
+ * without testing if they leave the own king in check. Castling is still only generated, if the king neither stands in
+ * check nor passes an attacked square.
+ * Callers, which only need a few of the moves, test them with isLegal.
+ */
+void Piece::testPseudoLegalMoves(const string& board, bool turn, Move lastMove, const int castling[4],
+                                 MoveList* list) {
+  TRACE_SCOPE("Piece::testPseudoLegalMoves");
+  list->clear();
+  findMoves(board, turn, lastMove, castling, list, false);
+}
+
+/**
+ * Checks if a pseudo-legal move of testPseudoLegalMoves does not leave the own king in check.
+ * Out of check, only moves of the king, en passant and moves of a pinned piece can expose it, the other moves are
+ * legal without applying them.
+ *
+ * @param board The current state of the chessboard represented as a string.
+ * @param turn True if white is to move.
+ * @param move The pseudo-legal move.
+ * @param inCheck True if the king is in check, as returned by testCheck.
+ * @return True if the move is legal.
+ */
+bool Piece::isLegal(const string& board, bool turn, Move move, bool inCheck) {
+  const char* kingPos = (const char*)memchr(board.data(), turn ? 'K' : 'k', 64);
+  if (kingPos == nullptr) return true;
+  int king = kingPos - board.data();
+  if (!inCheck && move.getFrom() != king && !move.isEnPassant() && !pinned(board.data(), king, move.getFrom(), turn))
+    return true;
+  return leavesKingSafe(board.data(), king, turn, move);
+}
+
+/**
+ * Checks if a piece stands between its king and a sliding piece of the opponent, which would attack the king along
+ * the line, if the piece left it.
+ */
+bool Piece::pinned(const char* board, int king, int square, bool turn) {
+  int dx = square % 8 - king % 8, dy = square / 8 - king / 8;
+  if (dx != 0 && dy != 0 && abs(dx) != abs(dy)) return false;
+  int stepX = (dx > 0) - (dx < 0), stepY = (dy > 0) - (dy < 0);
+  int x = king % 8 + stepX, y = king / 8 + stepY;
+  for (; y * 8 + x != square; x += stepX, y += stepY) {
+    if (board[y * 8 + x] != ' ') return false;
+  }
+  for (x += stepX, y += stepY; x >= 0 && x <= 7 && y >= 0 && y <= 7; x += stepX, y += stepY) {
+    char target = board[y * 8 + x];
+    if (target == ' ') continue;
+    if ((isupper(target) != 0) == turn) return false;
+    char slider = (stepX == 0 || stepY == 0) ? 'r' : 'b';
+    return tolower(target) == slider || tolower(target) == 'q';
+  }
+  return false;
+}
+
+/**
+ * This function checks if the current player has at least one legal move.
+ * It searches the moves in the same order as testAvailableMoves, but stops after the first piece with a legal move,
+ * so for most positions only a few candidate moves have to be tested, instead of the whole move list.
+ * No legal move implicates either a stalemate or a checkmate.
+ */
+bool Piece::hasLegalMove(const string& board, bool turn, Move lastMove, const int castling[4]) {
+  TRACE_SCOPE("Piece::hasLegalMove");
+  ALLOCATION_SCOPE("legalMoves");
+  return findMoves(board, turn, lastMove, castling, nullptr, true);
+}
+
+/**
+ * Applies a move to the board. The move has to be legal in the given position.
+ * Castling moves the king and the rook to their final squares, en passant removes the passed pawn and promotions
+ * replace the pawn with the promoted piece.
+ *
+ * @param board The chessboard represented as a string, which is changed in place.
+ * @param move The move to apply.
+ */
+void Piece::makeMove(string& board, Move move) { make(board.data(), move); }
+
+/**
+ * This function searches the legal moves of the current player.
+ * It iterates through the chessboard to find the current player's pieces and generates the moves of every piece
+ * directly from its movement rules. Every candidate is applied to a copy of the board and only kept, if the own king is
+ * not attacked afterwards.
+ * If a list is given, all legal moves are added to it. Otherwise the search stops after the first piece with a legal
+ * move. Without legal, the candidates are not tested, so the pseudo-legal moves are added.
+ * The function returns true if at least one legal move was found.
+ */
+bool Piece::findMoves(const string& board, bool turn, Move lastMove, const int castling[4], MoveList* list,
+                      bool legal) {
+  // Work on a copy on the stack, so candidate moves can be applied without allocations
+  char squares[64];
+  memcpy(squares, board.data(), 64);
+  const char* kingPos = (const char*)memchr(squares, turn ? 'K' : 'k', 64);
+  int king = kingPos == nullptr || !legal ? -1 : kingPos - squares;
+  bool found = false;
+
+  for (int from = 0; from < 64; from++) {
+    char curPiece = squares[from];
+    if (curPiece == ' ' || (isupper(curPiece) != 0) != turn) continue;
+    int x = from % 8;
+    int y = from / 8;
+
+    switch (tolower(curPiece)) {
+      case 'p': {
+        // White pawns move up the board (decreasing y), black pawns down
+        int dir = turn ? -1 : 1;
+        int y1 = y + dir;
+        if (y1 < 0 || y1 > 7) break;
+        int promotion = (y1 == 0 || y1 == 7) ? Move::KnightPromotion : 0;
+
+        // Pushes, including the double push from the starting position
+        if (squares[y1 * 8 + x] == ' ') {
+          if (promotion) {
+            for (int i = 3; i >= 0; i--)
+              addMove(squares, king, turn, Move(from, y1 * 8 + x, promotion | i), list, &found);
+          } else {
+            addMove(squares, king, turn, Move(from, y1 * 8 + x, Move::Quiet), list, &found);
+          }
+          if (y == (turn ? 6 : 1) && squares[(y + 2 * dir) * 8 + x] == ' ')
+            addMove(squares, king, turn, Move(from, (y + 2 * dir) * 8 + x, Move::DoublePush), list, &found);
+        }
+
+        // Captures
+        for (int dx = -1; dx <= 1; dx += 2) {
+          if (x + dx < 0 || x + dx > 7) continue;
+          int to = y1 * 8 + x + dx;
+          if (squares[to] == ' ' || (isupper(squares[to]) != 0) == turn) continue;
+          if (promotion) {
+            for (int i = 3; i >= 0; i--)
+              addMove(squares, king, turn, Move(from, to, promotion | Move::Capture | i), list, &found);
+          } else {
+            addMove(squares, king, turn, Move(from, to, Move::Capture), list, &found);
+          }
+        }
+
+        // En passant, if the last move was a double push right next to this pawn
+        if (lastMove.isDoublePush() && lastMove.getTo() / 8 == y && abs(lastMove.getTo() % 8 - x) == 1)
+          addMove(squares, king, turn, Move(from, y1 * 8 + lastMove.getTo() % 8, Move::EnPassant), list, &found);
         break;
       }
-    }
-    if (kingPos != "") break;
-  }
+      case 'n':
+      case 'k': {
+        const int(*steps)[2] = tolower(curPiece) == 'n' ? knightJumps : kingSteps;
+        for (int i = 0; i < 8; i++) {
+          int x1 = x + steps[i][0];
+          int y1 = y + steps[i][1];
+          if (x1 < 0 || x1 > 7 || y1 < 0 || y1 > 7) continue;
+          char target = squares[y1 * 8 + x1];
+          if (target == ' ')
+            addMove(squares, king, turn, Move(from, y1 * 8 + x1, Move::Quiet), list, &found);
+          else if ((isupper(target) != 0) != turn)
+            addMove(squares, king, turn, Move(from, y1 * 8 + x1, Move::Capture), list, &found);
+        }
 
-  // Check if any opponent's piece can capture the king
-  for (int i = 0; i < width; i++) {
-    for (int j = 0; j < width; j++) {
-      if (board[i * width + j] == ' ') continue;
-      if (isupper(board[i * width + j]) != isupper(curKing)) {
-        string str0(1, board[i * width + j]);
-        string str1(1, j + '0');
-        string str2(1, i + '0');
-        // Simulate the move and check if the king is still in check
-        if (move(str0 + str1 + str2 + "x" + kingPos, board, str0[0], width, !turn, lastMove, castling)) {
-          return true;
+        // Castling moves the king onto the own rook. The king may neither castle out of check nor pass an attacked
+        // square, the target square itself is tested by addMove. The rights are checked first, since the attack test
+        // is the expensive part.
+        int row = turn ? 56 : 0;
+        char rook = turn ? 'R' : 'r';
+        bool rights = castling[turn ? 1 : 3] == 0 || castling[turn ? 0 : 2] == 0;
+        if (tolower(curPiece) == 'k' && from == row + 4 && rights && !attacked(squares, from, !turn)) {
+          if (castling[turn ? 1 : 3] == 0 && squares[row + 7] == rook && squares[row + 5] == ' ' &&
+              squares[row + 6] == ' ' && !attacked(squares, row + 5, !turn))
+            addMove(squares, king, turn, Move(from, row + 7, Move::KingCastle), list, &found);
+          if (castling[turn ? 0 : 2] == 0 && squares[row] == rook && squares[row + 1] == ' ' &&
+              squares[row + 2] == ' ' && squares[row + 3] == ' ' && !attacked(squares, row + 3, !turn))
+            addMove(squares, king, turn, Move(from, row, Move::QueenCastle), list, &found);
         }
+        break;
       }
+      case 'b':
+        addSlidingMoves(squares, king, turn, from, diagonal, 4, list, &found);
+        break;
+      case 'r':
+        addSlidingMoves(squares, king, turn, from, straight, 4, list, &found);
+        break;
+      case 'q':
+        addSlidingMoves(squares, king, turn, from, straight, 4, list, &found);
+        addSlidingMoves(squares, king, turn, from, diagonal, 4, list, &found);
+        break;
     }
+    if (found && list == nullptr) return true;
   }
-  return false;
+  return found;
 }
 
 /**
- * This function calculates the available moves for all pieces of the current player.
- * It takes the current state of the chessboard, the turn, the last move made, and the castling availability as input.
- * It iterates through the chessboard to find the current player's pieces.
- * For each piece, it generates all possible moves and checks if the move is valid.
- * If the move is valid, it simulates the move and checks if the king is in check.
- * If the king is not in check after the move, it adds the move to the result vector.
- * The function returns a vector of vectors, where each inner vector represents the possible moves for a piece.
- * The first element of each inner vector is the Move-From location.
+ * Adds the moves of a sliding piece along the given directions, until the piece is blocked.
  */
-std::vector<std::vector<int>> Piece::testAvailableMoves(string board1, bool turn, string lastMove, int castling[4]) {
-  std::vector<std::vector<int>> result;
-  int width = std::sqrt(board1.length());
-  char curKing = turn == 0 ? 'k' : 'K';
-  string board = board1;
-
-  char curPiece;
-  // Find the current player's pieces and calculate their available moves
-  for (int i = 0; i < width; i++) {
-    for (int j = 0; j < width; j++) {
-      if (board[i * width + j] == ' ' || isupper(board[i * width + j]) != isupper(curKing))
+void Piece::addSlidingMoves(char* board, int king, bool turn, int from, const int directions[][2], int count,
+                            MoveList* list, bool* found) {
+  for (int i = 0; i < count; i++) {
+    int x = from % 8 + directions[i][0];
+    int y = from / 8 + directions[i][1];
+    for (; x >= 0 && x <= 7 && y >= 0 && y <= 7; x += directions[i][0], y += directions[i][1]) {
+      char target = board[y * 8 + x];
+      if (target == ' ') {
+        addMove(board, king, turn, Move(from, y * 8 + x, Move::Quiet), list, found);
         continue;
-      else
-        curPiece = board[i * width + j];
-      std::vector<int> moves = {i * width + j};
-
-      // Generate all possible moves for the current piece
-      for (int t = 0; t < width; t++) {
-        for (int l = 0; l < width; l++) {
-          if (move(string(1, curPiece) + string(1, j + '0') + string(1, i + '0') + string(1, l + '0') +
-                       string(1, t + '0'),
-                   board, curPiece, width, turn, lastMove, castling) ||
-              move(string(1, curPiece) + string(1, j + '0') + string(1, i + '0') + "x" + string(1, l + '0') +
-                       string(1, t + '0'),
-                   board, curPiece, width, turn, lastMove, castling)) {
-            char temp = board[t * width + l];
-            board[i * width + j] = ' ';
-            board[t * width + l] = curPiece;
-            // Check if the king is in check after the move
-            if (!testCheck(board, turn, lastMove, castling)) {
-              moves.push_back(t * width + l);
-            }
-            board[i * width + j] = curPiece;
-            board[t * width + l] = temp;
-          }
-        }
       }
-
-      // Add the moves to the result vector
-      if (moves.size() > 1) result.push_back(moves);
+      if ((isupper(target) != 0) != turn) addMove(board, king, turn, Move(from, y * 8 + x, Move::Capture), list, found);
+      break;
     }
   }
-  return result;
 }
 
 /**
- * This function checks the validity of a move.
- * It takes the move in algebraic notation, the current state of the chessboard, the type of the piece to be moved,
- * the width of the chessboard, the turn, the last move made, and the castling availability as input.
- * It checks if the move string format is correct and if it is the correct player's turn to move.
- * Then, it calculates the Move-From and Move-To coordinates based on the move string.
- * It checks if the move is valid for the specific piece type.
- * If the move is a capture, it checks if the captured piece is of the opposite color.
- * If the move is a pawn double move, it checks if it is a valid en passant capture.
- * If the move is a castling move, it checks if the castling is available and if the path is clear.
- * The function returns true if the move is valid, and false otherwise.
+ * Tests a candidate move and adds it to the list, if it does not leave the own king in check.
+ * Without a list, the test is skipped once a legal move was found. Without a king, the move is not tested.
  */
-bool Piece::move(string move, string board, char curPiece, int width, bool turn, string lastMove, int castling[4]) {
-  // Check for the correct move string format
-  if (move.find_first_not_of("KQRBNPkqrbnp") != 1) return false;
-  if ((isupper(move[0]) > 0) != turn) return false;
-  int fromCord = (move[2] - '0') * width + (move[1] - '0');
-  int l = (move[3] == 'x');
-  int toCord = (move[4 + l] - '0') * width + (move[3 + l] - '0');
-
-  // Handle special pawn move: en passant
-  if (tolower(move[0]) == 'p' && tolower(lastMove[0]) == 'p' && abs(lastMove[2] - lastMove[4]) == 2 &&
-      move[2] == lastMove[4] && abs(move[2] - move[4]) == 1) {
-    if (turn && move[3] == lastMove[3] && move[4] == lastMove[4] - 1 &&
-        (move[1] == lastMove[3] - 1 || move[1] == lastMove[3] + 1)) {
-      passant = true;
-      return true;
-    } else if (!turn && move[3] == lastMove[3] && move[4] == lastMove[4] + 1 &&
-               (move[1] == lastMove[3] - 1 || move[1] == lastMove[3] + 1)) {
-      passant = true;
-      return true;
-    }
+void Piece::addMove(char* board, int king, bool turn, Move move, MoveList* list, bool* found) {
+  if (list == nullptr && *found) return;
+  if (king != -1 && !leavesKingSafe(board, king, turn, move)) return;
+
+  *found = true;
+  if (list != nullptr) list->add(move);
+}
+
+/**
+ * Applies a move to a copy of the board and checks if the own king is not attacked afterwards.
+ */
+bool Piece::leavesKingSafe(const char* board, int king, bool turn, Move move) {
+  char copy[64];
+  memcpy(copy, board, 64);
+  make(copy, move);
+
+  // Find the king after the move
+  int kingAfter = king;
+  if (move.getFrom() == king) {
+    int row = move.getFrom() / 8 * 8;
+    kingAfter = move.getType() == Move::KingCastle    ? row + 6
+                : move.getType() == Move::QueenCastle ? row + 2
+                                                      : move.getTo();
   }
+  return !attacked(copy, kingAfter, !turn);
+}
 
-  // Check the secondary validity of the move format for taking moves
-  if (move.length() == 6 || move.length() == 8) {
-    if (move[3] != 'x') return false;
-    if (curPiece != move[0]) return false;
-    if ((tolower(move[0]) != 'k' && isupper(curPiece) == isupper(board[toCord])) || board[toCord] == ' ') return false;
-  } else {
-    if (curPiece != move[0] || (board[toCord] != ' ')) {
-      return false;
-    }
+/**
+ * Checks if a square is attacked, by looking from the square into every direction a piece could attack from.
+ */
+bool Piece::attacked(const char* board, int square, bool byWhite) {
+  int x = square % 8;
+  int y = square / 8;
+
+  // Pawns attack diagonally forward, so a white pawn attacks from the row below
+  int pawnY = y + (byWhite ? 1 : -1);
+  char pawn = byWhite ? 'P' : 'p';
+  if (pawnY >= 0 && pawnY <= 7) {
+    if (x > 0 && board[pawnY * 8 + x - 1] == pawn) return true;
+    if (x < 7 && board[pawnY * 8 + x + 1] == pawn) return true;
   }
 
-  // Check for special move: promotion
-  if (move.size() > 6 &&
-      (move[move.length() - 2] != '=' || move.find_last_of("RrNnBbQq") != move.length() - 1 ||
-       isupper(move[move.length() - 1]) != isupper(move[0]) || (move[4 + l] != '0' && move[4 + l] != '7'))) {
-    return false;
+  // Knights and kings
+  char knight = byWhite ? 'N' : 'n';
+  char king = byWhite ? 'K' : 'k';
+  for (int i = 0; i < 8; i++) {
+    int x1 = x + knightJumps[i][0];
+    int y1 = y + knightJumps[i][1];
+    if (x1 >= 0 && x1 <= 7 && y1 >= 0 && y1 <= 7 && board[y1 * 8 + x1] == knight) return true;
+    x1 = x + kingSteps[i][0];
+    y1 = y + kingSteps[i][1];
+    if (x1 >= 0 && x1 <= 7 && y1 >= 0 && y1 <= 7 && board[y1 * 8 + x1] == king) return true;
   }
 
-  // copy the move string to a new string without the 'x' character for recursive checks
-  string move1 = "";
-  for (long unsigned int i = 0; i < move.length(); i++) {
-    if (move[i] != 'x') move1.push_back(move[i]);
+  // Sliding pieces, the first piece in every direction decides
+  char queen = byWhite ? 'Q' : 'q';
+  char rook = byWhite ? 'R' : 'r';
+  char bishop = byWhite ? 'B' : 'b';
+  for (int i = 0; i < 8; i++) {
+    const int* dir = i < 4 ? straight[i] : diagonal[i - 4];
+    char slider = i < 4 ? rook : bishop;
+    for (int x1 = x + dir[0], y1 = y + dir[1]; x1 >= 0 && x1 <= 7 && y1 >= 0 && y1 <= 7; x1 += dir[0], y1 += dir[1]) {
+      char target = board[y1 * 8 + x1];
+      if (target == ' ') continue;
+      if (target == queen || target == slider) return true;
+      break;
+    }
   }
+  return false;
+}
 
-  switch (tolower(move[0])) {
-    case 'p': {
-      // Check for movement direction
-      if ((isupper(move[0]) == 0) != (move[2] - move[4 + l] < 0)) {
-        return false;
-      }
+/**
+ * Finds the least valuable piece of a player, which attacks a square. Looks from the square into every direction, like
+ * attacked, but keeps the cheapest attacker instead of stopping at the first one.
+ *
+ * @return The index of the attacking piece, or -1 if the square is not attacked.
+ */
+int Piece::leastValuableAttacker(const char* board, int square, bool byWhite) {
+  int x = square % 8;
+  int y = square / 8;
 
-      if (l) {
-        if (abs(move[1] - move[4]) == 1) {
-          // Check for correct take
-          if (abs(move[2] - move[5]) != 1) return false;
+  int pawnY = y + (byWhite ? 1 : -1);
+  char pawn = byWhite ? 'P' : 'p';
+  if (pawnY >= 0 && pawnY <= 7) {
+    if (x > 0 && board[pawnY * 8 + x - 1] == pawn) return pawnY * 8 + x - 1;
+    if (x < 7 && board[pawnY * 8 + x + 1] == pawn) return pawnY * 8 + x + 1;
+  }
 
-          if (board[toCord] == ' ' || isupper(board[toCord]) == isupper(move[0])) return false;
+  char knight = byWhite ? 'N' : 'n';
+  char king = byWhite ? 'K' : 'k';
+  int kingSquare = -1;
+  for (int i = 0; i < 8; i++) {
+    int x1 = x + knightJumps[i][0];
+    int y1 = y + knightJumps[i][1];
+    if (x1 >= 0 && x1 <= 7 && y1 >= 0 && y1 <= 7 && board[y1 * 8 + x1] == knight) return y1 * 8 + x1;
+    x1 = x + kingSteps[i][0];
+    y1 = y + kingSteps[i][1];
+    if (x1 >= 0 && x1 <= 7 && y1 >= 0 && y1 <= 7 && board[y1 * 8 + x1] == king) kingSquare = y1 * 8 + x1;
+  }
 
-        } else {
-          return false;
-        }
-      } else if (abs(move[2] - move[4]) == 1) {
-        // Check for unmarked capture
-        if (abs(move[1] - move[3]) != 0) return false;
-
-      } else if (abs(move[2] - move[4]) == 2) {
-        // Check if pawn is on starting position
-        if (move[2] != '1' && move[2] != '6') return false;
-        // Check if pawn is blocked
-        if (board[toCord] != ' ') return false;
-        if (abs(move[1] - move[3]) != 0) return false;
-        if (isupper(move[0]) != 0) {
-          if (board[toCord + width] != ' ') return false;
-        } else {
-          if (board[toCord - width] != ' ') return false;
-        }
-      } else {
-        return false;
+  // The first piece in every direction, bishops are cheaper than rooks, which are cheaper than queens
+  char queen = byWhite ? 'Q' : 'q';
+  char rook = byWhite ? 'R' : 'r';
+  char bishop = byWhite ? 'B' : 'b';
+  int best = -1;
+  int bestRank = 3;
+  for (int i = 0; i < 8; i++) {
+    const int* dir = i < 4 ? diagonal[i] : straight[i - 4];
+    char slider = i < 4 ? bishop : rook;
+    for (int x1 = x + dir[0], y1 = y + dir[1]; x1 >= 0 && x1 <= 7 && y1 >= 0 && y1 <= 7; x1 += dir[0], y1 += dir[1]) {
+      char target = board[y1 * 8 + x1];
+      if (target == ' ') continue;
+      int rank = target == slider ? (i < 4 ? 0 : 1) : (target == queen ? 2 : 3);
+      if (rank < bestRank) {
+        best = y1 * 8 + x1;
+        bestRank = rank;
       }
       break;
     }
-    case 'r': {
-      if (move[1] != move[3 + l] && move[2] != move[4 + l]) return false;
-      if ((abs(move[1] - move[3 + l]) > 1 || abs(move[2] - move[4 + l]) > 1)) {
-        // Check if the path is clear by recursively checking the move to every square between the two points, within
-        // the rooks movement rules
-        if (move[1] > move[3 + l])
-          move1[3]++;
-        else if (move[1] < move[3 + l])
-          move1[3]--;
-        else if (move[2] > move[4 + l])
-          move1[4]++;
-        else if (move[2] < move[4 + l])
-          move1[4]--;
-        if (!Piece::move(move1, board, curPiece, width, turn, lastMove, castling)) return false;
-      }
-      break;
-    }
-    case 'n': {
-      if (!(abs(move[1] - move[3 + l]) == 2 && abs(move[2] - move[4 + l]) == 1) &&
-          !(abs(move[1] - move[3 + l]) == 1 && abs(move[2] - move[4 + l]) == 2)) {
-        return false;
-      }
-      break;
-    }
-    case 'b': {
-      if (abs(move[1] - move[3 + l]) != abs(move[2] - move[4 + l])) return false;
-      if ((abs(move[1] - move[3 + l]) > 1 || abs(move[2] - move[4 + l]) > 1)) {
-        // Check if the path is clear by recursively checking the move to every square between the two points, within
-        // the bishops movement rules
-        if (move[1] > move[3 + l]) move1[3]++;
-        if (move[1] < move[3 + l]) move1[3]--;
-        if (move[2] > move[4 + l]) move1[4]++;
-        if (move[2] < move[4 + l]) move1[4]--;
-
-        if (!Piece::move(move1, board, curPiece, width, turn, lastMove, castling)) return false;
-      }
-      break;
-    }
-    case 'q': {
-      if (move[1] != move[3 + l] && move[2] != move[4 + l] && abs(move[1] - move[3 + l]) != abs(move[2] - move[4 + l]))
-        return false;
-
-      if ((abs(move[1] - move[3 + l]) > 1 || abs(move[2] - move[4 + l]) > 1)) {
-        // Check if the path is clear by recursively checking the move to every square between the two points, within
-        // the bishops and rooks movement rules, to simulate the queen's movement
-        if (move[1] > move[3 + l]) move1[3]++;
-        if (move[1] < move[3 + l]) move1[3]--;
-        if (move[2] > move[4 + l]) move1[4]++;
-        if (move[2] < move[4 + l]) move1[4]--;
-
-        if (!Piece::move(move1, board, curPiece, width, turn, lastMove, castling)) return false;
-      }
-      break;
-    }
-    case 'k': {
-      if (move.length() == 6 && isupper(move[0]) == isupper(board[toCord]) && board[toCord] != (turn == 0 ? 'r' : 'R'))
-        return false;
-      if (abs(move[1] - move[3 + l]) > 1 || abs(move[2] - move[4 + l]) > 1) {
-        // Seperate check for castling moves
-        if ((castling[1] == 0 && move.compare("K47x77") == 0 && board[63] == 'R' && board[62] == ' ' &&
-             board[61] == ' ') ||
-            (move.compare("K47x07") == 0 && board[56] == 'R' && castling[0] == 0 && board[57] == ' ' &&
-             board[58] == ' ' && board[59] == ' ') ||
-            (move.compare("k40x70") == 0 && board[7] == 'r' && castling[3] == 0 && board[6] == ' ' &&
-             board[5] == ' ') ||
-            (move.compare("k40x00") == 0 && board[0] == 'r' && castling[2] == 0 && board[1] == ' ' && board[2] == ' ' &&
-             board[3] == ' ')) {
-          return true;
-        }
-        return false;
-        break;
-      } else if (isupper(move[0]) == isupper(board[toCord])) {
-        return false;
-      }
-    }
+    // No rook or queen can beat a bishop
+    if (bestRank == 0 && i == 3) return best;
   }
-  return true;
+  return best >= 0 ? best : kingSquare;
+}
+
+/**
+ * Applies a move to a board array.
+ */
+void Piece::make(char* board, Move move) {
+  int from = move.getFrom();
+  int to = move.getTo();
+  char curPiece = board[from];
+  bool white = isupper(curPiece) != 0;
+
+  if (move.isCastling()) {
+    int row = from / 8 * 8;
+    char rook = board[to];
+    board[from] = ' ';
+    board[to] = ' ';
+    board[row + (move.getType() == Move::KingCastle ? 6 : 2)] = curPiece;
+    board[row + (move.getType() == Move::KingCastle ? 5 : 3)] = rook;
+    return;
+  }
+
+  // The pawn captured en passant stands next to the capturing pawn
+  if (move.isEnPassant()) board[from / 8 * 8 + to % 8] = ' ';
+  board[to] = move.isPromotion() ? move.getPromotionPiece(white) : curPiece;
+  board[from] = ' ';
 }
@@ -1,9 +1,9 @@
 #ifndef PIECE_H_
 #define PIECE_H_
 
-#include <cmath>
 #include <string>
-#include <vector>
+
+#include "../moves/Move.h"
 
 using std::string;
 
@@ -12,18 +12,28 @@ class Piece {
   Piece();
   ~Piece();
 
-  std::vector<std::vector<int>> testAvailableMoves(string board, bool turn, string lastMove, int castling[4]);
-  bool move(string move, string board, char curPiece, int width, bool turn, string lastMove, int castling[4]);
-  bool testCheck(string board, bool turn, string lastMove, int castling[4]);
-  bool getPassant();
-  void setPassant(bool pPassant);
+  void testAvailableMoves(const string& board, bool turn, Move lastMove, const int castling[4], MoveList* list);
+  void testPseudoLegalMoves(const string& board, bool turn, Move lastMove, const int castling[4], MoveList* list);
+  bool isLegal(const string& board, bool turn, Move move, bool inCheck);
+  bool hasLegalMove(const string& board, bool turn, Move lastMove, const int castling[4]);
+  bool testCheck(const string& board, bool turn);
+  bool isAttacked(const string& board, int square, bool byWhite);
+  void makeMove(string& board, Move move);
   int getValue(char piece);
+  static int getExchangeValue(char piece);
+  int see(const string& board, Move move);
+  bool isHanging(const string& board, int square);
 
  private:
-  char file;
-  char rank;
-  bool turn;
-  bool passant;
+  bool findMoves(const string& board, bool turn, Move lastMove, const int castling[4], MoveList* list, bool legal);
+  void addMove(char* board, int king, bool turn, Move move, MoveList* list, bool* found);
+  bool leavesKingSafe(const char* board, int king, bool turn, Move move);
+  bool pinned(const char* board, int king, int square, bool turn);
+  void addSlidingMoves(char* board, int king, bool turn, int from, const int directions[][2], int count,
+                       MoveList* list, bool* found);
+  bool attacked(const char* board, int square, bool byWhite);
+  int leastValuableAttacker(const char* board, int square, bool byWhite);
+  void make(char* board, Move move);
 };
 
-#endif  // PIECE_H_
\ No newline at end of file
+#endif  // PIECE_H_
@@ -0,0 +1,775 @@
+#include "./GameServer.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <functional>
+#include <sstream>
+
+#include "../rules/moves/Notation.h"
+
+// Ids of the epoll events of the listening socket and of the wake-up, the connections count from 2
+static constexpr uint64_t listenId = 0;
+static constexpr uint64_t wakeId = 1;
+// Longest line of a client, and the most output, a connection may fall behind, before it is closed
+static constexpr size_t maxLine = 1024;
+static constexpr size_t maxOutput = 1 << 20;
+// Most bytes of deltas, a spectator may fall behind, before they are dropped for new snapshots
+static constexpr size_t maxBacklog = 1 << 18;
+// Most lines of a connection, which are written with one call
+static constexpr int maxVectors = 64;
+// Default time control of a game in seconds
+static constexpr double defaultSeconds = 300;
+
+/**
+ * Plays a move on the board, choosing the promotion piece of the move, if the board asks for it.
+ *
+ * @return True if the game continues, false if the move ended it.
+ */
+static bool playMove(Board* board, Move move) {
+  int from[2] = {move.getFrom() % 8, move.getFrom() / 8};
+  int to[2] = {move.getTo() % 8, move.getTo() / 8};
+  board->beginMovePiece(from[0], from[1]);
+  bool done = board->movePiece(from[0], from[1], to[0], to[1], ' ');
+  if (!done && board->isPromoting())
+    done = board->movePiece(from[0], from[1], to[0], to[1], move.getPromotionPiece(board->getTurn()));
+  return done;
+}
+
+/**
+ * Returns the reason of the end of a game for the protocol from the message of the board.
+ */
+static std::string getReason(const std::wstring& message) {
+  if (message.find(L"Timeout") != std::wstring::npos) return "timeout";
+  if (message.find(L"Checkmate") != std::wstring::npos) return "checkmate";
+  if (message.find(L"repetition") != std::wstring::npos) return "repetition";
+  if (message.find(L"50-move") != std::wstring::npos) return "fifty";
+  if (message.find(L"insufficient") != std::wstring::npos) return "material";
+  return "stalemate";
+}
+
+/**
+ * Parses a non-negative number of a command.
+ *
+ * @return False if the word is not a number.
+ */
+static bool parseNumber(const std::string& word, double* value) {
+  char* end;
+  *value = strtod(word.c_str(), &end);
+  return !word.empty() && *end == '\0' && *value >= 0 && *value < 1e7;
+}
+
+/**
+ * @brief Constructs a GameReply with a line for one connection.
+ *
+ * @param pConnection The connection of the client.
+ * @param pLine The line without its newline.
+ */
+GameReply::GameReply(uint64_t pConnection, const std::string& pLine)
+    : connection(pConnection), line(std::make_shared<const std::string>(pLine + '\n')), kind(Direct) {}
+
+/**
+ * @brief Constructs a GameReply with a shared line.
+ *
+ * @param pConnection The connection of the client, 0 for the spectators of the game.
+ * @param pLine The line with its newline.
+ * @param pKind Whom the line goes to, and how it changes the subscriptions to the game.
+ * @param pGame The name of the game.
+ */
+GameReply::GameReply(uint64_t pConnection, std::shared_ptr<const std::string> pLine, Kind pKind,
+                     const std::string& pGame)
+    : connection(pConnection), line(std::move(pLine)), kind(pKind), game(pGame) {}
+
+/**
+ * @brief Constructs a Game, which waits for its players.
+ */
+GameServer::Game::Game()
+    : board(8, 8), players{0, 0}, clocks{0, 0}, increment(0), flag(0), started(false), plies(0) {}
+
+/**
+ * @brief Constructs a GameServer and starts its workers.
+ *
+ * @param pWorkers The number of workers, which own the games.
+ */
+GameServer::GameServer(int pWorkers)
+    : listenFd(-1),
+      epollFd(epoll_create1(0)),
+      wakeFd(eventfd(0, EFD_NONBLOCK)),
+      sendBuffer(0),
+      nextConnection(2),
+      stopping(false),
+      connectionCount(0),
+      gameCount(0),
+      moveCount(0),
+      resyncCount(0) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = wakeId;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+  for (int i = 0; i < std::max(1, pWorkers); i++) workers.push_back(std::make_unique<Worker>());
+  for (auto& worker : workers) worker->thread = std::thread(&GameServer::work, this, worker.get());
+}
+
+/**
+ * @brief Stops the workers and closes all connections. Running games are dropped.
+ */
+GameServer::~GameServer() {
+  stopping = true;
+  for (auto& worker : workers) {
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+    }
+    worker->ready.notify_all();
+    worker->thread.join();
+  }
+  for (auto& entry : connections) ::close(entry.second->fd);
+  if (listenFd >= 0) ::close(listenFd);
+  ::close(wakeFd);
+  ::close(epollFd);
+}
+
+/**
+ * Opens the listening socket.
+ *
+ * @param host The address to listen on, like "127.0.0.1" for local clients only.
+ * @param port The port, 0 for any free port, see getPort.
+ * @return False if the address is invalid or the port can not be used.
+ */
+bool GameServer::listen(const std::string& host, int port) {
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) return false;
+  listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (listenFd < 0) return false;
+  int reuse = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(listenFd, SOMAXCONN) != 0) {
+    ::close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = listenId;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+  return true;
+}
+
+/**
+ * Sets the send buffer of the connections, which are accepted afterwards. A fixed size turns off the growth of the
+ * buffer by the system, so a spectator, which reads nothing, falls behind after a few KB instead of some MB.
+ *
+ * @param bytes The size in bytes, 0 for the default of the system.
+ */
+void GameServer::setSendBuffer(int bytes) { sendBuffer = bytes; }
+
+/**
+ * Runs the event loop on the calling thread, until stop is called.
+ */
+void GameServer::run() {
+  epoll_event events[256];
+  while (!stopping) {
+    int count = epoll_wait(epollFd, events, 256, -1);
+    if (count < 0 && errno != EINTR) break;
+    for (int i = 0; i < count; i++) {
+      uint64_t id = events[i].data.u64;
+      if (id == listenId) {
+        accept();
+      } else if (id == wakeId) {
+        uint64_t value;
+        while (::read(wakeFd, &value, sizeof(value)) > 0) {
+        }
+        deliver();
+      } else {
+        auto found = connections.find(id);
+        if (found == connections.end()) continue;
+        Connection* connection = found->second.get();
+        if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+          close(connection);
+        } else if (events[i].events & EPOLLOUT && !flush(connection)) {
+          close(connection);
+        } else if (events[i].events & EPOLLIN) {
+          read(connection);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Stops the event loop. Can be called from any thread, also from a signal handler.
+ */
+void GameServer::stop() {
+  stopping = true;
+  uint64_t value = 1;
+  if (::write(wakeFd, &value, sizeof(value)) < 0) return;
+}
+
+/**
+ * Accepts all waiting connections.
+ */
+void GameServer::accept() {
+  while (true) {
+    int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+    if (fd < 0) return;
+    // Every line is a move of a game, so it is sent at once
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    if (sendBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    connection->id = nextConnection++;
+    connection->offset = 0;
+    connection->queued = 0;
+    connection->deltaBytes = 0;
+    connection->waiting = false;
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = connection->id;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+      ::close(fd);
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(liveMutex);
+      live.insert(connection->id);
+    }
+    connections[connection->id] = std::move(connection);
+    connectionCount++;
+  }
+}
+
+/**
+ * Reads the waiting input of a connection and handles its complete lines.
+ */
+void GameServer::read(Connection* connection) {
+  char buffer[16384];
+  ssize_t size = ::read(connection->fd, buffer, sizeof(buffer));
+  if (size == 0 || (size < 0 && errno != EAGAIN && errno != EINTR)) {
+    close(connection);
+    return;
+  }
+  if (size < 0) return;
+  connection->input.append(buffer, size);
+  size_t start = 0, end;
+  while ((end = connection->input.find('\n', start)) != std::string::npos) {
+    handleLine(connection, connection->input.substr(start, end - start));
+    start = end + 1;
+  }
+  connection->input.erase(0, start);
+  if (connection->input.size() > maxLine || !flush(connection)) close(connection);
+}
+
+/**
+ * Checks a command and hands it to the worker of its game.
+ */
+void GameServer::handleLine(Connection* connection, const std::string& line) {
+  GameRequest request;
+  request.connection = connection->id;
+  std::istringstream words(line);
+  std::string word;
+  while (words >> word) request.words.push_back(word);
+  if (request.words.empty()) return;
+  const std::string& command = request.words[0];
+  if (command != "join" && command != "move" && command != "resign" && command != "clock" && command != "leave" &&
+      command != "watch" && command != "unwatch") {
+    send(connection, "error - unknown command " + command);
+    return;
+  }
+  if (request.words.size() < 2) {
+    send(connection, "error - missing game");
+    return;
+  }
+  const std::string& name = request.words[1];
+  if (command == "join") connection->games[name]++;
+  post(std::move(request));
+}
+
+/**
+ * Adds a line to the output of a connection, which is written with the next flush.
+ */
+void GameServer::send(Connection* connection, const std::string& line) {
+  send(connection, std::make_shared<const std::string>(line + '\n'), false);
+}
+
+/**
+ * Adds a shared line to the output of a connection, without copying it. A delta, which would let the queued deltas
+ * exceed the backlog, resyncs the connection instead.
+ */
+void GameServer::send(Connection* connection, std::shared_ptr<const std::string> line, bool delta) {
+  if (delta && connection->deltaBytes + line->size() > maxBacklog) {
+    resync(connection);
+    return;
+  }
+  connection->queued += line->size();
+  if (delta) connection->deltaBytes += line->size();
+  connection->output.push_back({std::move(line), delta});
+}
+
+/**
+ * Writes as much output of a connection, as the socket takes, and waits for the socket to take the rest. The queued
+ * lines are gathered into one call, so a connection costs one system call per batch of replies.
+ *
+ * @return False if the connection failed or fell too far behind, so it has to be closed.
+ */
+bool GameServer::flush(Connection* connection) {
+  while (!connection->output.empty()) {
+    iovec vectors[maxVectors];
+    int count = 0;
+    for (auto chunk = connection->output.begin(); chunk != connection->output.end() && count < maxVectors; ++chunk) {
+      size_t skip = count == 0 ? connection->offset : 0;
+      vectors[count].iov_base = (void*)(chunk->line->data() + skip);
+      vectors[count++].iov_len = chunk->line->size() - skip;
+    }
+    msghdr message = {};
+    message.msg_iov = vectors;
+    message.msg_iovlen = count;
+    ssize_t size = sendmsg(connection->fd, &message, MSG_NOSIGNAL);
+    if (size < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN) return false;
+      break;
+    }
+    connection->queued -= size;
+    while (size > 0) {
+      Chunk& first = connection->output.front();
+      size_t rest = first.line->size() - connection->offset;
+      if ((size_t)size < rest) {
+        connection->offset += size;
+        break;
+      }
+      size -= rest;
+      if (first.delta) connection->deltaBytes -= first.line->size();
+      connection->output.pop_front();
+      connection->offset = 0;
+    }
+  }
+  if (connection->queued > maxOutput) return false;
+  bool waiting = !connection->output.empty();
+  if (waiting != connection->waiting) {
+    epoll_event event = {};
+    event.events = waiting ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.u64 = connection->id;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+    connection->waiting = waiting;
+  }
+  return true;
+}
+
+/**
+ * Drops the queued deltas of a spectator, which fell too far behind, except a partly written one, and asks the workers
+ * for new snapshots of its watched games. The deltas of these games are skipped, until their snapshots arrive.
+ */
+void GameServer::resync(Connection* connection) {
+  std::deque<Chunk> kept;
+  connection->queued = 0;
+  connection->deltaBytes = 0;
+  for (size_t i = 0; i < connection->output.size(); i++) {
+    Chunk& chunk = connection->output[i];
+    bool started = i == 0 && connection->offset > 0;
+    if (chunk.delta && !started) continue;
+    connection->queued += chunk.line->size() - (started ? connection->offset : 0);
+    if (chunk.delta) connection->deltaBytes += chunk.line->size();
+    kept.push_back(std::move(chunk));
+  }
+  connection->output.swap(kept);
+  for (const std::string& name : connection->watching) {
+    if (connection->stale.insert(name).second) post({connection->id, {"resync", name}});
+  }
+  resyncCount++;
+}
+
+/**
+ * Closes a connection, leaves its games, which resigns the started ones, and stops watching games.
+ */
+void GameServer::close(Connection* connection) {
+  for (const auto& entry : connection->games) post({connection->id, {"leave", entry.first}});
+  for (const std::string& name : connection->watching) {
+    unsubscribe(connection, name);
+    post({connection->id, {"unwatch", name}});
+  }
+  {
+    std::lock_guard<std::mutex> lock(liveMutex);
+    live.erase(connection->id);
+  }
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+  ::close(connection->fd);
+  connectionCount--;
+  connections.erase(connection->id);
+}
+
+/**
+ * Adds a connection to the spectators of a game, when its snapshot is delivered, so the connection gets the deltas,
+ * which the worker made after the snapshot.
+ */
+void GameServer::subscribe(Connection* connection, const std::string& name) {
+  connection->watching.insert(name);
+  connection->stale.erase(name);
+  spectators[name].insert(connection);
+}
+
+/**
+ * Removes a connection from the spectators of a game. The game stays in the watched games of the connection.
+ */
+void GameServer::unsubscribe(Connection* connection, const std::string& name) {
+  connection->stale.erase(name);
+  auto found = spectators.find(name);
+  if (found == spectators.end()) return;
+  found->second.erase(connection);
+  if (found->second.empty()) spectators.erase(found);
+}
+
+/**
+ * Writes the replies of the workers to their connections. Replies to closed connections are dropped. The line of a
+ * delta or of the end of a watched game is queued for every spectator, which is not waiting for a new snapshot.
+ */
+void GameServer::deliver() {
+  std::vector<GameReply> replies;
+  {
+    std::lock_guard<std::mutex> lock(outboxMutex);
+    replies.swap(outbox);
+  }
+  // Ids, since a connection, whose deltas were dropped, may be added again
+  std::vector<uint64_t> touched;
+  auto queue = [&](Connection* connection, const GameReply& reply, bool delta) {
+    if (connection->output.empty()) touched.push_back(connection->id);
+    send(connection, reply.line, delta);
+  };
+  for (const GameReply& reply : replies) {
+    if (reply.kind == GameReply::Delta || reply.kind == GameReply::Final) {
+      auto found = spectators.find(reply.game);
+      if (found == spectators.end()) continue;
+      for (Connection* connection : found->second) {
+        if (reply.kind == GameReply::Final) {
+          connection->watching.erase(reply.game);
+          connection->stale.erase(reply.game);
+          queue(connection, reply, false);
+        } else if (connection->stale.count(reply.game) == 0) {
+          queue(connection, reply, true);
+        }
+      }
+      if (reply.kind == GameReply::Final) spectators.erase(found);
+      continue;
+    }
+    auto found = connections.find(reply.connection);
+    if (found == connections.end()) continue;
+    Connection* connection = found->second.get();
+    if (reply.kind == GameReply::Left) {
+      auto joined = connection->games.find(reply.game);
+      if (joined != connection->games.end() && --joined->second == 0) connection->games.erase(joined);
+    }
+    if (reply.kind == GameReply::Watch) subscribe(connection, reply.game);
+    if (reply.kind == GameReply::Unwatch) {
+      unsubscribe(connection, reply.game);
+      connection->watching.erase(reply.game);
+    }
+    queue(connection, reply, false);
+  }
+  for (uint64_t id : touched) {
+    auto found = connections.find(id);
+    if (found != connections.end() && !flush(found->second.get())) close(found->second.get());
+  }
+}
+
+/**
+ * Returns the worker, which owns a game.
+ */
+GameServer::Worker* GameServer::getWorker(const std::string& name) {
+  return workers[std::hash<std::string>{}(name) % workers.size()].get();
+}
+
+/**
+ * Hands a request to the worker of its game. Called by the event loop and by the thread of the flag timers.
+ */
+void GameServer::post(GameRequest request) {
+  Worker* worker = getWorker(request.words[1]);
+  {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->queue.push_back(std::move(request));
+  }
+  worker->ready.notify_one();
+}
+
+/**
+ * Handles the commands of the games of a worker, until the server stops. The replies of a batch of commands are
+ * handed to the event loop at once.
+ */
+void GameServer::work(Worker* worker) {
+  std::vector<GameRequest> requests;
+  std::vector<GameReply> replies;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(worker->mutex);
+      worker->ready.wait(lock, [&] { return stopping || !worker->queue.empty(); });
+      if (stopping) return;
+      requests.swap(worker->queue);
+    }
+    for (const GameRequest& request : requests) handle(worker, request, &replies);
+    requests.clear();
+    if (replies.empty()) continue;
+    bool wake;
+    {
+      std::lock_guard<std::mutex> lock(outboxMutex);
+      wake = outbox.empty();
+      outbox.insert(outbox.end(), std::make_move_iterator(replies.begin()), std::make_move_iterator(replies.end()));
+    }
+    replies.clear();
+    uint64_t value = 1;
+    if (wake && ::write(wakeFd, &value, sizeof(value)) < 0) continue;
+  }
+}
+
+/**
+ * Handles a command of a game on the worker, which owns the game.
+ */
+void GameServer::handle(Worker* worker, const GameRequest& request, std::vector<GameReply>* replies) {
+  const std::string& command = request.words[0];
+  const std::string& name = request.words[1];
+  if (command == "join") {
+    join(worker, request, replies);
+    return;
+  }
+  auto found = worker->games.find(name);
+  Game* game = found == worker->games.end() ? nullptr : found->second.get();
+  // The flag timer of a game, which ended or whose clock changed since, finds no flag fall
+  if (command == "flag") {
+    if (game != nullptr && checkFlag(game)) finish(worker, name, game->board.getResult(), "timeout", replies);
+    return;
+  }
+  // Spectators need no seat, and a resync of the event loop is a new snapshot for a spectator
+  if (command == "watch" || command == "resync") {
+    watch(game, request, replies);
+    return;
+  }
+  if (command == "unwatch") {
+    if (game == nullptr || game->spectators.erase(request.connection) == 0) {
+      replies->push_back({request.connection, "error " + name + " not watching"});
+    } else {
+      auto line = std::make_shared<const std::string>("unwatched " + name + "\n");
+      replies->push_back({request.connection, line, GameReply::Unwatch, name});
+    }
+    return;
+  }
+  int side = -1;
+  for (int i = 0; i < 2 && game != nullptr; i++) {
+    if (game->players[i] == request.connection) side = i;
+  }
+  if (side < 0) {
+    replies->push_back({request.connection, "error " + name + " not a player of the game"});
+    return;
+  }
+  if (command == "leave" && !game->started) {
+    auto line = std::make_shared<const std::string>("left " + name + "\n");
+    replies->push_back({request.connection, line, GameReply::Left, name});
+    worker->games.erase(found);
+    gameCount--;
+  } else if (command == "leave" || command == "resign") {
+    if (checkFlag(game)) {
+      finish(worker, name, game->board.getResult(), "timeout", replies);
+    } else {
+      finish(worker, name, side == 0 ? "0-1" : "1-0", command == "leave" ? "disconnect" : "resignation", replies);
+    }
+  } else if (!game->started) {
+    replies->push_back({request.connection, "error " + name + " not started"});
+  } else if (checkFlag(game)) {
+    finish(worker, name, game->board.getResult(), "timeout", replies);
+  } else if (command == "clock") {
+    replies->push_back({request.connection, "clock " + name + " " + getClocks(game) +
+                                                (game->board.getTurn() ? " w" : " b")});
+  } else {
+    move(worker, game, request, replies);
+  }
+}
+
+/**
+ * Joins a game, which is created by its first player. The second player starts the game. A failed join is answered
+ * with an error, which ends the join, unless the connection already plays the game.
+ */
+void GameServer::join(Worker* worker, const GameRequest& request, std::vector<GameReply>* replies) {
+  const std::string& name = request.words[1];
+  auto& game = worker->games[name];
+  if (game == nullptr) {
+    double seconds = defaultSeconds, increment = 0;
+    if ((request.words.size() > 2 && !parseNumber(request.words[2], &seconds)) ||
+        (request.words.size() > 3 && !parseNumber(request.words[3], &increment)) || seconds == 0) {
+      worker->games.erase(name);
+      auto line = std::make_shared<const std::string>("error " + name + " invalid time control\n");
+      replies->push_back({request.connection, line, GameReply::Left, name});
+      return;
+    }
+    game = std::make_unique<Game>();
+    game->players[0] = request.connection;
+    game->clocks[0] = game->clocks[1] = seconds * 1000;
+    game->increment = increment * 1000;
+    gameCount++;
+    replies->push_back({request.connection, "joined " + name + " white"});
+    return;
+  }
+  if (game->players[1] != 0 || game->players[0] == request.connection) {
+    auto line = std::make_shared<const std::string>("error " + name + " game is full\n");
+    replies->push_back({request.connection, line, GameReply::Left, name});
+    return;
+  }
+  game->players[1] = request.connection;
+  game->started = true;
+  game->turnStart = std::chrono::steady_clock::now();
+  setFlag(name, game.get());
+  replies->push_back({request.connection, "joined " + name + " black"});
+  std::string start = "start " + name + " " + getClocks(game.get());
+  replies->push_back({game->players[0], start});
+  replies->push_back({game->players[1], start});
+}
+
+/**
+ * Plays a move of the player to move, after the running clock was checked by checkFlag.
+ */
+void GameServer::move(Worker* worker, Game* game, const GameRequest& request, std::vector<GameReply>* replies) {
+  const std::string& name = request.words[1];
+  int side = game->board.getTurn() ? 0 : 1;
+  Move move = request.words.size() > 2 ? Notation::fromUci(game->board.getPosition(), request.words[2]) : Move();
+  if (game->players[side] != request.connection) {
+    replies->push_back({request.connection, "error " + name + " not your turn"});
+    return;
+  }
+  if (move.isNull()) {
+    replies->push_back({request.connection, "error " + name + " illegal move"});
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  game->clocks[side] -= std::chrono::duration<double, std::milli>(now - game->turnStart).count();
+  game->clocks[side] += game->increment;
+  game->turnStart = now;
+  playMove(&game->board, move);
+  moveCount++;
+  std::string uci = Notation::toUci(move);
+  std::string clocks = getClocks(game);
+  replies->push_back({request.connection, "ok " + name + " " + uci + " " + clocks});
+  replies->push_back({game->players[1 - side], "moved " + name + " " + uci + " " + clocks});
+  game->plies++;
+  dropClosedSpectators(game);
+  if (!game->spectators.empty()) {
+    std::string delta = "delta " + name + " " + std::to_string(game->plies) + " " + uci + " " + clocks + "\n";
+    replies->push_back({0, std::make_shared<const std::string>(std::move(delta)), GameReply::Delta, name});
+  }
+  if (game->board.getResult() != "*") {
+    finish(worker, name, game->board.getResult(), getReason(game->board.getEndMessage()), replies);
+  } else {
+    setFlag(name, game);
+  }
+}
+
+/**
+ * Sends a snapshot of a started game to a new spectator, or again to a spectator, which fell behind.
+ */
+void GameServer::watch(Game* game, const GameRequest& request, std::vector<GameReply>* replies) {
+  const std::string& name = request.words[1];
+  bool watching = game != nullptr && game->spectators.count(request.connection) > 0;
+  if (request.words[0] == "resync") {
+    if (!watching) return;
+  } else if (game == nullptr || !game->started) {
+    replies->push_back({request.connection, "error " + name + " not started"});
+    return;
+  } else if (watching) {
+    replies->push_back({request.connection, "error " + name + " already watching"});
+    return;
+  }
+  game->spectators.insert(request.connection);
+  std::string snapshot = "snapshot " + name + " " + std::to_string(game->plies) + " " + getClocks(game) + " " +
+                         game->board.getPosition().getFen() + "\n";
+  replies->push_back({request.connection, std::make_shared<const std::string>(std::move(snapshot)), GameReply::Watch,
+                      name});
+}
+
+/**
+ * Removes the spectators of a game, whose connection is closed, before a delta is queued for them.
+ */
+void GameServer::dropClosedSpectators(Game* game) {
+  if (game->spectators.empty()) return;
+  std::lock_guard<std::mutex> lock(liveMutex);
+  std::erase_if(game->spectators, [&](uint64_t spectator) { return live.count(spectator) == 0; });
+}
+
+/**
+ * Checks the running clock of a started game, and ends the game on the board, if the flag fell.
+ *
+ * @return True if the player to move ran out of time.
+ */
+bool GameServer::checkFlag(Game* game) {
+  if (!game->started) return false;
+  int side = game->board.getTurn() ? 0 : 1;
+  auto elapsed = std::chrono::steady_clock::now() - game->turnStart;
+  if (game->clocks[side] - std::chrono::duration<double, std::milli>(elapsed).count() > 0) return false;
+  game->clocks[side] = 0;
+  game->board.endGame(false, true, false);
+  return true;
+}
+
+/**
+ * Starts the flag timer of the running clock of a game, instead of the timer of the last clock.
+ */
+void GameServer::setFlag(const std::string& name, Game* game) {
+  flags.cancel(game->flag);
+  double remaining = game->clocks[game->board.getTurn() ? 0 : 1] / 1000;
+  game->flag = flags.schedule(remaining, [this, name] { post({0, {"flag", name}}); });
+}
+
+/**
+ * Tells both players and the spectators the result of a game, with one shared line, and removes the game.
+ */
+void GameServer::finish(Worker* worker, const std::string& name, const std::string& result, const std::string& reason,
+                        std::vector<GameReply>* replies) {
+  auto found = worker->games.find(name);
+  flags.cancel(found->second->flag);
+  auto line = std::make_shared<const std::string>("end " + name + " " + result + " " + reason + "\n");
+  for (uint64_t player : found->second->players) {
+    if (player != 0) replies->push_back({player, line, GameReply::Left, name});
+  }
+  if (!found->second->spectators.empty()) replies->push_back({0, line, GameReply::Final, name});
+  worker->games.erase(found);
+  gameCount--;
+}
+
+/**
+ * Returns the remaining milliseconds of white and black, where the running clock is reduced by its elapsed time.
+ */
+std::string GameServer::getClocks(Game* game) {
+  double clocks[2] = {game->clocks[0], game->clocks[1]};
+  if (game->started && game->board.getResult() == "*") {
+    int side = game->board.getTurn() ? 0 : 1;
+    auto elapsed = std::chrono::steady_clock::now() - game->turnStart;
+    clocks[side] -= std::chrono::duration<double, std::milli>(elapsed).count();
+  }
+  return std::to_string(std::llround(std::max(0.0, clocks[0]))) + " " +
+         std::to_string(std::llround(std::max(0.0, clocks[1])));
+}
+
+/**
+ * @brief Getters of the GameServer class. The port is the one of the listening socket, also if it was chosen by the
+ * system. The counts can be read from any thread.
+ *
+ * */
+int GameServer::getPort() {
+  sockaddr_in address = {};
+  socklen_t size = sizeof(address);
+  if (listenFd < 0 || getsockname(listenFd, (sockaddr*)&address, &size) != 0) return 0;
+  return ntohs(address.sin_port);
+}
+
+int GameServer::getConnectionCount() { return connectionCount; }
+
+long long GameServer::getGameCount() { return gameCount; }
+
+long long GameServer::getMoveCount() { return moveCount; }
+
+long long GameServer::getResyncCount() { return resyncCount; }
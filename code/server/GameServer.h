@@ -0,0 +1,182 @@
+#ifndef GAMESERVER_H_
+#define GAMESERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../loop/TimerWheel.h"
+#include "../rules/board/Board.h"
+
+// A command of a client for a game, split into its words. A closed connection sends "leave" to its games.
+struct GameRequest {
+  uint64_t connection;
+  std::vector<std::string> words;
+};
+
+// A line for a client, or for all spectators of a game. The line ends with its newline and is shared by all
+// connections, which get it, so a broadcast is encoded once and never copied per connection.
+struct GameReply {
+  // Direct goes to the connection only, Left too, and ends a join of the connection to the game. Watch is a snapshot
+  // for the connection, which subscribes it to the game, and Unwatch ends the subscription. Delta goes to all
+  // spectators of the game, Final too, and ends their subscriptions.
+  enum Kind { Direct, Left, Watch, Unwatch, Delta, Final };
+
+  GameReply(uint64_t pConnection, const std::string& pLine);
+  GameReply(uint64_t pConnection, std::shared_ptr<const std::string> pLine, Kind pKind, const std::string& pGame);
+
+  uint64_t connection;
+  std::shared_ptr<const std::string> line;
+  Kind kind;
+  std::string game;
+};
+
+// Hosts many games in one process for clients over TCP, with one command per line:
+//   join <game> [seconds] [increment]  the first player gets white and sets the time control, the second black:
+//                                      joined <game> white|black, then start <game> <white ms> <black ms> to both
+//   move <game> <uci>                  ok <game> <uci> <white ms> <black ms> to the player, moved ... to the opponent
+//   resign <game>                      end <game> <result> <reason> to both players, like every end of a game
+//   leave <game>                       left <game> before the start, else the game is lost like by a disconnect
+//   clock <game>                       clock <game> <white ms> <black ms> <w|b>
+//   watch <game>                       snapshot <game> <ply> <white ms> <black ms> <fen>, then for every move
+//                                      delta <game> <ply> <uci> <white ms> <black ms> and the end line of the game
+//   unwatch <game>                     unwatched <game>
+// Errors are answered with error <game> <message>. A connection can play and watch several games. One event loop
+// with epoll reads and writes all connections and hands the commands to a pool of workers: the games are split over
+// the workers by their name, and every worker owns the boards of its games, so a board is never shared between threads.
+// The workers hand their replies back to the event loop. The clocks run from the start of the game, and a TimerWheel
+// sends the flag fall of every running clock to the worker of the game, which ends it by timeout. A move of a watched
+// game is encoded once as a delta, whose buffer the event loop queues for all spectators and writes with one
+// scatter-gather sendmsg per batch. A spectator, whose queued deltas exceed a limit, loses them and gets a new snapshot
+// of its games instead. Linux only.
+class GameServer {
+ public:
+  explicit GameServer(int pWorkers);
+  GameServer(const GameServer&) = delete;
+  GameServer& operator=(const GameServer&) = delete;
+  ~GameServer();
+
+  bool listen(const std::string& host, int port);
+  void setSendBuffer(int bytes);
+  void run();
+  void stop();
+  int getPort();
+  int getConnectionCount();
+  long long getGameCount();
+  long long getMoveCount();
+  long long getResyncCount();
+
+ private:
+  // A line in the output of a connection. Deltas may be dropped, if the connection falls behind.
+  struct Chunk {
+    std::shared_ptr<const std::string> line;
+    bool delta;
+  };
+
+  struct Connection {
+    int fd;
+    uint64_t id;
+    std::string input;
+    // Lines to write, the bytes of the first line, which are written already, and the bytes to write of all lines and
+    // of the deltas
+    std::deque<Chunk> output;
+    size_t offset;
+    size_t queued;
+    size_t deltaBytes;
+    // True while the connection waits for the socket to take more output
+    bool waiting;
+    // Names of the games, the connection joined, with the number of joins, whose game did not end yet. The games are
+    // left when the connection closes.
+    std::unordered_map<std::string, int> games;
+    // Names of the watched games, and of those, which wait for a new snapshot, whose deltas are skipped meanwhile
+    std::unordered_set<std::string> watching;
+    std::unordered_set<std::string> stale;
+  };
+
+  struct Game {
+    Game();
+
+    Board board;
+    // Connections of white and black, 0 for a free seat
+    uint64_t players[2];
+    // Remaining milliseconds of white and black, the increment per move and the start of the running clock
+    double clocks[2];
+    double increment;
+    std::chrono::steady_clock::time_point turnStart;
+    // Timer of the flag fall of the running clock, 0 for none
+    uint64_t flag;
+    bool started;
+    int plies;
+    // Connections, which got a snapshot of the game and its deltas since
+    std::unordered_set<uint64_t> spectators;
+  };
+
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<GameRequest> queue;
+    std::unordered_map<std::string, std::unique_ptr<Game>> games;
+  };
+
+  void accept();
+  void read(Connection* connection);
+  void handleLine(Connection* connection, const std::string& line);
+  void send(Connection* connection, const std::string& line);
+  void send(Connection* connection, std::shared_ptr<const std::string> line, bool delta);
+  bool flush(Connection* connection);
+  void resync(Connection* connection);
+  void close(Connection* connection);
+  void subscribe(Connection* connection, const std::string& name);
+  void unsubscribe(Connection* connection, const std::string& name);
+  void deliver();
+  Worker* getWorker(const std::string& name);
+  void post(GameRequest request);
+  void work(Worker* worker);
+  void handle(Worker* worker, const GameRequest& request, std::vector<GameReply>* replies);
+  void join(Worker* worker, const GameRequest& request, std::vector<GameReply>* replies);
+  void move(Worker* worker, Game* game, const GameRequest& request, std::vector<GameReply>* replies);
+  void watch(Game* game, const GameRequest& request, std::vector<GameReply>* replies);
+  void dropClosedSpectators(Game* game);
+  bool checkFlag(Game* game);
+  void setFlag(const std::string& name, Game* game);
+  void finish(Worker* worker, const std::string& name, const std::string& result, const std::string& reason,
+              std::vector<GameReply>* replies);
+  std::string getClocks(Game* game);
+
+  int listenFd;
+  int epollFd;
+  // Wakes the event loop, when the workers have replies or the server stops
+  int wakeFd;
+  // Send buffer of every connection in bytes, 0 for the default of the system
+  int sendBuffer;
+  uint64_t nextConnection;
+  std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+  // Ids of the open connections for the workers, which drop spectators, whose connection closed before their snapshot
+  // was delivered, since those never send an unwatch
+  std::mutex liveMutex;
+  std::unordered_set<uint64_t> live;
+  // Spectators of every watched game, owned by the event loop
+  std::unordered_map<std::string, std::unordered_set<Connection*>> spectators;
+  std::vector<std::unique_ptr<Worker>> workers;
+  // Declared after the workers, so its thread stops before them
+  TimerWheel flags;
+  std::mutex outboxMutex;
+  std::vector<GameReply> outbox;
+  std::atomic<bool> stopping;
+  std::atomic<int> connectionCount;
+  std::atomic<long long> gameCount;
+  std::atomic<long long> moveCount;
+  std::atomic<long long> resyncCount;
+};
+
+#endif  // GAMESERVER_H_
@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../bench/Positions.h"
+#include "../engine/Search.h"
+#include "../profiling/AllocationProfiler.h"
+#include "../rules/moves/Notation.h"
+
+// Depth of the compared searches, the nodes of a slice of the cooperative search, and the allocations, which the
+// cooperative search may make besides those of run, for the blocks of its frame arena
+static constexpr int depth = 6;
+static constexpr long long sliceNodes = 1000;
+static constexpr unsigned long long arenaAllocations = 8;
+
+// Nodes, best move and allocations of one search
+struct SearchCount {
+  long long nodes;
+  Move best;
+  unsigned long long allocations;
+};
+
+/**
+ * Searches a position with a new Search and table, either with run or cooperatively in slices of nodes.
+ */
+static SearchCount searchPosition(const Position& position, bool cooperative) {
+  TranspositionTable table(16);
+  Search search(&table);
+  SearchLimits limits;
+  limits.depth = depth;
+  unsigned long long allocations = AllocationProfiler::getAllocations();
+  SearchResult result;
+  if (cooperative) {
+    search.begin(position, limits, {}, sliceNodes);
+    while (!search.resume()) {
+    }
+    result = search.getResult();
+  } else {
+    result = search.run(position, limits, {}, nullptr);
+  }
+  return {result.nodes, result.best, AllocationProfiler::getAllocations() - allocations};
+}
+
+/**
+ * Tests of the search on the positions of the benchmarks: two searches of a position with new Search objects search
+ * the same tree, and the cooperative search with begin and resume searches the same tree as run, with the same node
+ * count and best move, without allocating a coroutine frame per node. Prints every position and returns 1, if a test
+ * failed.
+ *
+ * Usage: searchtest
+ */
+int main() {
+  int failures = 0;
+  for (const PositionSet& set : getPositionSets()) {
+    for (const std::string& fen : set.fens) {
+      Position position;
+      if (!position.setFen(fen + " w - - 0 1")) continue;
+      SearchCount first = searchPosition(position, false);
+      SearchCount second = searchPosition(position, false);
+      SearchCount cooperative = searchPosition(position, true);
+      bool passed = first.nodes == second.nodes && first.best == second.best && first.nodes == cooperative.nodes &&
+                    first.best == cooperative.best &&
+                    cooperative.allocations <= first.allocations + arenaAllocations;
+      printf("%-4s %-10s run %lld/%lld nodes, %llu allocations, cooperative %lld nodes, %llu allocations, %s/%s  %s\n",
+             passed ? "ok" : "FAIL", set.name.c_str(), first.nodes, second.nodes, first.allocations,
+             cooperative.nodes, cooperative.allocations, Notation::toUci(first.best).c_str(),
+             Notation::toUci(cooperative.best).c_str(), fen.c_str());
+      if (!passed) failures++;
+    }
+  }
+  printf("%d failed\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/Analysis.h"
+#include "../rules/moves/Notation.h"
+
+static std::mutex outputMutex;
+
+/**
+ * Prints one line of the analysis with its depth, score and principal variation in standard algebraic notation.
+ */
+static void printLine(const Position& root, const AnalysisUpdate& update, int index) {
+  const AnalysisLine& line = update.lines[index];
+  Piece piece;
+  Position position = root;
+  std::string pv;
+  for (Move move : line.pv) {
+    pv += " " + Notation::toSan(position, move);
+    Position next;
+    position.makeMove(&piece, move, &next);
+    position = next;
+  }
+  char text[96];
+  snprintf(text, sizeof(text), "depth %2d line %d score %6d nodes %9lld time %6.2f pv", line.depth, index + 1,
+           line.score, update.nodes, update.seconds);
+  std::lock_guard<std::mutex> lock(outputMutex);
+  std::cout << text << pv << std::endl;
+}
+
+/**
+ * Streams a multi-PV analysis of a position. After the given time, the next move of the list is played and the
+ * analysis continues from the new position with the same transposition table.
+ *
+ * Usage: analyze [fen] [--lines n] [--seconds s] [--hash megabytes] [--moves e2e4 e7e5 ...]
+ */
+int main(int argc, char* argv[]) {
+  std::string fen = Position().getFen();
+  int lines = 3;
+  int hash = 64;
+  double seconds = 2;
+  std::vector<std::string> moves;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--lines" && value) {
+      lines = std::stoi(argv[++i]);
+    } else if (arg == "--seconds" && value) {
+      seconds = std::stod(argv[++i]);
+    } else if (arg == "--hash" && value) {
+      hash = std::stoi(argv[++i]);
+    } else if (arg == "--moves") {
+      while (i + 1 < argc && argv[i + 1][0] != '-') moves.push_back(argv[++i]);
+    } else if (arg[0] != '-') {
+      fen = arg;
+    } else {
+      std::cerr << "Usage: analyze [fen] [--lines n] [--seconds s] [--hash megabytes] [--moves e2e4 e7e5 ...]"
+                << std::endl;
+      return 1;
+    }
+  }
+  Position position;
+  if (!position.setFen(fen)) {
+    std::cerr << "Invalid FEN " << fen << std::endl;
+    return 1;
+  }
+
+  // Declared before the analysis, so it outlives the analysis thread, which prints it
+  Position shown = position;
+  Analysis analysis(hash, lines);
+  analysis.subscribe([&shown](const AnalysisUpdate& update) { printLine(shown, update, update.changed); });
+
+  Piece piece;
+  std::vector<Move> played;
+  for (size_t i = 0; i <= moves.size(); i++) {
+    {
+      std::lock_guard<std::mutex> lock(outputMutex);
+      std::cout << "position " << shown.getFen() << std::endl;
+    }
+    analysis.setGame(position, played);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    if (i == moves.size()) break;
+    Move move = Notation::fromUci(shown, moves[i]);
+    if (move.isNull()) {
+      std::cerr << "Illegal move " << moves[i] << std::endl;
+      break;
+    }
+    // Stop first, so the subscriber does not print the lines of the old position with the new one
+    analysis.stop();
+    while (analysis.isRunning()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    Position next;
+    shown.makeMove(&piece, move, &next);
+    shown = next;
+    played.push_back(move);
+  }
+  analysis.stop();
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../engine/Annotator.h"
+
+/**
+ * Post-game analysis of the games of a PGN file. Every position of a game is analysed with a fixed budget on a pool
+ * of threads, which share one transposition table, and the moves, which lose against the best move, are flagged as
+ * inaccuracy (?!), mistake (?) or blunder (??). The annotated games are written as PGN, with the score after every
+ * move and the best move for every flagged move in the comments.
+ *
+ * Usage: annotate <games.pgn> [--output annotated.pgn] [--threads n] [--depth n] [--nodes n] [--hash megabytes]
+ */
+int main(int argc, char* argv[]) {
+  std::string input;
+  std::string output;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  int hash = 64;
+  SearchLimits limits;
+  limits.depth = 8;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--output" && value) {
+      output = argv[++i];
+    } else if (arg == "--threads" && value) {
+      threads = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--depth" && value) {
+      limits.depth = std::stoi(argv[++i]);
+    } else if (arg == "--nodes" && value) {
+      limits.nodes = std::stoll(argv[++i]);
+    } else if (arg == "--hash" && value) {
+      hash = std::stoi(argv[++i]);
+    } else if (input.empty() && arg[0] != '-') {
+      input = arg;
+    } else {
+      input.clear();
+      break;
+    }
+  }
+  if (input.empty()) {
+    std::cerr << "Usage: annotate <games.pgn> [--output annotated.pgn] [--threads n] [--depth n] [--nodes n] "
+                 "[--hash megabytes]"
+              << std::endl;
+    return 1;
+  }
+  std::ifstream in(input);
+  if (!in) {
+    std::cerr << "Could not open " << input << std::endl;
+    return 1;
+  }
+  std::ofstream file;
+  if (!output.empty()) file.open(output);
+  std::ostream& out = output.empty() ? std::cout : file;
+
+  Annotator annotator(threads, hash);
+  PgnGame game;
+  int games = 0;
+  while (Pgn::read(in, &game)) {
+    auto start = std::chrono::steady_clock::now();
+    annotator.annotate(&game, limits);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Pgn::write(out, game);
+    games++;
+    std::cerr << "Game " << games << ": " << game.moves.size() << " plies in " << seconds << " s" << std::endl;
+  }
+  return 0;
+}
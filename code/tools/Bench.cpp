@@ -0,0 +1,300 @@
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../bench/Benchmark.h"
+#include "../bench/Positions.h"
+#include "../engine/Search.h"
+#include "../rules/board/Board.h"
+
+// Results of the measured functions are added up here, so the compiler can not remove the calls
+static volatile long long sink;
+// Depth of the searches of Search::run
+static constexpr int searchDepth = 5;
+
+/**
+ * Starts a new game from a position, with an empty undo history and white to move.
+ */
+static void startGame(Board* board, const std::string& fen) {
+  wchar_t buffer[72] = {};
+  for (int i = 0; i < fen.size() && i < 71; i++) buffer[i] = fen[i];
+  board->endGame(false, false, true);
+  board->setFen(buffer);
+  board->newGame(board->getMaxTime());
+}
+
+/**
+ * Measures the functions of the Piece class and Board::setup on every position of a set. Every operation handles the
+ * next position of the set, so the result is the average over the set.
+ */
+static void benchPositions(Benchmark* bench, const PositionSet& set) {
+  Board board(8, 8);
+  Piece piece;
+  int castling[4] = {0, 0, 0, 0};
+  std::vector<std::string> boards;
+  for (const std::string& fen : set.fens) {
+    board.setup(fen);
+    boards.push_back(board.getBoard());
+  }
+
+  int next = 0;
+  bench->run("Board::setup", set.name, [&]() {
+    sink = sink + board.setup(set.fens[next]);
+    next = (next + 1) % set.fens.size();
+    return 1;
+  });
+  bench->run("Piece::testAvailableMoves", set.name, [&]() {
+    MoveList moves;
+    piece.testAvailableMoves(boards[next], true, Move(), castling, &moves);
+    next = (next + 1) % boards.size();
+    return moves.size();
+  });
+  bench->run("Piece::hasLegalMove", set.name, [&]() {
+    sink = sink + piece.hasLegalMove(boards[next], true, Move(), castling);
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+  bench->run("Piece::testCheck", set.name, [&]() {
+    sink = sink + piece.testCheck(boards[next], true);
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+
+  // Pawn structure terms, analyzed every time and looked up in the pawn table, which already holds all positions
+  std::vector<uint64_t> pawnKeys;
+  PawnTable pawnTable(1 << 13);
+  for (const std::string& squares : boards) pawnKeys.push_back(PawnTable::computeKey(squares));
+  bench->run("PawnTable::analyze", set.name, [&]() {
+    PawnEntry entry;
+    PawnTable::analyze(boards[next], &entry);
+    sink = sink + entry.score;
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+  bench->run("PawnTable::probe", set.name, [&]() {
+    sink = sink + pawnTable.probe(boards[next], pawnKeys[next]).score;
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+
+  // Every capture of the set, each operation evaluates the next one
+  std::vector<std::pair<int, Move>> captures;
+  for (int i = 0; i < boards.size(); i++) {
+    MoveList moves;
+    piece.testAvailableMoves(boards[i], true, Move(), castling, &moves);
+    for (Move move : moves) {
+      if (move.isCapture()) captures.push_back({i, move});
+    }
+  }
+  if (captures.empty()) return;
+  next = 0;
+  bench->run("Piece::see", set.name, [&]() {
+    sink = sink + piece.see(boards[captures[next].first], captures[next].second);
+    next = (next + 1) % captures.size();
+    return 1;
+  });
+}
+
+/**
+ * Measures the evaluation network on every position of a set: calculating the accumulator from scratch, updating it
+ * with one of the legal moves and evaluating it.
+ */
+static void benchNetwork(Benchmark* bench, const PositionSet& set, Nnue* network) {
+  Board board(8, 8);
+  Piece piece;
+  int castling[4] = {0, 0, 0, 0};
+  std::vector<std::string> boards;
+  std::vector<std::string> after;
+  std::vector<NnueAccumulator> accumulators(set.fens.size());
+  for (const std::string& fen : set.fens) {
+    board.setup(fen);
+    boards.push_back(board.getBoard());
+    network->refresh(boards.back(), &accumulators[boards.size() - 1]);
+    // The board after the middle legal move
+    MoveList moves;
+    piece.testAvailableMoves(boards.back(), true, Move(), castling, &moves);
+    after.push_back(boards.back());
+    if (!moves.isEmpty()) piece.makeMove(after.back(), moves[moves.size() / 2]);
+  }
+
+  int next = 0;
+  NnueAccumulator accumulator;
+  bench->run("Nnue::refresh", set.name, [&]() {
+    network->refresh(boards[next], &accumulator);
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+  bench->run("Nnue::update", set.name, [&]() {
+    network->update(accumulators[next], boards[next], after[next], &accumulator);
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+  bench->run("Nnue::evaluate", set.name, [&]() {
+    sink = sink + network->evaluate(accumulators[next], true);
+    next = (next + 1) % boards.size();
+    return 1;
+  });
+}
+
+/**
+ * Measures Board::movePiece and Board::undoMove, by playing short random games with a fixed seed from every position
+ * of a set and taking them back again. Every call is timed on its own, since the games have to be set up in between.
+ */
+static void benchMoves(Benchmark* bench, const PositionSet& set) {
+  if (!bench->isSelected("Board::movePiece", set.name) && !bench->isSelected("Board::undoMove", set.name)) return;
+  Board board(8, 8);
+  std::mt19937 random(1);
+  BenchmarkResult moves = {"Board::movePiece", set.name, 0, 0, 0.0, 0, {}, 0, {}, {}};
+  BenchmarkResult undos = {"Board::undoMove", set.name, 0, 0, 0.0, 0, {}, 0, {}, {}};
+
+  while (moves.seconds < bench->getMinTime()) {
+    for (const std::string& fen : set.fens) {
+      startGame(&board, fen);
+      int played = 0;
+      for (int ply = 0; ply < 8; ply++) {
+        MoveList available;
+        board.testAvailableMoves(&available);
+        if (available.isEmpty()) break;
+        Move move = available[random() % available.size()];
+        int from[2] = {move.getFrom() % 8, move.getFrom() / 8};
+        int to[2] = {move.getTo() % 8, move.getTo() / 8};
+
+        BenchmarkSample sample;
+        bench->startSample(&sample);
+        board.beginMovePiece(from[0], from[1]);
+        bool done = board.movePiece(from[0], from[1], to[0], to[1], ' ');
+        if (!done && board.isPromoting())
+          done = board.movePiece(from[0], from[1], to[0], to[1], board.getTurn() ? 'Q' : 'q');
+        bench->stopSample(sample, &moves);
+        moves.operations++;
+        moves.items++;
+        // The game ended, so there is nothing to take back
+        if (!done) {
+          played = 0;
+          break;
+        }
+        played++;
+      }
+
+      // The first move stays on the board, since taking it back starts a new game
+      for (int i = 1; i < played; i++) {
+        BenchmarkSample sample;
+        bench->startSample(&sample);
+        board.undoMove();
+        bench->stopSample(sample, &undos);
+        undos.operations++;
+        undos.items++;
+      }
+    }
+  }
+  if (bench->isSelected(moves.name, set.name)) bench->add(moves);
+  if (bench->isSelected(undos.name, set.name)) bench->add(undos);
+}
+
+/**
+ * Measures Search::run with a fixed depth on every position of a set. Every search starts with an empty table and is
+ * timed as a whole, but counted as one operation per node, so the time, the allocations and the hardware counters are
+ * reported per node of the search.
+ */
+static void benchSearch(Benchmark* bench, const PositionSet& set, Nnue* network) {
+  if (!bench->isSelected("Search::run", set.name)) return;
+  TranspositionTable table(16);
+  Search search(&table);
+  search.setNetwork(network);
+  SearchLimits limits;
+  limits.depth = searchDepth;
+  std::vector<Position> positions;
+  for (const std::string& fen : set.fens) {
+    Position position;
+    if (position.setFen(fen + " w - - 0 1")) positions.push_back(position);
+  }
+  BenchmarkResult nodes = {"Search::run", set.name, 0, 0, 0.0, 0, {}, 0, {}, {}};
+
+  while (nodes.seconds < bench->getMinTime() && !positions.empty()) {
+    for (const Position& position : positions) {
+      table.clear();
+      BenchmarkSample sample;
+      bench->startSample(&sample);
+      SearchResult result = search.run(position, limits, {}, nullptr);
+      bench->stopSample(sample, &nodes);
+      nodes.operations += result.nodes;
+      nodes.items += result.nodes;
+      sink = sink + result.score;
+    }
+  }
+  bench->add(nodes);
+}
+
+/**
+ * Microbenchmarks of the rules hot paths. Every benchmark runs on the fixed position sets and reports the time, the
+ * heap allocations and bytes per operation and the throughput. Allocations inside the profiled regions, like
+ * "movePiece" or "legalMoves", are listed per benchmark below the table.
+ *
+ * Usage: bench [--time <seconds>] [--filter <text>] [--json <output.json>] [--counters] [--network <file>]
+ *
+ * --time sets the minimum measuring time of every benchmark (default 0.5), --filter only runs the benchmarks, whose
+ * "name/set" contains the text, and --json additionally writes the results in a machine-readable form. --counters adds
+ * the hardware performance counters per operation, if the system provides them. --network loads an evaluation
+ * network, adds the benchmarks of the network and evaluates the searches with it. An operation of Search::run is one
+ * node of a search with a fixed depth.
+ */
+int main(int argc, char* argv[]) {
+  double minTime = 0.5;
+  std::string filter;
+  std::string json;
+  bool useCounters = false;
+  std::string networkPath;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+      minTime = std::stod(argv[++i]);
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json = argv[++i];
+    } else if (strcmp(argv[i], "--counters") == 0) {
+      useCounters = true;
+    } else if (strcmp(argv[i], "--network") == 0 && i + 1 < argc) {
+      networkPath = argv[++i];
+    } else {
+      std::cerr << "Usage: bench [--time <seconds>] [--filter <text>] [--json <output.json>] [--counters] "
+                   "[--network <file>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  Benchmark bench(minTime, filter);
+  PerfCounters counters;
+  if (useCounters) {
+    if (counters.open())
+      bench.setCounters(&counters);
+    else
+      std::cerr << "Hardware performance counters are not available, measuring without them" << std::endl;
+  }
+  Nnue* network = nullptr;
+  if (!networkPath.empty()) {
+    network = new Nnue();
+    if (!network->load(networkPath)) {
+      std::cerr << "Could not load the network " << networkPath << std::endl;
+      delete network;
+      return 1;
+    }
+    std::cout << "Network kernels: " << network->getKernel() << std::endl;
+  }
+  for (const PositionSet& set : getPositionSets()) {
+    benchPositions(&bench, set);
+    benchMoves(&bench, set);
+    benchSearch(&bench, set, network);
+    if (network != nullptr) benchNetwork(&bench, set, network);
+  }
+  bench.print(std::cout);
+
+  delete network;
+
+  if (!json.empty() && !bench.writeJson(json)) {
+    std::cerr << "Could not write " << json << std::endl;
+    return 1;
+  }
+  return 0;
+}
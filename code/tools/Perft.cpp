@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../profiling/PerfCounters.h"
+#include "../rules/board/Board.h"
+
+/**
+ * Writes a square in algebraic notation (e.g. "e4") into text.
+ */
+static void squareName(int square, char* text) {
+  text[0] = 'a' + square % 8;
+  text[1] = '8' - square / 8;
+  text[2] = '\0';
+}
+
+/**
+ * Updates the castling availability after a move, the same way Board::movePiece does: moving the king loses both
+ * sides, moving or capturing a rook in its corner loses that side. 0 means available.
+ */
+static void updateCastling(const std::string& board, Move move, const int castling[4], int next[4]) {
+  const int corners[4] = {56, 63, 0, 7};
+  char movedPiece = board[move.getFrom()];
+  for (int i = 0; i < 4; i++) {
+    next[i] = castling[i];
+    if (move.getFrom() == corners[i] || (move.getTo() == corners[i] && move.isCapture())) next[i] = 1;
+  }
+  if (movedPiece == 'K') next[0] = next[1] = 1;
+  if (movedPiece == 'k') next[2] = next[3] = 1;
+}
+
+/**
+ * Counts the leaf nodes of the move tree up to the given depth. Every ply has its own board string, which keeps its
+ * capacity, so the search does not allocate.
+ */
+static long long perft(Piece* piece, std::vector<std::string>& boards, int ply, int depth, bool turn, Move lastMove,
+                       const int castling[4]) {
+  MoveList moves;
+  piece->testAvailableMoves(boards[ply], turn, lastMove, castling, &moves);
+  if (depth <= 1) return moves.size();
+
+  long long nodes = 0;
+  for (Move move : moves) {
+    int nextCastling[4];
+    updateCastling(boards[ply], move, castling, nextCastling);
+    boards[ply + 1] = boards[ply];
+    piece->makeMove(boards[ply + 1], move);
+    nodes += perft(piece, boards, ply + 1, depth - 1, !turn, move, nextCastling);
+  }
+  return nodes;
+}
+
+/**
+ * Counts all positions, which can be reached from a position in the given number of plies, to verify the move
+ * generator against known numbers and to measure its speed.
+ *
+ * Usage: perft "<fen>" <depth> [--divide] [--counters]
+ *
+ * The FEN may contain the side to move, the castling availability and the en passant square after the piece placement.
+ * --divide prints the node count of every move of the position, --counters adds the hardware performance counters.
+ */
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: perft \"<fen>\" <depth> [--divide] [--counters]" << std::endl;
+    return 1;
+  }
+  int depth = std::stoi(argv[2]);
+  bool divide = false;
+  bool useCounters = false;
+  for (int i = 3; i < argc; i++) {
+    if (strcmp(argv[i], "--divide") == 0) divide = true;
+    if (strcmp(argv[i], "--counters") == 0) useCounters = true;
+  }
+
+  // Split the FEN into its fields
+  std::istringstream fields(argv[1]);
+  std::string placement, side = "w", castlingField = "KQkq", passantField = "-";
+  fields >> placement >> side >> castlingField >> passantField;
+  Board board(8, 8);
+  if (depth < 1 || !board.setup(placement)) return 1;
+  bool turn = side != "b";
+  int castling[4] = {1, 1, 1, 1};
+  const char* castlingNames = "QKqk";
+  for (int i = 0; i < 4; i++) {
+    if (castlingField.find(castlingNames[i]) != std::string::npos) castling[i] = 0;
+  }
+  // The en passant square is behind the pawn, which was just pushed two squares
+  Move lastMove;
+  if (passantField.size() == 2) {
+    int x = passantField[0] - 'a';
+    int y = '8' - passantField[1];
+    int from = (y + (turn ? -1 : 1)) * 8 + x;
+    int to = (y + (turn ? 1 : -1)) * 8 + x;
+    lastMove = Move(from, to, Move::DoublePush);
+  }
+
+  Piece piece;
+  std::vector<std::string> boards(depth + 1, board.getBoard());
+  PerfCounters counters;
+  if (useCounters && !counters.open())
+    std::cerr << "Hardware performance counters are not available, measuring without them" << std::endl;
+  unsigned long long before[PerfCounters::count], after[PerfCounters::count];
+  counters.read(before);
+  auto start = std::chrono::steady_clock::now();
+
+  long long nodes = 0;
+  if (divide) {
+    MoveList moves;
+    piece.testAvailableMoves(boards[0], turn, lastMove, castling, &moves);
+    for (Move move : moves) {
+      int nextCastling[4];
+      updateCastling(boards[0], move, castling, nextCastling);
+      boards[1] = boards[0];
+      piece.makeMove(boards[1], move);
+      long long count = depth > 1 ? perft(&piece, boards, 1, depth - 1, !turn, move, nextCastling) : 1;
+      char from[3], to[3];
+      squareName(move.getFrom(), from);
+      squareName(move.getTo(), to);
+      char promotion[2] = {move.getPromotionPiece(false), '\0'};
+      printf("%s%s%s: %lld\n", from, to, move.isPromotion() ? promotion : "", count);
+      nodes += count;
+    }
+  } else {
+    nodes = perft(&piece, boards, 0, depth, turn, lastMove, castling);
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  counters.read(after);
+  printf("nodes %lld, %.3f s, %.0f nodes/s\n", nodes, seconds, seconds > 0 ? nodes / seconds : 0.0);
+  for (int i = 0; i < PerfCounters::count; i++) {
+    if (!counters.isAvailable(i)) continue;
+    printf("%s: %llu (%.1f per node)\n", PerfCounters::getName(i), after[i] - before[i],
+           nodes > 0 ? (double)(after[i] - before[i]) / nodes : 0.0);
+  }
+  return 0;
+}
@@ -0,0 +1,301 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../rules/moves/Notation.h"
+
+// A connection of the players, which plays white or black in several games
+struct PlayerConnection {
+  int fd;
+  std::string input;
+  std::string output;
+};
+
+// A game of two connections, with the position, which both players follow
+struct PlayerGame {
+  int connections[2];
+  Position position;
+  int plies;
+  bool ended;
+  std::chrono::steady_clock::time_point sent;
+};
+
+/**
+ * Writes as much output of a connection, as the socket takes.
+ */
+static void flushOutput(PlayerConnection* connection) {
+  while (!connection->output.empty()) {
+    ssize_t size = send(connection->fd, connection->output.data(), connection->output.size(), MSG_NOSIGNAL);
+    if (size <= 0) return;
+    connection->output.erase(0, size);
+  }
+}
+
+/**
+ * Opens a connection to the server.
+ *
+ * @return The socket, or -1 if the server can not be reached.
+ */
+static int connectTo(const std::string& host, int port, int receiveBuffer = 0) {
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) return -1;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  if (receiveBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+  if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  int noDelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+/**
+ * Load test of the game server: many games are played at once with random moves over a few connections, every
+ * connection plays one color in many games. A game is resigned after a number of plies. In the idle games, black
+ * never moves, so the server has to end them by timeout. Prints the moves per second, the latencies between a move and
+ * its confirmation by the server, and how late the flag falls of the idle games were. Every spectator connection
+ * watches the first games from their start and checks, that the deltas follow their snapshots without a gap. With a
+ * pause, the spectators read nothing for a while through small receive buffers, so the server has to resync them.
+ * The system grows the send buffers of the server by some MB, which takes the deltas of a short pause, so the server
+ * should run with a small --send-buffer for that test.
+ *
+ * Usage: players [--host address] [--port n] [--games n] [--connections n] [--plies n] [--seconds s] [--time s]
+ *                [--idle n] [--spectators n] [--watched n] [--pause s]
+ */
+int main(int argc, char* argv[]) {
+  std::string host = "127.0.0.1";
+  int port = 7878;
+  int gameCount = 1000;
+  int connectionCount = 100;
+  int maxPlies = 60;
+  double seconds = 60;
+  double time = 3600;
+  int idle = 0;
+  int spectatorCount = 0;
+  int watched = 10;
+  double pause = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--host" && value) {
+      host = argv[++i];
+    } else if (arg == "--port" && value) {
+      port = std::stoi(argv[++i]);
+    } else if (arg == "--games" && value) {
+      gameCount = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--connections" && value) {
+      connectionCount = std::max(2, std::stoi(argv[++i]) / 2 * 2);
+    } else if (arg == "--plies" && value) {
+      maxPlies = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--seconds" && value) {
+      seconds = std::stod(argv[++i]);
+    } else if (arg == "--time" && value) {
+      time = std::stod(argv[++i]);
+    } else if (arg == "--idle" && value) {
+      idle = std::stoi(argv[++i]);
+    } else if (arg == "--spectators" && value) {
+      spectatorCount = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--watched" && value) {
+      watched = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--pause" && value) {
+      pause = std::stod(argv[++i]);
+    } else {
+      std::cerr << "Usage: players [--host address] [--port n] [--games n] [--connections n] [--plies n] "
+                   "[--seconds s] [--time s] [--idle n] [--spectators n] [--watched n] [--pause s]"
+                << std::endl;
+      return 1;
+    }
+  }
+  rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  int epollFd = epoll_create1(0);
+  // The spectators follow the players, and are only read after the pause
+  std::vector<PlayerConnection> connections(connectionCount + spectatorCount);
+  watched = std::min(watched, gameCount);
+  auto listen = [&](int i) {
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u32 = i;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, connections[i].fd, &event);
+  };
+  for (int i = 0; i < connectionCount + spectatorCount; i++) {
+    connections[i].fd = connectTo(host, port, i >= connectionCount && pause > 0 ? 4096 : 0);
+    if (connections[i].fd < 0) {
+      std::cerr << "Could not connect to " << host << ":" << port << std::endl;
+      return 1;
+    }
+    if (i < connectionCount || pause <= 0) listen(i);
+  }
+
+  // White joins first and sets the time control, black joins, when white has the game
+  std::vector<PlayerGame> games(gameCount);
+  for (int i = 0; i < gameCount; i++) {
+    games[i].connections[0] = 2 * i % connectionCount;
+    games[i].connections[1] = (2 * i + 1) % connectionCount;
+    games[i].plies = 0;
+    games[i].ended = false;
+    connections[games[i].connections[0]].output += "join g" + std::to_string(i) + " " + std::to_string(time) + "\n";
+  }
+
+  Piece piece;
+  std::mt19937 random(1);
+  std::vector<double> latencies;
+  std::vector<double> flagDelays;
+  long long errors = 0;
+  int ended = 0;
+  // Last ply of every watched game of every spectator, -1 before its snapshot, and the watches, which did not end yet
+  std::vector<std::vector<int>> spectatorPlies(spectatorCount, std::vector<int>(watched, -1));
+  long long deltas = 0, snapshots = 0, missed = 0;
+  int watching = 0;
+  // Sends a random move, or resigns after the last ply
+  auto play = [&](PlayerGame* game, int index) {
+    int side = game->position.turn ? 0 : 1;
+    if (side == 1 && index < idle) return;
+    game->sent = std::chrono::steady_clock::now();
+    PlayerConnection* connection = &connections[game->connections[side]];
+    std::string name = "g" + std::to_string(index);
+    MoveList moves;
+    piece.testAvailableMoves(game->position.board, game->position.turn, game->position.lastMove,
+                             game->position.castling, &moves);
+    if (game->plies >= maxPlies || moves.isEmpty()) {
+      connection->output += "resign " + name + "\n";
+      return;
+    }
+    connection->output += "move " + name + " " + Notation::toUci(moves[random() % moves.size()]) + "\n";
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  for (PlayerConnection& connection : connections) flushOutput(&connection);
+  epoll_event events[256];
+  bool paused = pause > 0;
+  while ((ended < gameCount || watching > 0) &&
+         std::chrono::steady_clock::now() - start < std::chrono::duration<double>(seconds)) {
+    if (paused && std::chrono::steady_clock::now() - start >= std::chrono::duration<double>(pause)) {
+      for (int i = connectionCount; i < connectionCount + spectatorCount; i++) listen(i);
+      paused = false;
+    }
+    int count = epoll_wait(epollFd, events, 256, 100);
+    for (int e = 0; e < count; e++) {
+      int spectator = (int)events[e].data.u32 - connectionCount;
+      PlayerConnection* connection = &connections[events[e].data.u32];
+      char buffer[16384];
+      ssize_t size = read(connection->fd, buffer, sizeof(buffer));
+      if (size < 0 && errno == EAGAIN) continue;
+      if (size <= 0) {
+        std::cerr << "The server closed a connection" << std::endl;
+        return 1;
+      }
+      connection->input.append(buffer, size);
+      size_t begin = 0, end;
+      while ((end = connection->input.find('\n', begin)) != std::string::npos) {
+        std::istringstream line(connection->input.substr(begin, end - begin));
+        begin = end + 1;
+        std::string type, name, argument;
+        line >> type >> name >> argument;
+        int index = name.size() > 1 && name[0] == 'g' ? atoi(name.c_str() + 1) : -1;
+        if (spectator >= 0 && index >= 0 && index < watched) {
+          // A delta has to follow the last ply, a snapshot may skip plies after dropped deltas
+          int* plies = &spectatorPlies[spectator][index];
+          int ply = atoi(argument.c_str());
+          if (type == "snapshot" && ply >= *plies) {
+            *plies = ply;
+            snapshots++;
+          } else if (type == "delta" && *plies >= 0 && ply == *plies + 1) {
+            *plies = ply;
+            deltas++;
+          } else if (type == "end") {
+            watching--;
+          } else if (type == "error" && *plies < 0) {
+            // The game ended, before the watch arrived
+            watching--;
+            missed++;
+          } else if (errors++ < 10) {
+            std::cerr << line.str() << std::endl;
+          }
+          continue;
+        }
+        // A move, which was sent before the end of the game arrived, is answered with an error
+        if (index < 0 || index >= gameCount || (type == "error" && !games[index].ended)) {
+          if (errors++ < 10) std::cerr << line.str() << std::endl;
+          continue;
+        }
+        PlayerGame* game = &games[index];
+        if (type == "joined" && argument == "white") {
+          connections[game->connections[1]].output += "join " + name + "\n";
+        } else if (type == "start" && connection == &connections[game->connections[0]]) {
+          for (int i = 0; i < spectatorCount && index < watched; i++) {
+            connections[connectionCount + i].output += "watch " + name + "\n";
+            watching++;
+          }
+          play(game, index);
+        } else if (type == "ok") {
+          auto now = std::chrono::steady_clock::now();
+          latencies.push_back(std::chrono::duration<double, std::micro>(now - game->sent).count());
+        } else if (type == "moved") {
+          // The opponent of the mover follows the game and plays the next move
+          Position next;
+          game->position.makeMove(&piece, Notation::fromUci(game->position, argument), &next);
+          game->position = next;
+          game->plies++;
+          play(game, index);
+        } else if (type == "end" && !game->ended) {
+          game->ended = true;
+          ended++;
+          // The clock of the idle player started, when the server got the move of white, so the delay includes the
+          // latency of that move
+          if (index < idle) {
+            auto delay = std::chrono::steady_clock::now() - game->sent - std::chrono::duration<double>(time);
+            flagDelays.push_back(std::chrono::duration<double, std::milli>(delay).count());
+          }
+        }
+      }
+      connection->input.erase(0, begin);
+    }
+    for (PlayerConnection& connection : connections) flushOutput(&connection);
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) { return latencies.empty() ? 0 : latencies[(size_t)(p * (latencies.size() - 1))]; };
+  printf("%d of %d games ended over %d connections, %zu moves in %.2f s, %.0f moves/s, %lld errors\n", ended,
+         gameCount, connectionCount, latencies.size(), elapsed, latencies.size() / elapsed, errors);
+  printf("latency us: median %.0f, 99th percentile %.0f, max %.0f\n", percentile(0.5), percentile(0.99),
+         percentile(1.0));
+  if (spectatorCount > 0) {
+    printf("%d spectators of %d games: %lld deltas, %lld snapshots, %lld missed games\n", spectatorCount, watched,
+           deltas, snapshots, missed);
+  }
+  if (!flagDelays.empty()) {
+    std::sort(flagDelays.begin(), flagDelays.end());
+    printf("%zu flag falls, ms after the move of white and the time: min %.1f, median %.1f, max %.1f\n",
+           flagDelays.size(), flagDelays[0], flagDelays[flagDelays.size() / 2], flagDelays.back());
+  }
+  for (PlayerConnection& connection : connections) close(connection.fd);
+  close(epollFd);
+  return ended == gameCount && errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/Mcts.h"
+#include "../rules/moves/Notation.h"
+
+/**
+ * Prints the result of a tree search: the win, draw and loss probabilities of the player to move, the speed and the
+ * line of the most visited moves in standard algebraic notation.
+ */
+static void printResult(const Position& root, const MctsResult& result) {
+  Piece piece;
+  Position position = root;
+  std::string pv;
+  for (Move move : result.pv) {
+    pv += " " + Notation::toSan(position, move);
+    Position next;
+    position.makeMove(&piece, move, &next);
+    position = next;
+  }
+  printf("win %4.1f%% draw %4.1f%% loss %4.1f%% score %5d playouts %8lld (%.0f/s) nodes %8d depth %2d pv%s\n",
+         result.value.win * 100, result.value.draw * 100, result.value.loss * 100, result.score, result.playouts,
+         result.playouts / std::max(result.seconds, 1e-9), result.nodes, result.depth, pv.c_str());
+}
+
+/**
+ * Monte Carlo tree search of a position, with the win, draw and loss probabilities of the player to move. After the
+ * given time, the next move of the list is played and the search continues with the part of the tree after the move.
+ *
+ * Usage: playouts [fen] [--threads n] [--seconds s] [--hash megabytes] [--network file] [--moves e2e4 e7e5 ...]
+ */
+int main(int argc, char* argv[]) {
+  std::string fen = Position().getFen();
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  int hash = 256;
+  double seconds = 2;
+  std::string network;
+  std::vector<std::string> moves;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--threads" && value) {
+      threads = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--seconds" && value) {
+      seconds = std::stod(argv[++i]);
+    } else if (arg == "--hash" && value) {
+      hash = std::stoi(argv[++i]);
+    } else if (arg == "--network" && value) {
+      network = argv[++i];
+    } else if (arg == "--moves") {
+      while (i + 1 < argc && argv[i + 1][0] != '-') moves.push_back(argv[++i]);
+    } else if (arg[0] != '-') {
+      fen = arg;
+    } else {
+      std::cerr << "Usage: playouts [fen] [--threads n] [--seconds s] [--hash megabytes] [--network file] "
+                   "[--moves e2e4 e7e5 ...]"
+                << std::endl;
+      return 1;
+    }
+  }
+  Position position;
+  if (!position.setFen(fen)) {
+    std::cerr << "Invalid FEN " << fen << std::endl;
+    return 1;
+  }
+
+  Mcts mcts(threads, hash);
+  Nnue nnue;
+  if (!network.empty()) {
+    if (!nnue.load(network)) {
+      std::cerr << "Could not load the network " << network << std::endl;
+      return 1;
+    }
+    mcts.setEvaluator(Mcts::networkEvaluator(&nnue));
+  }
+
+  Piece piece;
+  std::vector<uint64_t> keys;
+  SearchLimits limits;
+  limits.softTime = seconds;
+  for (size_t i = 0; i <= moves.size(); i++) {
+    printResult(position, mcts.run(position, limits, keys));
+    if (i == moves.size()) break;
+    Move move = Notation::fromUci(position, moves[i]);
+    if (move.isNull()) {
+      std::cerr << "Illegal move " << moves[i] << std::endl;
+      return 1;
+    }
+    std::cout << "Move " << Notation::toSan(position, move) << std::endl;
+    keys.push_back(position.getKey());
+    Position next;
+    position.makeMove(&piece, move, &next);
+    position = next;
+  }
+  return 0;
+}
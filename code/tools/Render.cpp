@@ -0,0 +1,56 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../gui/Paint.h"
+#include "../gui/render/SoftwareRenderer.h"
+#include "../profiling/AllocationProfiler.h"
+#include "../profiling/Trace.h"
+#include "../rules/board/Board.h"
+
+/**
+ * Headless renderer: draws a position with the same Paint code as the window, but rasterizes it into an RGBA buffer
+ * and writes it as a PNG file. Run it from the repository root, so the graphics folder is found.
+ *
+ * Usage: render <fen> <output.png> [frames] [width] [height]
+ *
+ * If more than one frame is requested, the frame is rendered repeatedly and the average cost is printed. If tracing is
+ * compiled in, the spans of all frames are written to trace.json, and the allocation profiler writes its counts, like
+ * the allocations per "frame", to allocations.txt.
+ */
+int main(int argc, char* argv[]) {
+  TRACE_THREAD("render");
+  if (argc < 3) {
+    std::cerr << "Usage: render <fen> <output.png> [frames] [width] [height]" << std::endl;
+    return 1;
+  }
+  int frames = argc > 3 ? std::stoi(argv[3]) : 1;
+  int width = argc > 4 ? std::stoi(argv[4]) : 1500;
+  int height = argc > 5 ? std::stoi(argv[5]) : 800;
+
+  Board* board = new Board(8, 8);
+  if (!board->setup(argv[1])) return 1;
+  Paint paint(board, width, height);
+  RenderList list;
+  SoftwareRenderer renderer(width, height);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    paint.drawFrame(&list, false, 0, 0);
+    renderer.render(list);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  if (frames > 1) {
+    std::cout << list.size() << " commands, "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / frames << " us/frame"
+              << std::endl;
+  }
+  if (!renderer.savePng(argv[2])) {
+    std::cerr << "Could not write " << argv[2] << std::endl;
+    return 1;
+  }
+  TRACE_DUMP("trace.json");
+  ALLOCATION_DUMP("allocations.txt");
+  return 0;
+}
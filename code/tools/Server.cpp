@@ -0,0 +1,72 @@
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../server/GameServer.h"
+
+static GameServer* server = nullptr;
+
+/**
+ * Stops the server on SIGINT and SIGTERM.
+ */
+static void onSignal(int) {
+  if (server != nullptr) server->stop();
+}
+
+/**
+ * Hosts many games for clients over TCP, see GameServer for the line protocol. Runs until it is interrupted, then
+ * prints the number of moves. The limit of open files is raised as far as allowed, since every client is a socket.
+ * A small send buffer lets slow spectators fall behind sooner, like for the --pause of the players tool.
+ *
+ * Usage: server [--host address] [--port n] [--workers n] [--send-buffer bytes]
+ */
+int main(int argc, char* argv[]) {
+  std::string host = "127.0.0.1";
+  int port = 7878;
+  int workers = std::max(1u, std::thread::hardware_concurrency());
+  int sendBuffer = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--host" && value) {
+      host = argv[++i];
+    } else if (arg == "--port" && value) {
+      port = std::stoi(argv[++i]);
+    } else if (arg == "--workers" && value) {
+      workers = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--send-buffer" && value) {
+      sendBuffer = std::max(0, std::stoi(argv[++i]));
+    } else {
+      std::cerr << "Usage: server [--host address] [--port n] [--workers n] [--send-buffer bytes]" << std::endl;
+      return 1;
+    }
+  }
+  rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  GameServer gameServer(workers);
+  gameServer.setSendBuffer(sendBuffer);
+  if (!gameServer.listen(host, port)) {
+    std::cerr << "Could not listen on " << host << ":" << port << std::endl;
+    return 1;
+  }
+  server = &gameServer;
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  printf("Listening on %s:%d with %d workers\n", host.c_str(), gameServer.getPort(), workers);
+  fflush(stdout);
+  gameServer.run();
+  printf("Stopped after %lld moves and %lld resyncs, %d connections and %lld games were open\n",
+         gameServer.getMoveCount(), gameServer.getResyncCount(), gameServer.getConnectionCount(),
+         gameServer.getGameCount());
+  server = nullptr;
+  return 0;
+}
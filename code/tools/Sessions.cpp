@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/SearchScheduler.h"
+
+/**
+ * Many concurrent shallow searches on a fixed pool of threads, like the hints and blunder checks of a server with many
+ * games. The positions are reached by random moves from the start position, every session gets a random deadline
+ * between a quarter of the given deadline and the full deadline, and the sessions with the earliest deadlines run
+ * first. Prints how many sessions reached their depth before the deadline and the latencies.
+ *
+ * Usage: sessions [--sessions n] [--threads n] [--depth n] [--deadline seconds] [--slice nodes] [--hash megabytes]
+ */
+int main(int argc, char* argv[]) {
+  int count = 200;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  int hash = 64;
+  double deadline = 2.0;
+  long long slice = 2000;
+  SearchLimits limits;
+  limits.depth = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--sessions" && value) {
+      count = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--threads" && value) {
+      threads = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--depth" && value) {
+      limits.depth = std::stoi(argv[++i]);
+    } else if (arg == "--deadline" && value) {
+      deadline = std::stod(argv[++i]);
+    } else if (arg == "--slice" && value) {
+      slice = std::stoll(argv[++i]);
+    } else if (arg == "--hash" && value) {
+      hash = std::stoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: sessions [--sessions n] [--threads n] [--depth n] [--deadline seconds] [--slice nodes] "
+                   "[--hash megabytes]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // Positions after 4 to 20 random moves, with the keys of the moves before them
+  std::mt19937 random(1);
+  Piece piece;
+  std::vector<Position> positions;
+  std::vector<std::vector<uint64_t>> keys;
+  while ((int)positions.size() < count) {
+    Position position;
+    std::vector<uint64_t> gameKeys;
+    int plies = 4 + random() % 17;
+    for (int ply = 0; ply < plies; ply++) {
+      MoveList moves;
+      piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+      if (moves.isEmpty()) break;
+      gameKeys.push_back(position.getKey());
+      Position next;
+      position.makeMove(&piece, moves[random() % moves.size()], &next);
+      position = next;
+    }
+    MoveList moves;
+    piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+    if (moves.isEmpty()) continue;
+    positions.push_back(position);
+    keys.push_back(gameKeys);
+  }
+
+  std::mutex resultMutex;
+  std::vector<double> latencies;
+  int complete = 0;
+  long long nodes = 0;
+  std::uniform_real_distribution<double> deadlines(deadline / 4, deadline);
+  auto start = std::chrono::steady_clock::now();
+  {
+    SearchScheduler scheduler(threads, hash, slice);
+    for (int i = 0; i < count; i++) {
+      double sessionDeadline = deadlines(random);
+      scheduler.submit(positions[i], keys[i], limits, sessionDeadline,
+                       [&, sessionDeadline](int, const SearchResult& result) {
+                         double latency =
+                             std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                         std::lock_guard<std::mutex> lock(resultMutex);
+                         latencies.push_back(latency);
+                         if (result.depth >= limits.depth && latency <= sessionDeadline) complete++;
+                         nodes += result.nodes;
+                       });
+    }
+    scheduler.wait();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  double sum = 0;
+  for (double latency : latencies) sum += latency;
+  printf("Sessions %d on %d threads, depth %d, deadlines %.2f-%.2f s\n", count, threads, limits.depth, deadline / 4,
+         deadline);
+  printf("Reached the depth before the deadline: %d (%.1f%%)\n", complete, 100.0 * complete / count);
+  printf("Latency mean %.3f s, median %.3f s, max %.3f s\n", sum / latencies.size(),
+         latencies[latencies.size() / 2], latencies.back());
+  printf("Nodes %lld in %.2f s, %.0f nodes/s\n", nodes, seconds, nodes / seconds);
+  return 0;
+}
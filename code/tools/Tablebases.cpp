@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/TablebaseGenerator.h"
+#include "../rules/moves/Notation.h"
+
+/**
+ * Prints the value of a position and the line of perfect play from it, until the mate, or only the first move of a
+ * draw.
+ */
+static bool printLine(Tablebase* tablebase, const std::string& fen) {
+  Position position;
+  if (!position.setFen(fen)) {
+    std::cerr << "Invalid FEN " << fen << std::endl;
+    return false;
+  }
+  int result, moves;
+  if (!tablebase->probe(position, &result, &moves)) {
+    std::cerr << "Not in the tables " << fen << std::endl;
+    return false;
+  }
+  if (result == 0) {
+    printf("%s: draw\n", fen.c_str());
+  } else {
+    printf("%s: %s in %d\n", fen.c_str(), result > 0 ? "mate" : "mated", moves);
+  }
+  Piece piece;
+  std::string line;
+  for (int ply = 0; ply < 300; ply++) {
+    Move move = tablebase->getBestMove(position, &result, &moves);
+    if (move.isNull() || (result == 0 && ply > 0)) break;
+    line += " " + Notation::toSan(position, move);
+    Position next;
+    position.makeMove(&piece, move, &next);
+    position = next;
+  }
+  printf("line%s\n", line.c_str());
+  return true;
+}
+
+/**
+ * Generates the endgame tablebases of all endings up to a number of pieces, which are not yet in the directory, and
+ * prints the statistics of every new table. Then prints the value and the line of perfect play of the given positions.
+ *
+ * Usage: tablebases [--directory dir] [--pieces n] [--threads n] [fen ...]
+ */
+int main(int argc, char* argv[]) {
+  std::string directory = "tables";
+  int pieces = 4;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> fens;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--directory" && value) {
+      directory = argv[++i];
+    } else if (arg == "--pieces" && value) {
+      pieces = std::stoi(argv[++i]);
+    } else if (arg == "--threads" && value) {
+      threads = std::max(1, std::stoi(argv[++i]));
+    } else if (arg[0] != '-') {
+      fens.push_back(arg);
+    } else {
+      std::cerr << "Usage: tablebases [--directory dir] [--pieces n] [--threads n] [fen ...]" << std::endl;
+      return 1;
+    }
+  }
+  if (pieces < 3 || pieces > Tablebase::maxPieces) {
+    std::cerr << "The number of pieces must be 3 to " << Tablebase::maxPieces << std::endl;
+    return 1;
+  }
+
+  Tablebase tablebase;
+  TablebaseGenerator generator(&tablebase, threads);
+  bool generated = generator.generate(directory, pieces, [](const TablebaseStats& stats) {
+    printf("%-6s positions %10lld wins %10lld draws %10lld losses %10lld longest mate %3d %.1f s %s\n",
+           stats.signature.c_str(), stats.positions, stats.wins, stats.draws, stats.losses, stats.longest,
+           stats.seconds, stats.longestFen.c_str());
+    fflush(stdout);
+  });
+  if (!generated) {
+    std::cerr << "Could not generate the tables in " << directory << std::endl;
+    return 1;
+  }
+  for (const std::string& fen : fens) {
+    if (!printLine(&tablebase, fen)) return 1;
+  }
+  return 0;
+}
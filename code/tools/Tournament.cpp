@@ -0,0 +1,451 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/Mcts.h"
+#include "../engine/Search.h"
+#include "../rules/board/Board.h"
+#include "../rules/moves/Notation.h"
+#include "../rules/moves/Pgn.h"
+
+// Settings of one engine, given as "name=base,depth=8,nodes=0,hash=16,see=1,network=file.nnue,mcts=0,tablebases=dir"
+struct EngineConfig {
+  std::string name;
+  int depth;
+  long long nodes;
+  int hash;
+  bool useSee;
+  std::string network;
+  // Monte Carlo tree search instead of alpha-beta, the hash is the size of its node pool and nodes are playouts
+  bool mcts;
+  // Directory of the endgame tablebases, empty for none
+  std::string tablebases;
+};
+
+// Settings of the whole tournament
+struct TournamentConfig {
+  EngineConfig engines[2];
+  int games;
+  int threads;
+  double baseTime;
+  double increment;
+  // Moves per time control, 0 for sudden death
+  int movesPerControl;
+  std::string openings;
+  std::string pgn;
+  double elo0;
+  double elo1;
+  double alpha;
+  double beta;
+};
+
+// Results from the view of the first engine, shared by all worker threads
+struct TournamentState {
+  std::mutex mutex;
+  std::atomic<int> nextGame;
+  std::atomic<bool> decided;
+  int wins;
+  int draws;
+  int losses;
+  int timeouts;
+  std::ofstream pgn;
+};
+
+/**
+ * Parses an engine configuration. Unknown keys are ignored with a warning.
+ */
+static EngineConfig parseEngine(const std::string& text, const std::string& defaultName) {
+  EngineConfig engine = {defaultName, Search::maxPly - 1, 0, 16, true, "", false, ""};
+  std::istringstream fields(text);
+  std::string field;
+  while (std::getline(fields, field, ',')) {
+    size_t equals = field.find('=');
+    if (equals == std::string::npos) continue;
+    std::string key = field.substr(0, equals);
+    std::string value = field.substr(equals + 1);
+    if (key == "name")
+      engine.name = value;
+    else if (key == "depth")
+      engine.depth = std::stoi(value);
+    else if (key == "nodes")
+      engine.nodes = std::stoll(value);
+    else if (key == "hash")
+      engine.hash = std::stoi(value);
+    else if (key == "see")
+      engine.useSee = value != "0";
+    else if (key == "network")
+      engine.network = value;
+    else if (key == "mcts")
+      engine.mcts = value != "0";
+    else if (key == "tablebases")
+      engine.tablebases = value;
+    else
+      std::cerr << "Unknown engine option " << key << std::endl;
+  }
+  return engine;
+}
+
+/**
+ * Loads the opening positions from an EPD file (one position per line, the first four FEN fields) or a PGN file (the
+ * position after the moves of every game, unless it has no legal move). Without a file, all games start from the
+ * starting position.
+ */
+static std::vector<std::string> loadOpenings(const std::string& path) {
+  std::vector<std::string> openings;
+  if (path.empty()) return {Position().getFen()};
+  std::ifstream file(path);
+  if (!file) return openings;
+
+  if (path.size() > 4 && path.substr(path.size() - 4) == ".pgn") {
+    PgnGame game;
+    Piece piece;
+    while (Pgn::read(file, &game)) {
+      Position position = game.getStartPosition();
+      for (Move move : game.moves) {
+        Position next;
+        position.makeMove(&piece, move, &next);
+        position = next;
+      }
+      // Finished games are no openings
+      MoveList moves;
+      piece.testAvailableMoves(position.board, position.turn, position.lastMove, position.castling, &moves);
+      if (!moves.isEmpty()) openings.push_back(position.getFen());
+    }
+    return openings;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string placement, side, castling, passant;
+    if (!(fields >> placement >> side >> castling >> passant)) continue;
+    Position position;
+    if (position.setFen(placement + " " + side + " " + castling + " " + passant)) openings.push_back(position.getFen());
+  }
+  return openings;
+}
+
+/**
+ * Plays a move on the board, choosing the promotion piece of the move, if the board asks for it.
+ *
+ * @return True if the game continues, false if the move ended it.
+ */
+static bool playMove(Board* board, Move move) {
+  int from[2] = {move.getFrom() % 8, move.getFrom() / 8};
+  int to[2] = {move.getTo() % 8, move.getTo() / 8};
+  board->beginMovePiece(from[0], from[1]);
+  bool done = board->movePiece(from[0], from[1], to[0], to[1], ' ');
+  if (!done && board->isPromoting())
+    done = board->movePiece(from[0], from[1], to[0], to[1], move.getPromotionPiece(board->getTurn()));
+  return done;
+}
+
+/**
+ * Plays one game between the two engines on its own Board, which decides the end of the game. Every engine has its
+ * own clock, which is reduced by the time it needed for a move and increased by the increment afterwards, and by the
+ * base time after the last move of a time control. The TimeManager decides how long a move may take.
+ *
+ * @param searches The searches of the first and the second engine.
+ * @param trees The tree searches of the engines, which use Monte Carlo tree search, null for the others.
+ * @param firstWhite True if the first engine plays white.
+ * @param game Receives the moves and the result.
+ * @return The result from the view of the first engine: 1 for a win, 0 for a draw, -1 for a loss.
+ */
+static int playGame(const TournamentConfig& config, Search* searches[2], TranspositionTable* tables[2],
+                    Mcts* trees[2], const std::string& opening, bool firstWhite, PgnGame* game, bool* timeout) {
+  Board board(8, 8);
+  board.setPosition(opening);
+  game->startFen = opening == Position().getFen() ? "" : opening;
+  tables[0]->clear();
+  tables[1]->clear();
+  for (int i = 0; i < 2; i++) {
+    if (trees[i] != nullptr) trees[i]->clear();
+  }
+
+  double clocks[2] = {config.baseTime, config.baseTime};
+  int played[2] = {0, 0};
+  TimeManager timeManager;
+  std::vector<uint64_t> keys;
+  *timeout = false;
+  while (board.getResult() == "*") {
+    Position position = board.getPosition();
+    // The first engine is index 0, whose color depends on the game
+    int engine = position.turn == firstWhite ? 0 : 1;
+    const EngineConfig& settings = config.engines[engine];
+    SearchLimits limits;
+    limits.depth = settings.depth;
+    limits.nodes = settings.nodes;
+    int movesToGo = config.movesPerControl > 0 ? config.movesPerControl - played[engine] % config.movesPerControl : 0;
+    timeManager.start(clocks[engine], config.increment, movesToGo);
+    limits.hardTime = timeManager.getMaximum();
+    limits.timeManager = &timeManager;
+
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+    if (trees[engine] != nullptr) {
+      MctsResult tree = trees[engine]->run(position, limits, keys);
+      result.best = tree.best;
+      result.score = tree.score;
+      result.depth = tree.depth;
+    } else {
+      result = searches[engine]->run(position, limits, keys, nullptr);
+    }
+    clocks[engine] -= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (clocks[engine] < 0) {
+      board.endGame(false, true, false);
+      *timeout = true;
+      break;
+    }
+    clocks[engine] += config.increment;
+    // A new time control adds the base time again
+    played[engine]++;
+    if (config.movesPerControl > 0 && played[engine] % config.movesPerControl == 0) clocks[engine] += config.baseTime;
+
+    keys.push_back(position.getKey());
+    game->moves.push_back(result.best);
+    game->comments.push_back(std::to_string(result.score) + "/" + std::to_string(result.depth));
+    game->nags.push_back(0);
+    if (!playMove(&board, result.best) && board.getResult() == "*") {
+      std::cerr << "Illegal move " << Notation::toUci(result.best) << " in " << position.getFen() << std::endl;
+      break;
+    }
+  }
+
+  game->result = board.getResult();
+  game->setTag("Result", game->result);
+  const char* winner = firstWhite ? "1-0" : "0-1";
+  const char* loser = firstWhite ? "0-1" : "1-0";
+  return game->result == winner ? 1 : game->result == loser ? -1 : 0;
+}
+
+/**
+ * Log-likelihood ratio of the hypotheses elo1 against elo0, with the normal approximation of the scores of the
+ * games, as used by common engine testing frameworks.
+ */
+static double logLikelihoodRatio(int wins, int draws, int losses, double elo0, double elo1) {
+  int games = wins + draws + losses;
+  if (games == 0 || wins + losses == 0) return 0.0;
+  double score = (wins + 0.5 * draws) / games;
+  double variance = (wins * pow(1 - score, 2) + draws * pow(0.5 - score, 2) + losses * pow(score, 2)) / games;
+  if (variance <= 0) return 0.0;
+  double score0 = 1 / (1 + pow(10, -elo0 / 400));
+  double score1 = 1 / (1 + pow(10, -elo1 / 400));
+  return games * (score1 - score0) * (2 * score - score0 - score1) / (2 * variance);
+}
+
+/**
+ * Converts a score between 0 and 1 into an Elo difference.
+ */
+static double scoreToElo(double score) {
+  score = std::min(std::max(score, 1e-6), 1 - 1e-6);
+  return 400 * log10(score / (1 - score));
+}
+
+/**
+ * Prints the results so far: the score, the Elo difference with its 95% confidence interval and the SPRT state.
+ */
+static void printSummary(const TournamentConfig& config, TournamentState* state, std::ostream& out) {
+  int games = state->wins + state->draws + state->losses;
+  if (games == 0) return;
+  double score = (state->wins + 0.5 * state->draws) / games;
+  double variance = (state->wins * pow(1 - score, 2) + state->draws * pow(0.5 - score, 2) +
+                     state->losses * pow(score, 2)) / games;
+  double margin = 1.96 * sqrt(variance / games);
+  double elo = scoreToElo(score);
+  double llr = logLikelihoodRatio(state->wins, state->draws, state->losses, config.elo0, config.elo1);
+  char line[256];
+  snprintf(line, sizeof(line), "Games %d: +%d =%d -%d (%.1f%%), timeouts %d\n", games, state->wins, state->draws,
+           state->losses, score * 100, state->timeouts);
+  out << line;
+  snprintf(line, sizeof(line), "Elo %.1f +/- %.1f (95%%), %s vs %s\n", elo,
+           (scoreToElo(score + margin) - scoreToElo(score - margin)) / 2, config.engines[0].name.c_str(),
+           config.engines[1].name.c_str());
+  out << line;
+  double lower = log(config.beta / (1 - config.alpha));
+  double upper = log((1 - config.beta) / config.alpha);
+  snprintf(line, sizeof(line), "SPRT [%.1f, %.1f]: LLR %.2f (%.2f, %.2f)%s\n", config.elo0, config.elo1, llr, lower,
+           upper, llr >= upper ? ", H1 accepted" : llr <= lower ? ", H0 accepted" : "");
+  out << line;
+}
+
+/**
+ * Plays games, until all games are played or the SPRT is decided. Every worker has its own searches and tables, the
+ * games run on their own Board.
+ */
+static void worker(const TournamentConfig& config, const std::vector<std::string>& openings, Nnue* networks[2],
+                   Tablebase* tablebases[2], TournamentState* state) {
+  TranspositionTable table0(config.engines[0].hash), table1(config.engines[1].hash);
+  TranspositionTable* tables[2] = {&table0, &table1};
+  Search search0(&table0), search1(&table1);
+  Search* searches[2] = {&search0, &search1};
+  std::unique_ptr<Mcts> mcts[2];
+  Mcts* trees[2] = {nullptr, nullptr};
+  for (int i = 0; i < 2; i++) {
+    searches[i]->setUseSee(config.engines[i].useSee);
+    searches[i]->setNetwork(networks[i]);
+    searches[i]->setTablebase(tablebases[i]);
+    if (!config.engines[i].mcts) continue;
+    mcts[i] = std::make_unique<Mcts>(1, config.engines[i].hash);
+    if (networks[i] != nullptr) mcts[i]->setEvaluator(Mcts::networkEvaluator(networks[i]));
+    trees[i] = mcts[i].get();
+  }
+
+  double lower = log(config.beta / (1 - config.alpha));
+  double upper = log((1 - config.beta) / config.alpha);
+  while (!state->decided) {
+    int index = state->nextGame++;
+    if (index >= config.games) break;
+    // Every opening is played twice, with swapped colors
+    const std::string& opening = openings[(index / 2) % openings.size()];
+    bool firstWhite = index % 2 == 0;
+    PgnGame game;
+    game.setTag("Event", "Tournament");
+    game.setTag("Site", "local");
+    game.setTag("Round", std::to_string(index + 1));
+    game.setTag("White", config.engines[firstWhite ? 0 : 1].name);
+    game.setTag("Black", config.engines[firstWhite ? 1 : 0].name);
+    game.setTag("Result", "*");
+    char timeControl[64];
+    if (config.movesPerControl > 0)
+      snprintf(timeControl, sizeof(timeControl), "%d/%g+%g", config.movesPerControl, config.baseTime, config.increment);
+    else
+      snprintf(timeControl, sizeof(timeControl), "%g+%g", config.baseTime, config.increment);
+    game.setTag("TimeControl", timeControl);
+    if (opening != Position().getFen()) {
+      game.setTag("SetUp", "1");
+      game.setTag("FEN", opening);
+    }
+    bool timeout;
+    int result = playGame(config, searches, tables, trees, opening, firstWhite, &game, &timeout);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (result > 0) state->wins++;
+    if (result == 0) state->draws++;
+    if (result < 0) state->losses++;
+    if (timeout) state->timeouts++;
+    if (state->pgn.is_open()) Pgn::write(state->pgn, game);
+    double llr = logLikelihoodRatio(state->wins, state->draws, state->losses, config.elo0, config.elo1);
+    if (llr <= lower || llr >= upper) state->decided = true;
+    int games = state->wins + state->draws + state->losses;
+    if (games % 10 == 0 && !state->decided) printSummary(config, state, std::cout);
+  }
+}
+
+/**
+ * Headless self-play tournament between two engine configurations, to make sure a change does not lose strength.
+ * The games run in parallel on a pool of threads, each game on its own Board with clocks for both engines. The
+ * tournament stops early, as soon as the sequential probability ratio test accepts one of its hypotheses.
+ *
+ * Usage: tournament --engine1 <options> --engine2 <options> [--games n] [--threads n] [--tc [moves/]base+increment]
+ *                   [--openings file.epd|file.pgn] [--pgn output.pgn] [--sprt elo0 elo1] [--alpha a] [--beta b]
+ *
+ * Engine options are comma separated, like "name=new,depth=6,hash=16,see=1,network=file,mcts=1,tablebases=dir".
+ * Every opening is played twice with swapped colors. The results are written as PGN, and a summary of the score, the
+ * Elo difference and the SPRT is printed every ten games and at the end.
+ */
+int main(int argc, char* argv[]) {
+  TournamentConfig config;
+  config.engines[0] = parseEngine("", "engine1");
+  config.engines[1] = parseEngine("", "engine2");
+  config.games = 1000;
+  config.threads = std::max(1u, std::thread::hardware_concurrency());
+  config.baseTime = 10;
+  config.increment = 0.1;
+  config.movesPerControl = 0;
+  config.elo0 = 0;
+  config.elo1 = 5;
+  config.alpha = 0.05;
+  config.beta = 0.05;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool value = i + 1 < argc;
+    if (arg == "--engine1" && value) {
+      config.engines[0] = parseEngine(argv[++i], "engine1");
+    } else if (arg == "--engine2" && value) {
+      config.engines[1] = parseEngine(argv[++i], "engine2");
+    } else if (arg == "--games" && value) {
+      config.games = std::stoi(argv[++i]);
+    } else if (arg == "--threads" && value) {
+      config.threads = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--tc" && value) {
+      std::string tc = argv[++i];
+      config.movesPerControl = tc.find('/') != std::string::npos ? std::stoi(tc) : 0;
+      if (tc.find('/') != std::string::npos) tc = tc.substr(tc.find('/') + 1);
+      config.baseTime = std::stod(tc);
+      config.increment = tc.find('+') != std::string::npos ? std::stod(tc.substr(tc.find('+') + 1)) : 0;
+    } else if (arg == "--openings" && value) {
+      config.openings = argv[++i];
+    } else if (arg == "--pgn" && value) {
+      config.pgn = argv[++i];
+    } else if (arg == "--sprt" && i + 2 < argc) {
+      config.elo0 = std::stod(argv[++i]);
+      config.elo1 = std::stod(argv[++i]);
+    } else if (arg == "--alpha" && value) {
+      config.alpha = std::stod(argv[++i]);
+    } else if (arg == "--beta" && value) {
+      config.beta = std::stod(argv[++i]);
+    } else {
+      std::cerr << "Usage: tournament --engine1 <options> --engine2 <options> [--games n] [--threads n] "
+                   "[--tc [moves/]base+increment] [--openings file] [--pgn output.pgn] [--sprt elo0 elo1] "
+                   "[--alpha a] [--beta b]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<std::string> openings = loadOpenings(config.openings);
+  if (openings.empty()) {
+    std::cerr << "No openings found in " << config.openings << std::endl;
+    return 1;
+  }
+  Nnue* networks[2] = {nullptr, nullptr};
+  for (int i = 0; i < 2; i++) {
+    if (config.engines[i].network.empty()) continue;
+    networks[i] = new Nnue();
+    if (!networks[i]->load(config.engines[i].network)) {
+      std::cerr << "Could not load the network " << config.engines[i].network << std::endl;
+      return 1;
+    }
+  }
+
+  // The tablebases are read only and shared by all games
+  std::unique_ptr<Tablebase> tablebases[2];
+  Tablebase* sharedTablebases[2] = {nullptr, nullptr};
+  for (int i = 0; i < 2; i++) {
+    if (config.engines[i].tablebases.empty()) continue;
+    tablebases[i] = std::make_unique<Tablebase>();
+    if (tablebases[i]->load(config.engines[i].tablebases) == 0) {
+      std::cerr << "No tablebases found in " << config.engines[i].tablebases << std::endl;
+      return 1;
+    }
+    sharedTablebases[i] = tablebases[i].get();
+  }
+
+  TournamentState state;
+  state.nextGame = 0;
+  state.decided = false;
+  state.wins = state.draws = state.losses = state.timeouts = 0;
+  if (!config.pgn.empty()) state.pgn.open(config.pgn);
+  std::cout << config.engines[0].name << " vs " << config.engines[1].name << ", " << openings.size()
+            << " openings, " << config.threads << " threads" << std::endl;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < config.threads; i++)
+    threads.emplace_back(worker, std::cref(config), std::cref(openings), networks, sharedTablebases, &state);
+  for (std::thread& thread : threads) thread.join();
+
+  printSummary(config, &state, std::cout);
+  delete networks[0];
+  delete networks[1];
+  return 0;
+}